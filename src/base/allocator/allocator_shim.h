@@ -0,0 +1,48 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_ALLOCATOR_ALLOCATOR_SHIM_H_
+#define BASE_ALLOCATOR_ALLOCATOR_SHIM_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+
+namespace base {
+namespace allocator {
+
+// On Linux builds with use_experimental_allocator_shim=1 (which requires
+// use_allocator=="none"), base defines malloc(), free() and the other C
+// allocation functions itself and forwards them to the implementation of
+// glibc (__libc_malloc() and friends). Symbol interposition makes all
+// libraries of the process, and operator new and delete of the C++ runtime,
+// go through these definitions. No glibc hooks (__malloc_hook), which are
+// deprecated and not thread safe, are involved.
+//
+// The shim lets a single observer see every allocation and free. The hooks
+// are called on the allocating thread with no lock held, so they must be
+// thread safe, and they must cope with being reentered if they allocate.
+
+// Called after |size| bytes were allocated at |address|, which is not NULL.
+typedef void (*AllocationHook)(void* address, size_t size);
+
+// Called before the memory at |address|, which is not NULL, is freed. This
+// includes the block passed to realloc(), before it is resized.
+typedef void (*FreeHook)(void* address);
+
+// Called after realloc() failed to resize the block at |address|, which was
+// passed to the FreeHook on this thread right before and is still allocated.
+typedef void (*ReallocFailedHook)(void* address);
+
+// Replaces the hooks. Any of them can be NULL. Everything the hooks use must
+// be set up before they are installed; they may still be called on other
+// threads for a little while after they were replaced.
+BASE_EXPORT void SetAllocationHooks(AllocationHook allocation_hook,
+                                    FreeHook free_hook,
+                                    ReallocFailedHook realloc_failed_hook);
+
+}  // namespace allocator
+}  // namespace base
+
+#endif  // BASE_ALLOCATOR_ALLOCATOR_SHIM_H_
@@ -0,0 +1,153 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/allocator_shim.h"
+
+#include <errno.h>
+#include <malloc.h>
+#include <stdlib.h>
+
+#include "base/atomicops.h"
+
+// glibc's implementation of the allocation functions, which the shim forwards
+// to. They do not go through the symbols defined below.
+extern "C" {
+void* __libc_malloc(size_t size);
+void __libc_free(void* address);
+void* __libc_realloc(void* address, size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void* __libc_valloc(size_t size);
+void* __libc_pvalloc(size_t size);
+}
+
+namespace base {
+namespace allocator {
+
+namespace {
+
+subtle::AtomicWord g_allocation_hook = 0;
+subtle::AtomicWord g_free_hook = 0;
+subtle::AtomicWord g_realloc_failed_hook = 0;
+
+}  // namespace
+
+void SetAllocationHooks(AllocationHook allocation_hook,
+                        FreeHook free_hook,
+                        ReallocFailedHook realloc_failed_hook) {
+  subtle::Release_Store(&g_allocation_hook,
+                        reinterpret_cast<subtle::AtomicWord>(allocation_hook));
+  subtle::Release_Store(&g_free_hook,
+                        reinterpret_cast<subtle::AtomicWord>(free_hook));
+  subtle::Release_Store(
+      &g_realloc_failed_hook,
+      reinterpret_cast<subtle::AtomicWord>(realloc_failed_hook));
+}
+
+namespace {
+
+inline void* OnAllocation(void* address, size_t size) {
+  if (address) {
+    AllocationHook hook = reinterpret_cast<AllocationHook>(
+        subtle::Acquire_Load(&g_allocation_hook));
+    if (hook)
+      hook(address, size);
+  }
+  return address;
+}
+
+inline void OnFree(void* address) {
+  if (address) {
+    FreeHook hook =
+        reinterpret_cast<FreeHook>(subtle::Acquire_Load(&g_free_hook));
+    if (hook)
+      hook(address);
+  }
+}
+
+inline void OnReallocFailed(void* address) {
+  ReallocFailedHook hook = reinterpret_cast<ReallocFailedHook>(
+      subtle::Acquire_Load(&g_realloc_failed_hook));
+  if (hook)
+    hook(address);
+}
+
+}  // namespace
+
+}  // namespace allocator
+}  // namespace base
+
+using base::allocator::OnAllocation;
+using base::allocator::OnFree;
+using base::allocator::OnReallocFailed;
+
+// Chrome is built with -fvisibility=hidden, but these have to be visible to
+// interpose the definitions of libc.
+#define SHIM_ALWAYS_EXPORT __attribute__((visibility("default"), noinline))
+
+extern "C" {
+
+SHIM_ALWAYS_EXPORT void* malloc(size_t size) __THROW {
+  return OnAllocation(__libc_malloc(size), size);
+}
+
+SHIM_ALWAYS_EXPORT void free(void* address) __THROW {
+  OnFree(address);
+  __libc_free(address);
+}
+
+SHIM_ALWAYS_EXPORT void* realloc(void* address, size_t size) __THROW {
+  // The old block is reported before it is freed, as for free(). Otherwise
+  // another thread could be given the same address in the meantime, and the
+  // report would be taken for the new block. realloc() returns NULL for a
+  // size of zero after freeing the block, so only a NULL result for another
+  // size means that the block is still there.
+  OnFree(address);
+  void* result = __libc_realloc(address, size);
+  if (address && !result && size != 0)
+    OnReallocFailed(address);
+  return OnAllocation(result, size);
+}
+
+SHIM_ALWAYS_EXPORT void* calloc(size_t n, size_t size) __THROW {
+  // __libc_calloc() fails if |n| * |size| overflows.
+  return OnAllocation(__libc_calloc(n, size), n * size);
+}
+
+SHIM_ALWAYS_EXPORT void cfree(void* address) __THROW {
+  free(address);
+}
+
+SHIM_ALWAYS_EXPORT void* memalign(size_t alignment, size_t size) __THROW {
+  return OnAllocation(__libc_memalign(alignment, size), size);
+}
+
+SHIM_ALWAYS_EXPORT void* aligned_alloc(size_t alignment, size_t size) __THROW {
+  return memalign(alignment, size);
+}
+
+SHIM_ALWAYS_EXPORT int posix_memalign(void** result,
+                                      size_t alignment,
+                                      size_t size) __THROW {
+  // posix_memalign() is specified to check its arguments, unlike memalign().
+  if (alignment == 0 || alignment % sizeof(void*) != 0 ||
+      (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  void* address = memalign(alignment, size);
+  if (!address)
+    return ENOMEM;
+  *result = address;
+  return 0;
+}
+
+SHIM_ALWAYS_EXPORT void* valloc(size_t size) __THROW {
+  return OnAllocation(__libc_valloc(size), size);
+}
+
+SHIM_ALWAYS_EXPORT void* pvalloc(size_t size) __THROW {
+  return OnAllocation(__libc_pvalloc(size), size);
+}
+
+}  // extern "C"
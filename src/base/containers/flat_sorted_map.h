@@ -0,0 +1,216 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_SORTED_MAP_H_
+#define BASE_CONTAINERS_FLAT_SORTED_MAP_H_
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+
+namespace base {
+
+// An associative container that, like std::map, always iterates in key order,
+// but keeps its elements in a single sorted vector while it is small. Lookups
+// are a binary search over contiguous memory and adding an element does not
+// allocate a node of its own. Once the container grows beyond kMaxVectorSize
+// elements, the elements move to a std::map so that insertions stay
+// O(log(n)); the container stays a std::map until it is cleared.
+//
+// Appending keys in increasing order (e.g. when copying another sorted
+// container) does not move any existing element.
+//
+// Unlike std::map, iterators expose key() and value() instead of a pair, and
+// all of them are invalidated by Insert(), Remove(), Swap() and clear().
+//
+// example:
+//   base::FlatSortedMap<std::string, int, 16> days;
+//   days.Insert("monday", 1);
+//   days.Insert("sunday", 0);
+//   for (base::FlatSortedMap<std::string, int, 16>::const_iterator it =
+//            days.begin(); it != days.end(); ++it) {
+//     ...  // Visits "monday", then "sunday".
+//   }
+template <typename Key, typename Mapped, size_t kMaxVectorSize>
+class FlatSortedMap {
+ private:
+  typedef std::pair<Key, Mapped> Element;
+  typedef std::vector<Element> ElementVector;
+  typedef std::map<Key, Mapped> ElementMap;
+
+ public:
+  class const_iterator {
+   public:
+    const_iterator() : in_map_(false) {}
+
+    const Key& key() const {
+      return in_map_ ? map_it_->first : vector_it_->first;
+    }
+    const Mapped& value() const {
+      return in_map_ ? map_it_->second : vector_it_->second;
+    }
+
+    const_iterator& operator++() {
+      if (in_map_)
+        ++map_it_;
+      else
+        ++vector_it_;
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      DCHECK_EQ(in_map_, other.in_map_);
+      return in_map_ ? map_it_ == other.map_it_
+                     : vector_it_ == other.vector_it_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class FlatSortedMap;
+
+    explicit const_iterator(typename ElementVector::const_iterator it)
+        : vector_it_(it), in_map_(false) {}
+    explicit const_iterator(typename ElementMap::const_iterator it)
+        : map_it_(it), in_map_(true) {}
+
+    typename ElementVector::const_iterator vector_it_;
+    typename ElementMap::const_iterator map_it_;
+    bool in_map_;
+  };
+
+  FlatSortedMap() {}
+  ~FlatSortedMap() {}
+
+  size_t size() const { return map_ ? map_->size() : vector_.size(); }
+  bool empty() const { return size() == 0; }
+
+  const_iterator begin() const {
+    if (map_)
+      return const_iterator(map_->begin());
+    return const_iterator(vector_.begin());
+  }
+  const_iterator end() const {
+    if (map_)
+      return const_iterator(map_->end());
+    return const_iterator(vector_.end());
+  }
+
+  // Returns the value stored for |key|, or NULL if there is none.
+  const Mapped* Find(const Key& key) const {
+    if (map_) {
+      typename ElementMap::const_iterator it = map_->find(key);
+      return it == map_->end() ? NULL : &it->second;
+    }
+    typename ElementVector::const_iterator it = LowerBound(key);
+    if (it == vector_.end() || it->first != key)
+      return NULL;
+    return &it->second;
+  }
+  Mapped* Find(const Key& key) {
+    return const_cast<Mapped*>(
+        static_cast<const FlatSortedMap&>(*this).Find(key));
+  }
+
+  // Adds |value| for |key| unless the key is already present. Returns the
+  // location of the value stored for |key|, and whether it was just added.
+  std::pair<Mapped*, bool> Insert(const Key& key, const Mapped& value) {
+    if (!map_) {
+      // Fast path for keys that are added in order.
+      if (vector_.empty() || vector_.back().first < key) {
+        if (vector_.size() < kMaxVectorSize) {
+          vector_.push_back(Element(key, value));
+          return std::make_pair(&vector_.back().second, true);
+        }
+      } else {
+        typename ElementVector::iterator it = LowerBound(key);
+        if (it->first == key)
+          return std::make_pair(&it->second, false);
+        if (vector_.size() < kMaxVectorSize) {
+          it = vector_.insert(it, Element(key, value));
+          return std::make_pair(&it->second, true);
+        }
+      }
+      ConvertToMap();
+    }
+
+    std::pair<typename ElementMap::iterator, bool> result =
+        map_->insert(Element(key, value));
+    return std::make_pair(&result.first->second, result.second);
+  }
+
+  // Removes the element for |key|, storing its value in |removed_value| if it
+  // is not NULL. Returns false if there was no element for |key|.
+  bool Remove(const Key& key, Mapped* removed_value) {
+    if (map_) {
+      typename ElementMap::iterator it = map_->find(key);
+      if (it == map_->end())
+        return false;
+      if (removed_value)
+        *removed_value = it->second;
+      map_->erase(it);
+      return true;
+    }
+
+    typename ElementVector::iterator it = LowerBound(key);
+    if (it == vector_.end() || it->first != key)
+      return false;
+    if (removed_value)
+      *removed_value = it->second;
+    vector_.erase(it);
+    return true;
+  }
+
+  void clear() {
+    vector_.clear();
+    map_.reset();
+  }
+
+  void Swap(FlatSortedMap* other) {
+    vector_.swap(other->vector_);
+    map_.swap(other->map_);
+  }
+
+ private:
+  struct KeyLess {
+    bool operator()(const Element& element, const Key& key) const {
+      return element.first < key;
+    }
+  };
+
+  typename ElementVector::const_iterator LowerBound(const Key& key) const {
+    return std::lower_bound(vector_.begin(), vector_.end(), key, KeyLess());
+  }
+  typename ElementVector::iterator LowerBound(const Key& key) {
+    return std::lower_bound(vector_.begin(), vector_.end(), key, KeyLess());
+  }
+
+  void ConvertToMap() {
+    DCHECK(!map_);
+    map_.reset(new ElementMap);
+    for (typename ElementVector::iterator it = vector_.begin();
+         it != vector_.end(); ++it) {
+      map_->insert(map_->end(), *it);
+    }
+    ElementVector().swap(vector_);
+  }
+
+  // The elements, while there are few of them.
+  ElementVector vector_;
+
+  // The elements, once there were more than kMaxVectorSize of them.
+  scoped_ptr<ElementMap> map_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlatSortedMap);
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_SORTED_MAP_H_
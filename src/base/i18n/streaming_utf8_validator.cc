@@ -8,6 +8,8 @@
 
 #include "base/i18n/streaming_utf8_validator.h"
 
+#include <stdint.h>
+
 #include "base/i18n/utf8_validator_tables.h"
 #include "base/logging.h"
 
@@ -19,6 +21,26 @@ uint8 StateTableLookup(uint8 offset) {
   return internal::kUtf8ValidatorTables[offset];
 }
 
+// Returns the first byte in [|p|, |end|) that is not ASCII, or |end|. Looks at
+// a machine word at a time where it can.
+const char* SkipASCII(const char* p, const char* end) {
+  typedef uintptr_t MachineWord;
+  const MachineWord kNonASCIIMask =
+      static_cast<MachineWord>(UINT64_C(0x8080808080808080));
+  while (p != end && reinterpret_cast<MachineWord>(p) % sizeof(MachineWord)) {
+    if (*p & 0x80)
+      return p;
+    ++p;
+  }
+  while (static_cast<size_t>(end - p) >= sizeof(MachineWord) &&
+         !(*reinterpret_cast<const MachineWord*>(p) & kNonASCIIMask)) {
+    p += sizeof(MachineWord);
+  }
+  while (p != end && !(*p & 0x80))
+    ++p;
+  return p;
+}
+
 }  // namespace
 
 StreamingUtf8Validator::State StreamingUtf8Validator::AddBytes(const char* data,
@@ -26,12 +48,17 @@ StreamingUtf8Validator::State StreamingUtf8Validator::AddBytes(const char* data,
   // Copy |state_| into a local variable so that the compiler doesn't have to be
   // careful of aliasing.
   uint8 state = state_;
-  for (const char* p = data; p != data + size; ++p) {
+  const char* end = data + size;
+  for (const char* p = data; p != end; ++p) {
     if ((*p & 0x80) == 0) {
-      if (state == 0)
-        continue;
-      state = internal::I18N_UTF8_VALIDATOR_INVALID_INDEX;
-      break;
+      if (state != 0) {
+        state = internal::I18N_UTF8_VALIDATOR_INVALID_INDEX;
+        break;
+      }
+      // Most text is mostly ASCII, so skip over the rest of the run at once.
+      p = SkipASCII(p, end);
+      if (p == end)
+        break;
     }
     const uint8 shift_amount = StateTableLookup(state);
     const uint8 shifted_char = (*p & 0x7F) >> shift_amount;
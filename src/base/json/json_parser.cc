@@ -6,6 +6,7 @@
 
 #include <cmath>
 
+#include "base/json/string_scan.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string_number_conversions.h"
@@ -162,6 +163,98 @@ class JSONStringValue : public Value {
   DISALLOW_COPY_AND_ASSIGN(JSONStringValue);
 };
 
+// Converts the text of a JSON number to an int, avoiding the generic
+// conversion for numbers with few enough digits that they cannot overflow.
+bool JSONNumberToInt(const StringPiece& num_string, int* out) {
+  const size_t kMaxFastDigits = 9;
+  size_t i = (!num_string.empty() && num_string[0] == '-') ? 1 : 0;
+  if (num_string.size() == i || num_string.size() - i > kMaxFastDigits)
+    return StringToInt(num_string, out);
+
+  int value = 0;
+  for (; i < num_string.size(); ++i) {
+    if (!IsAsciiDigit(num_string[i]))
+      return false;  // A fraction or an exponent.
+    value = value * 10 + (num_string[i] - '0');
+  }
+  *out = num_string[0] == '-' ? -value : value;
+  return true;
+}
+
+// Converts the text of a valid JSON number to a double. Numbers with at most
+// 15 significant digits and a small decimal exponent are exactly representable
+// as |mantissa| and 10^|exponent|, so one multiplication or division gives the
+// correctly rounded result; everything else goes through StringToDouble().
+bool JSONNumberToDouble(const StringPiece& num_string, double* out) {
+  static const double kPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+  };
+  const int kMaxFastExponent = arraysize(kPowersOfTen) - 1;
+  const int kMaxFastDigits = 15;
+
+  size_t i = 0;
+  bool negative = false;
+  if (i < num_string.size() && num_string[i] == '-') {
+    negative = true;
+    ++i;
+  }
+
+  uint64 mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool fraction = false;
+  for (; i < num_string.size(); ++i) {
+    char c = num_string[i];
+    if (c == '.') {
+      fraction = true;
+      continue;
+    }
+    if (!IsAsciiDigit(c))
+      break;
+    if (mantissa || c != '0')
+      ++digits;
+    if (digits > kMaxFastDigits)
+      break;
+    mantissa = mantissa * 10 + (c - '0');
+    if (fraction)
+      --exponent;
+  }
+
+  bool fast_path = digits <= kMaxFastDigits;
+  if (fast_path && i < num_string.size()) {
+    // The exponent part.
+    DCHECK(num_string[i] == 'e' || num_string[i] == 'E');
+    ++i;
+    bool negative_exponent = false;
+    if (num_string[i] == '-' || num_string[i] == '+')
+      negative_exponent = num_string[i++] == '-';
+    int explicit_exponent = 0;
+    for (; i < num_string.size() && fast_path; ++i) {
+      explicit_exponent = explicit_exponent * 10 + (num_string[i] - '0');
+      fast_path = explicit_exponent <= 2 * kMaxFastExponent;
+    }
+    exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+  }
+
+  if (fast_path && exponent >= -kMaxFastExponent &&
+      exponent <= kMaxFastExponent) {
+    double value = static_cast<double>(mantissa);
+    if (exponent < 0)
+      value /= kPowersOfTen[-exponent];
+    else
+      value *= kPowersOfTen[exponent];
+    *out = negative ? -value : value;
+    return true;
+  }
+
+  double value;
+  if (!StringToDouble(num_string.as_string(), &value) || !std::isfinite(value))
+    return false;
+  *out = value;
+  return true;
+}
+
 // Simple class that checks for maximum recursion/"stack overflow."
 class StackMarker {
  public:
@@ -209,28 +302,9 @@ Value* JSONParser::Parse(const StringPiece& input) {
   // be used anywhere.
   if (!(options_ & JSON_DETACHABLE_CHILDREN)) {
     input_copy.reset(new std::string(input.as_string()));
-    start_pos_ = input_copy->data();
+    StartParsing(input_copy->data(), input_copy->length());
   } else {
-    start_pos_ = input.data();
-  }
-  pos_ = start_pos_;
-  end_pos_ = start_pos_ + input.length();
-  index_ = 0;
-  line_number_ = 1;
-  index_last_line_ = 0;
-
-  error_code_ = JSONReader::JSON_NO_ERROR;
-  error_line_ = 0;
-  error_column_ = 0;
-
-  // When the input JSON string starts with a UTF-8 Byte-Order-Mark
-  // <0xEF 0xBB 0xBF>, advance the start position to avoid the
-  // ParseNextToken function mis-treating a Unicode BOM as an invalid
-  // character and returning NULL.
-  if (CanConsume(3) && static_cast<uint8>(*pos_) == 0xEF &&
-      static_cast<uint8>(*(pos_ + 1)) == 0xBB &&
-      static_cast<uint8>(*(pos_ + 2)) == 0xBF) {
-    NextNChars(3);
+    StartParsing(input.data(), input.length());
   }
 
   // Parse the first and any nested tokens.
@@ -238,13 +312,8 @@ Value* JSONParser::Parse(const StringPiece& input) {
   if (!root.get())
     return NULL;
 
-  // Make sure the input stream is at an end.
-  if (GetNextToken() != T_END_OF_INPUT) {
-    if (!CanConsume(1) || (NextChar() && GetNextToken() != T_END_OF_INPUT)) {
-      ReportError(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, 1);
-      return NULL;
-    }
-  }
+  if (!ConsumeEndOfInput())
+    return NULL;
 
   // Dictionaries and lists can contain JSONStringValues, so wrap them in a
   // hidden root.
@@ -265,6 +334,13 @@ Value* JSONParser::Parse(const StringPiece& input) {
   return root.release();
 }
 
+bool JSONParser::Visit(const StringPiece& input,
+                       JSONReader::Visitor* visitor) {
+  // Nothing outlives the call, so the input is used in place.
+  StartParsing(input.data(), input.length());
+  return VisitNextToken(visitor) && ConsumeEndOfInput();
+}
+
 JSONReader::JsonParseError JSONParser::error_code() const {
   return error_code_;
 }
@@ -308,6 +384,15 @@ void JSONParser::StringBuilder::Append(const char& c) {
     ++length_;
 }
 
+void JSONParser::StringBuilder::AppendRun(const char* str, size_t length) {
+  if (string_) {
+    string_->append(str, length);
+  } else {
+    DCHECK_EQ(pos_ + length_, str);
+    length_ += length;
+  }
+}
+
 void JSONParser::StringBuilder::AppendString(const std::string& str) {
   DCHECK(string_);
   string_->append(str);
@@ -337,6 +422,40 @@ const std::string& JSONParser::StringBuilder::AsString() {
 
 // JSONParser private //////////////////////////////////////////////////////////
 
+void JSONParser::StartParsing(const char* input, size_t length) {
+  start_pos_ = input;
+  pos_ = start_pos_;
+  end_pos_ = start_pos_ + length;
+  index_ = 0;
+  stack_depth_ = 0;
+  line_number_ = 1;
+  index_last_line_ = 0;
+
+  error_code_ = JSONReader::JSON_NO_ERROR;
+  error_line_ = 0;
+  error_column_ = 0;
+
+  // When the input JSON string starts with a UTF-8 Byte-Order-Mark
+  // <0xEF 0xBB 0xBF>, advance the start position to avoid the
+  // ParseNextToken function mis-treating a Unicode BOM as an invalid
+  // character and returning NULL.
+  if (CanConsume(3) && static_cast<uint8>(*pos_) == 0xEF &&
+      static_cast<uint8>(*(pos_ + 1)) == 0xBB &&
+      static_cast<uint8>(*(pos_ + 2)) == 0xBF) {
+    NextNChars(3);
+  }
+}
+
+bool JSONParser::ConsumeEndOfInput() {
+  if (GetNextToken() != T_END_OF_INPUT) {
+    if (!CanConsume(1) || (NextChar() && GetNextToken() != T_END_OF_INPUT)) {
+      ReportError(JSONReader::JSON_UNEXPECTED_DATA_AFTER_ROOT, 1);
+      return false;
+    }
+  }
+  return true;
+}
+
 inline bool JSONParser::CanConsume(int length) {
   return pos_ + length <= end_pos_;
 }
@@ -491,6 +610,9 @@ Value* JSONParser::ConsumeDictionary() {
   }
 
   scoped_ptr<DictionaryValue> dict(new DictionaryValue);
+  // Keys that are pieces of the input are copied here, reusing one buffer for
+  // all of them.
+  std::string key_string;
 
   NextChar();
   Token token = GetNextToken();
@@ -522,7 +644,15 @@ Value* JSONParser::ConsumeDictionary() {
       return NULL;
     }
 
-    dict->SetWithoutPathExpansion(key.AsString(), value);
+    // Keys without escape sequences are still pieces of the input; do not
+    // make the builder copy them into a heap string of its own. The only
+    // per-key allocation left is the copy that |dict| stores.
+    if (key.CanBeStringPiece()) {
+      key.AsStringPiece().CopyToString(&key_string);
+      dict->SetWithoutPathExpansion(key_string, value);
+    } else {
+      dict->SetWithoutPathExpansion(key.AsString(), value);
+    }
 
     NextChar();
     token = GetNextToken();
@@ -617,6 +747,20 @@ bool JSONParser::ConsumeStringRaw(StringBuilder* out) {
 
   while (CanConsume(1)) {
     pos_ = start_pos_ + index_;  // CBU8_NEXT is postcrement.
+
+    // Take runs of ASCII characters that need no decoding in one step. The
+    // last byte of the input is left to the loop below, which reports any
+    // error for an unterminated string.
+    if (end_pos_ - pos_ > 1) {
+      size_t run = CountPlainCharsForParser(pos_, end_pos_ - pos_ - 1);
+      if (run) {
+        string.AppendRun(pos_, run);
+        index_ += static_cast<int>(run);
+        pos_ += run;
+        continue;
+      }
+    }
+
     CBU8_NEXT(start_pos_, index_, length, next_char);
     if (next_char < 0 || !IsValidCharacter(next_char)) {
       ReportError(JSONReader::JSON_UNSUPPORTED_ENCODING, 1);
@@ -813,6 +957,22 @@ void JSONParser::DecodeUTF8(const int32& point, StringBuilder* dest) {
 }
 
 Value* JSONParser::ConsumeNumber() {
+  StringPiece num_string;
+  if (!ConsumeNumberRaw(&num_string))
+    return NULL;
+
+  int num_int;
+  if (JSONNumberToInt(num_string, &num_int))
+    return new FundamentalValue(num_int);
+
+  double num_double;
+  if (JSONNumberToDouble(num_string, &num_double))
+    return new FundamentalValue(num_double);
+
+  return NULL;
+}
+
+bool JSONParser::ConsumeNumberRaw(StringPiece* num_string) {
   const char* num_start = pos_;
   const int start_index = index_;
   int end_index = start_index;
@@ -822,7 +982,7 @@ Value* JSONParser::ConsumeNumber() {
 
   if (!ReadInt(false)) {
     ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-    return NULL;
+    return false;
   }
   end_index = index_;
 
@@ -830,12 +990,12 @@ Value* JSONParser::ConsumeNumber() {
   if (*pos_ == '.') {
     if (!CanConsume(1)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     NextChar();
     if (!ReadInt(true)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     end_index = index_;
   }
@@ -847,7 +1007,7 @@ Value* JSONParser::ConsumeNumber() {
       NextChar();
     if (!ReadInt(true)) {
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
     }
     end_index = index_;
   }
@@ -867,25 +1027,14 @@ Value* JSONParser::ConsumeNumber() {
       break;
     default:
       ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
-      return NULL;
+      return false;
   }
 
   pos_ = exit_pos;
   index_ = exit_index;
 
-  StringPiece num_string(num_start, end_index - start_index);
-
-  int num_int;
-  if (StringToInt(num_string, &num_int))
-    return new FundamentalValue(num_int);
-
-  double num_double;
-  if (StringToDouble(num_string.as_string(), &num_double) &&
-      std::isfinite(num_double)) {
-    return new FundamentalValue(num_double);
-  }
-
-  return NULL;
+  *num_string = StringPiece(num_start, end_index - start_index);
+  return true;
 }
 
 bool JSONParser::ReadInt(bool allow_leading_zeros) {
@@ -909,45 +1058,215 @@ bool JSONParser::ReadInt(bool allow_leading_zeros) {
 
 Value* JSONParser::ConsumeLiteral() {
   switch (*pos_) {
-    case 't': {
-      const char kTrueLiteral[] = "true";
-      const int kTrueLen = static_cast<int>(strlen(kTrueLiteral));
-      if (!CanConsume(kTrueLen - 1) ||
-          !StringsAreEqual(pos_, kTrueLiteral, kTrueLen)) {
-        ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    case 't':
+      if (!ConsumeLiteralRaw("true"))
         return NULL;
-      }
-      NextNChars(kTrueLen - 1);
       return new FundamentalValue(true);
-    }
-    case 'f': {
-      const char kFalseLiteral[] = "false";
-      const int kFalseLen = static_cast<int>(strlen(kFalseLiteral));
-      if (!CanConsume(kFalseLen - 1) ||
-          !StringsAreEqual(pos_, kFalseLiteral, kFalseLen)) {
-        ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    case 'f':
+      if (!ConsumeLiteralRaw("false"))
         return NULL;
-      }
-      NextNChars(kFalseLen - 1);
       return new FundamentalValue(false);
-    }
-    case 'n': {
-      const char kNullLiteral[] = "null";
-      const int kNullLen = static_cast<int>(strlen(kNullLiteral));
-      if (!CanConsume(kNullLen - 1) ||
-          !StringsAreEqual(pos_, kNullLiteral, kNullLen)) {
-        ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    case 'n':
+      if (!ConsumeLiteralRaw("null"))
         return NULL;
-      }
-      NextNChars(kNullLen - 1);
       return Value::CreateNullValue().release();
-    }
     default:
       ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
       return NULL;
   }
 }
 
+bool JSONParser::ConsumeLiteralRaw(const char* literal) {
+  const int literal_len = static_cast<int>(strlen(literal));
+  if (!CanConsume(literal_len - 1) ||
+      !StringsAreEqual(pos_, literal, literal_len)) {
+    ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+    return false;
+  }
+  NextNChars(literal_len - 1);
+  return true;
+}
+
+// Visitor /////////////////////////////////////////////////////////////////////
+
+bool JSONParser::VisitNextToken(JSONReader::Visitor* visitor) {
+  return VisitToken(GetNextToken(), visitor);
+}
+
+bool JSONParser::VisitToken(Token token, JSONReader::Visitor* visitor) {
+  switch (token) {
+    case T_OBJECT_BEGIN:
+      return VisitDictionary(visitor);
+    case T_ARRAY_BEGIN:
+      return VisitList(visitor);
+    case T_STRING:
+      return VisitString(visitor);
+    case T_NUMBER:
+      return VisitNumber(visitor);
+    case T_BOOL_TRUE:
+    case T_BOOL_FALSE:
+    case T_NULL:
+      return VisitLiteral(visitor);
+    default:
+      ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+      return false;
+  }
+}
+
+bool JSONParser::VisitDictionary(JSONReader::Visitor* visitor) {
+  if (*pos_ != '{') {
+    ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+    return false;
+  }
+
+  StackMarker depth_check(&stack_depth_);
+  if (depth_check.IsTooDeep()) {
+    ReportError(JSONReader::JSON_TOO_MUCH_NESTING, 1);
+    return false;
+  }
+
+  visitor->OnDictionaryBegin();
+
+  NextChar();
+  Token token = GetNextToken();
+  while (token != T_OBJECT_END) {
+    if (token != T_STRING) {
+      ReportError(JSONReader::JSON_UNQUOTED_DICTIONARY_KEY, 1);
+      return false;
+    }
+
+    StringBuilder key;
+    if (!ConsumeStringRaw(&key))
+      return false;
+    if (key.CanBeStringPiece())
+      visitor->OnDictionaryKey(key.AsStringPiece());
+    else
+      visitor->OnDictionaryKey(key.AsString());
+
+    NextChar();
+    token = GetNextToken();
+    if (token != T_OBJECT_PAIR_SEPARATOR) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+      return false;
+    }
+
+    NextChar();
+    if (!VisitNextToken(visitor))
+      return false;
+
+    NextChar();
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      NextChar();
+      token = GetNextToken();
+      if (token == T_OBJECT_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+        return false;
+      }
+    } else if (token != T_OBJECT_END) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 0);
+      return false;
+    }
+  }
+
+  visitor->OnDictionaryEnd();
+  return true;
+}
+
+bool JSONParser::VisitList(JSONReader::Visitor* visitor) {
+  if (*pos_ != '[') {
+    ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+    return false;
+  }
+
+  StackMarker depth_check(&stack_depth_);
+  if (depth_check.IsTooDeep()) {
+    ReportError(JSONReader::JSON_TOO_MUCH_NESTING, 1);
+    return false;
+  }
+
+  visitor->OnListBegin();
+
+  NextChar();
+  Token token = GetNextToken();
+  while (token != T_ARRAY_END) {
+    if (!VisitToken(token, visitor))
+      return false;
+
+    NextChar();
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      NextChar();
+      token = GetNextToken();
+      if (token == T_ARRAY_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSONReader::JSON_TRAILING_COMMA, 1);
+        return false;
+      }
+    } else if (token != T_ARRAY_END) {
+      ReportError(JSONReader::JSON_SYNTAX_ERROR, 1);
+      return false;
+    }
+  }
+
+  visitor->OnListEnd();
+  return true;
+}
+
+bool JSONParser::VisitString(JSONReader::Visitor* visitor) {
+  StringBuilder string;
+  if (!ConsumeStringRaw(&string))
+    return false;
+
+  if (string.CanBeStringPiece())
+    visitor->OnString(string.AsStringPiece());
+  else
+    visitor->OnString(string.AsString());
+  return true;
+}
+
+bool JSONParser::VisitNumber(JSONReader::Visitor* visitor) {
+  StringPiece num_string;
+  if (!ConsumeNumberRaw(&num_string))
+    return false;
+
+  int num_int;
+  if (JSONNumberToInt(num_string, &num_int)) {
+    visitor->OnInteger(num_int);
+    return true;
+  }
+
+  double num_double;
+  if (JSONNumberToDouble(num_string, &num_double)) {
+    visitor->OnDouble(num_double);
+    return true;
+  }
+
+  return false;
+}
+
+bool JSONParser::VisitLiteral(JSONReader::Visitor* visitor) {
+  switch (*pos_) {
+    case 't':
+      if (!ConsumeLiteralRaw("true"))
+        return false;
+      visitor->OnBoolean(true);
+      return true;
+    case 'f':
+      if (!ConsumeLiteralRaw("false"))
+        return false;
+      visitor->OnBoolean(false);
+      return true;
+    case 'n':
+      if (!ConsumeLiteralRaw("null"))
+        return false;
+      visitor->OnNull();
+      return true;
+    default:
+      ReportError(JSONReader::JSON_UNEXPECTED_TOKEN, 1);
+      return false;
+  }
+}
+
 // static
 bool JSONParser::StringsAreEqual(const char* one, const char* two, size_t len) {
   return strncmp(one, two, len) == 0;
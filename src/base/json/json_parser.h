@@ -39,7 +39,8 @@ class JSONParserTest;
 // to the first byte of a valid JSON token. On exit, it is on the last byte
 // of a token, such that the next iteration of the parser will be at the byte
 // immediately following the token, which would likely be the first byte of the
-// next token.
+// next token. The Visit functions follow the same invariant, but report each
+// value to a JSONReader::Visitor instead of creating a Value for it.
 class BASE_EXPORT JSONParser {
  public:
   explicit JSONParser(int options);
@@ -49,6 +50,10 @@ class BASE_EXPORT JSONParser {
   // result as a Value owned by the caller.
   Value* Parse(const StringPiece& input);
 
+  // Parses the input string according to the set options and reports its
+  // contents to |visitor|. Returns false on error.
+  bool Visit(const StringPiece& input, JSONReader::Visitor* visitor);
+
   // Returns the error code.
   JSONReader::JsonParseError error_code() const;
 
@@ -96,6 +101,10 @@ class BASE_EXPORT JSONParser {
     // AppendString below.
     void Append(const char& c);
 
+    // Like calling Append() for each of the |length| characters at |str|,
+    // which must directly follow the characters appended so far.
+    void AppendRun(const char* str, size_t length);
+
     // Appends a string to the std::string. Must be Convert()ed to use.
     void AppendString(const std::string& str);
 
@@ -126,6 +135,14 @@ class BASE_EXPORT JSONParser {
     std::string* string_;
   };
 
+  // Points the parser at the beginning of |length| bytes of |input|, skipping
+  // a UTF-8 Byte-Order-Mark, and resets the error information.
+  void StartParsing(const char* input, size_t length);
+
+  // Makes sure that nothing but whitespace and comments follows the root
+  // value. Returns false with error information set otherwise.
+  bool ConsumeEndOfInput();
+
   // Quick check that the stream has capacity to consume |length| more bytes.
   bool CanConsume(int length);
 
@@ -185,6 +202,9 @@ class BASE_EXPORT JSONParser {
   // Assuming that the parser is wound to the start of a valid JSON number,
   // this parses and converts it to either an int or double value.
   Value* ConsumeNumber();
+  // Helper for ConsumeNumber() that validates the number and stores its text
+  // in |num_string|. Returns false on failure with error information set.
+  bool ConsumeNumberRaw(StringPiece* num_string);
   // Helper that reads characters that are ints. Returns true if a number was
   // read and false on error.
   bool ReadInt(bool allow_leading_zeros);
@@ -192,6 +212,20 @@ class BASE_EXPORT JSONParser {
   // Consumes the literal values of |true|, |false|, and |null|, assuming the
   // parser is wound to the first character of any of those.
   Value* ConsumeLiteral();
+  // Helper for ConsumeLiteral() that consumes |literal|, which must be the
+  // next token. Returns false on failure with error information set.
+  bool ConsumeLiteralRaw(const char* literal);
+
+  // Counterparts of ParseNextToken(), ParseToken() and the Consume functions
+  // above that report to |visitor| instead of returning Values. They return
+  // false on failure with error information set.
+  bool VisitNextToken(JSONReader::Visitor* visitor);
+  bool VisitToken(Token token, JSONReader::Visitor* visitor);
+  bool VisitDictionary(JSONReader::Visitor* visitor);
+  bool VisitList(JSONReader::Visitor* visitor);
+  bool VisitString(JSONReader::Visitor* visitor);
+  bool VisitNumber(JSONReader::Visitor* visitor);
+  bool VisitLiteral(JSONReader::Visitor* visitor);
 
   // Compares two string buffers of a given length.
   static bool StringsAreEqual(const char* left, const char* right, size_t len);
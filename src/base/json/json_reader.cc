@@ -103,6 +103,10 @@ scoped_ptr<Value> JSONReader::ReadToValue(const std::string& json) {
   return make_scoped_ptr(parser_->Parse(json));
 }
 
+bool JSONReader::Visit(const StringPiece& json, Visitor* visitor) {
+  return parser_->Visit(json, visitor);
+}
+
 JSONReader::JsonParseError JSONReader::error_code() const {
   return parser_->error_code();
 }
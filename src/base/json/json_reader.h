@@ -74,6 +74,28 @@ class BASE_EXPORT JSONReader {
     JSON_PARSE_ERROR_COUNT
   };
 
+  // Receives the contents of a JSON document as a sequence of events, in
+  // document order, without a Value tree being built. Containers are reported
+  // with Begin/End pairs, and each dictionary value is preceded by a call to
+  // OnDictionaryKey(). String arguments are only valid for the duration of the
+  // call. Events are delivered as the input is parsed, so a document that
+  // turns out to be invalid may already have produced some of them.
+  class BASE_EXPORT Visitor {
+   public:
+    virtual ~Visitor() {}
+
+    virtual void OnNull() = 0;
+    virtual void OnBoolean(bool value) = 0;
+    virtual void OnInteger(int value) = 0;
+    virtual void OnDouble(double value) = 0;
+    virtual void OnString(const StringPiece& value) = 0;
+    virtual void OnListBegin() = 0;
+    virtual void OnListEnd() = 0;
+    virtual void OnDictionaryBegin() = 0;
+    virtual void OnDictionaryKey(const StringPiece& key) = 0;
+    virtual void OnDictionaryEnd() = 0;
+  };
+
   // String versions of parse error codes.
   static const char kInvalidEscape[];
   static const char kSyntaxError[];
@@ -117,7 +139,11 @@ class BASE_EXPORT JSONReader {
   // Parses an input string into a Value that is owned by the caller.
   scoped_ptr<Value> ReadToValue(const std::string& json);
 
-  // Returns the error code if the last call to ReadToValue() failed.
+  // Parses |json| and reports its contents to |visitor| instead of building a
+  // Value. Returns false if |json| is not a properly formed JSON string.
+  bool Visit(const StringPiece& json, Visitor* visitor);
+
+  // Returns the error code if the last call to ReadToValue() or Visit() failed.
   // Returns JSON_NO_ERROR otherwise.
   JsonParseError error_code() const;
 
@@ -6,6 +6,7 @@
 
 #include <string>
 
+#include "base/json/string_scan.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversion_utils.h"
@@ -73,6 +74,18 @@ bool EscapeSpecialCodePoint(uint32 code_point, std::string* dest) {
   return true;
 }
 
+// Appends the characters at the start of |str| that need no escaping to
+// |dest| and returns their number. Only 8-bit input is scanned in bulk.
+size_t AppendPlainChars(const StringPiece& str, std::string* dest) {
+  size_t count = internal::CountPlainCharsForWriter(str.data(), str.length());
+  dest->append(str.data(), count);
+  return count;
+}
+
+size_t AppendPlainChars(const StringPiece16& str, std::string* dest) {
+  return 0;
+}
+
 template <typename S>
 bool EscapeJSONStringImpl(const S& str, bool put_in_quotes, std::string* dest) {
   bool did_replacement = false;
@@ -85,6 +98,12 @@ bool EscapeJSONStringImpl(const S& str, bool put_in_quotes, std::string* dest) {
   const int32 length = static_cast<int32>(str.length());
 
   for (int32 i = 0; i < length; ++i) {
+    size_t run = AppendPlainChars(str.substr(i), dest);
+    if (run) {
+      i += static_cast<int32>(run) - 1;
+      continue;
+    }
+
     uint32 code_point;
     if (!ReadUnicodeCharacter(str.data(), length, &i, &code_point)) {
       code_point = kReplacementCodePoint;
@@ -0,0 +1,121 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/string_scan.h"
+
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#if defined(COMPILER_MSVC)
+#include <intrin.h>
+#endif
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+inline bool IsPlainForParser(unsigned char c) {
+  return c < 0x80 && c != '"' && c != '\\';
+}
+
+inline bool IsPlainForWriter(unsigned char c) {
+  return c >= 0x20 && c < 0x80 && c != '"' && c != '\\' && c != '<';
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+const size_t kBlockSize = sizeof(__m128i);
+
+// Returns the index of the lowest bit set in |mask|, which is not zero.
+inline size_t LowestBit(int mask) {
+#if defined(COMPILER_MSVC)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return index;
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+// Returns a bitmask with one bit per byte of |block| that is set for the bytes
+// the parser has to look at.
+inline int SpecialCharsForParser(__m128i block) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  __m128i special = _mm_or_si128(_mm_cmpeq_epi8(block, quote),
+                                 _mm_cmpeq_epi8(block, backslash));
+  // Bytes of multi-byte UTF-8 sequences have their top bit set.
+  return _mm_movemask_epi8(_mm_or_si128(special, block));
+}
+
+inline int SpecialCharsForWriter(__m128i block) {
+  const __m128i space = _mm_set1_epi8(0x20);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i less_than = _mm_set1_epi8('<');
+  // The comparison is signed, so bytes of multi-byte UTF-8 sequences are
+  // caught together with control characters.
+  __m128i special = _mm_or_si128(_mm_cmplt_epi8(block, space),
+                                 _mm_cmpeq_epi8(block, quote));
+  special = _mm_or_si128(special, _mm_cmpeq_epi8(block, backslash));
+  special = _mm_or_si128(special, _mm_cmpeq_epi8(block, less_than));
+  return _mm_movemask_epi8(special);
+}
+
+template <int (*SpecialChars)(__m128i), bool (*IsPlain)(unsigned char)>
+size_t CountPlainChars(const char* str, size_t length) {
+  size_t i = 0;
+  for (; i + kBlockSize <= length; i += kBlockSize) {
+    __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+    int mask = SpecialChars(block);
+    if (mask)
+      return i + LowestBit(mask);
+  }
+  while (i < length && IsPlain(static_cast<unsigned char>(str[i])))
+    ++i;
+  return i;
+}
+
+#else  // defined(ARCH_CPU_X86_FAMILY)
+
+template <bool (*IsPlain)(unsigned char)>
+size_t CountPlainChars(const char* str, size_t length) {
+  size_t i = 0;
+  while (i < length && IsPlain(static_cast<unsigned char>(str[i])))
+    ++i;
+  return i;
+}
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
+
+}  // namespace
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+size_t CountPlainCharsForParser(const char* str, size_t length) {
+  return CountPlainChars<SpecialCharsForParser, IsPlainForParser>(str, length);
+}
+
+size_t CountPlainCharsForWriter(const char* str, size_t length) {
+  return CountPlainChars<SpecialCharsForWriter, IsPlainForWriter>(str, length);
+}
+
+#else  // defined(ARCH_CPU_X86_FAMILY)
+
+size_t CountPlainCharsForParser(const char* str, size_t length) {
+  return CountPlainChars<IsPlainForParser>(str, length);
+}
+
+size_t CountPlainCharsForWriter(const char* str, size_t length) {
+  return CountPlainChars<IsPlainForWriter>(str, length);
+}
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,30 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Helpers that let the JSON reader and writer skip over runs of characters
+// that they would otherwise look at one code point at a time.
+
+#ifndef BASE_JSON_STRING_SCAN_H_
+#define BASE_JSON_STRING_SCAN_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+
+namespace base {
+namespace internal {
+
+// Returns the length of the longest prefix of |str| that JSONParser can take
+// as is while reading a string: ASCII characters other than '"' and '\\'.
+BASE_EXPORT size_t CountPlainCharsForParser(const char* str, size_t length);
+
+// Returns the length of the longest prefix of |str| that EscapeJSONString()
+// can copy to its output unchanged: printable ASCII characters other than
+// '"', '\\' and '<'.
+BASE_EXPORT size_t CountPlainCharsForWriter(const char* str, size_t length);
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_JSON_STRING_SCAN_H_
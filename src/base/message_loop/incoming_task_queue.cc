@@ -39,11 +39,19 @@ bool AlwaysNotifyPump(MessageLoop::Type type) {
 
 }  // namespace
 
+IncomingTaskQueue::IncomingTask::IncomingTask(const PendingTask& pending_task)
+    : pending_task(pending_task), link(NULL) {
+}
+
+IncomingTaskQueue::IncomingTask::~IncomingTask() {
+}
+
 IncomingTaskQueue::IncomingTaskQueue(MessageLoop* message_loop)
     : high_res_task_count_(0),
+      incoming_queue_(0),
       message_loop_(message_loop),
-      next_sequence_num_(0),
-      message_loop_scheduled_(false),
+      accepting_tasks_(1),
+      message_loop_scheduled_(0),
       always_schedule_work_(AlwaysNotifyPump(message_loop_->type())),
       is_ready_for_scheduling_(false) {
 }
@@ -58,7 +66,6 @@ bool IncomingTaskQueue::AddToIncomingQueue(
       << "Requesting super-long task delay period of " << delay.InSeconds()
       << " seconds from here: " << from_here.ToString();
 
-  AutoLock locked(incoming_queue_lock_);
   PendingTask pending_task(
       from_here, task, CalculateDelayedRuntime(delay), nestable);
 #if defined(OS_WIN)
@@ -68,7 +75,6 @@ bool IncomingTaskQueue::AddToIncomingQueue(
   // resolution on Windows is between 10 and 15ms.
   if (delay > TimeDelta() &&
       delay.InMilliseconds() < (2 * Time::kMinLowResolutionThresholdMs)) {
-    ++high_res_task_count_;
     pending_task.is_high_res = true;
   }
 #endif
@@ -76,36 +82,60 @@ bool IncomingTaskQueue::AddToIncomingQueue(
 }
 
 bool IncomingTaskQueue::HasHighResolutionTasks() {
-  AutoLock lock(incoming_queue_lock_);
-  return high_res_task_count_ > 0;
+  return subtle::NoBarrier_Load(&high_res_task_count_) > 0;
 }
 
 bool IncomingTaskQueue::IsIdleForTesting() {
-  AutoLock lock(incoming_queue_lock_);
-  return incoming_queue_.empty();
+  return !subtle::Acquire_Load(&incoming_queue_);
 }
 
 int IncomingTaskQueue::ReloadWorkQueue(TaskQueue* work_queue) {
   // Make sure no tasks are lost.
   DCHECK(work_queue->empty());
 
-  // Acquire all we can from the inter-thread queue with one lock acquisition.
-  AutoLock lock(incoming_queue_lock_);
-  if (incoming_queue_.empty()) {
+  // Acquire all we can from the inter-thread queue with one exchange.
+  IncomingTask* last_task = TakeIncomingTasks();
+  if (!last_task) {
     // If the loop attempts to reload but there are no tasks in the incoming
     // queue, that means it will go to sleep waiting for more work. If the
     // incoming queue becomes nonempty we need to schedule it again.
-    message_loop_scheduled_ = false;
-  } else {
-    incoming_queue_.Swap(work_queue);
+    subtle::NoBarrier_Store(&message_loop_scheduled_, 0);
+    subtle::MemoryBarrier();
+
+    // A task posted just before the flag was cleared may have seen it set and
+    // not scheduled work, so look once more before going to sleep.
+    last_task = TakeIncomingTasks();
+    if (!last_task)
+      return 0;
+    subtle::NoBarrier_Store(&message_loop_scheduled_, 1);
+  }
+
+  // The tasks are linked from the last one posted; put them back in order.
+  IncomingTask* first_task = NULL;
+  while (last_task) {
+    IncomingTask* previous_task = last_task->link;
+    last_task->link = first_task;
+    first_task = last_task;
+    last_task = previous_task;
   }
-  // Reset the count of high resolution tasks since our queue is now empty.
-  int high_res_tasks = high_res_task_count_;
-  high_res_task_count_ = 0;
+
+  int high_res_tasks = 0;
+  while (first_task) {
+    if (first_task->pending_task.is_high_res)
+      ++high_res_tasks;
+    work_queue->push(first_task->pending_task);
+    IncomingTask* next_task = first_task->link;
+    delete first_task;
+    first_task = next_task;
+  }
+
+  // Only count the high resolution tasks that are still in the incoming queue.
+  subtle::NoBarrier_AtomicIncrement(&high_res_task_count_, -high_res_tasks);
   return high_res_tasks;
 }
 
 void IncomingTaskQueue::WillDestroyCurrentMessageLoop() {
+  subtle::Release_Store(&accepting_tasks_, 0);
   AutoLock lock(incoming_queue_lock_);
   message_loop_ = NULL;
 }
@@ -113,15 +143,23 @@ void IncomingTaskQueue::WillDestroyCurrentMessageLoop() {
 void IncomingTaskQueue::StartScheduling() {
   AutoLock lock(incoming_queue_lock_);
   DCHECK(!is_ready_for_scheduling_);
-  DCHECK(!message_loop_scheduled_);
   is_ready_for_scheduling_ = true;
-  if (!incoming_queue_.empty())
+  if (subtle::Acquire_Load(&incoming_queue_))
     ScheduleWork();
 }
 
 IncomingTaskQueue::~IncomingTaskQueue() {
   // Verify that WillDestroyCurrentMessageLoop() has been called.
   DCHECK(!message_loop_);
+
+  // Tasks that were posted while the message loop was going away are never
+  // run, but still have to be destroyed.
+  IncomingTask* task = TakeIncomingTasks();
+  while (task) {
+    IncomingTask* previous_task = task->link;
+    delete task;
+    task = previous_task;
+  }
 }
 
 TimeTicks IncomingTaskQueue::CalculateDelayedRuntime(TimeDelta delay) {
@@ -138,10 +176,7 @@ bool IncomingTaskQueue::PostPendingTask(PendingTask* pending_task) {
   // directly, as it could starve handling of foreign threads.  Put every task
   // into this queue.
 
-  // This should only be called while the lock is taken.
-  incoming_queue_lock_.AssertAcquired();
-
-  if (!message_loop_) {
+  if (!subtle::Acquire_Load(&accepting_tasks_)) {
     pending_task->task.Reset();
     return false;
   }
@@ -149,24 +184,56 @@ bool IncomingTaskQueue::PostPendingTask(PendingTask* pending_task) {
   // Initialize the sequence number. The sequence number is used for delayed
   // tasks (to facilitate FIFO sorting when two tasks have the same
   // delayed_run_time value) and for identifying the task in about:tracing.
-  pending_task->sequence_num = next_sequence_num_++;
+  pending_task->sequence_num = next_sequence_num_.GetNext();
 
-  message_loop_->task_annotator()->DidQueueTask("MessageLoop::PostTask",
-                                                *pending_task);
+  task_annotator_.DidQueueTask("MessageLoop::PostTask", *pending_task);
 
-  bool was_empty = incoming_queue_.empty();
-  incoming_queue_.push(*pending_task);
+  IncomingTask* incoming_task = new IncomingTask(*pending_task);
   pending_task->task.Reset();
+  if (incoming_task->pending_task.is_high_res)
+    subtle::NoBarrier_AtomicIncrement(&high_res_task_count_, 1);
+
+  // Push the task, publishing its contents to ReloadWorkQueue().
+  subtle::AtomicWord previous_task = subtle::NoBarrier_Load(&incoming_queue_);
+  for (;;) {
+    incoming_task->link = reinterpret_cast<IncomingTask*>(previous_task);
+    subtle::AtomicWord observed_task = subtle::Release_CompareAndSwap(
+        &incoming_queue_, previous_task,
+        reinterpret_cast<subtle::AtomicWord>(incoming_task));
+    if (observed_task == previous_task)
+      break;
+    previous_task = observed_task;
+  }
 
-  if (is_ready_for_scheduling_ &&
-      (always_schedule_work_ || (!message_loop_scheduled_ && was_empty))) {
-    ScheduleWork();
+  bool needs_scheduling = always_schedule_work_;
+  if (!previous_task) {
+    // Pairs with the barrier in ReloadWorkQueue(): either the loop sees this
+    // task before going to sleep, or this sees the flag cleared.
+    subtle::MemoryBarrier();
+    needs_scheduling |=
+        !subtle::NoBarrier_CompareAndSwap(&message_loop_scheduled_, 0, 1);
+  }
+  if (needs_scheduling) {
+    AutoLock lock(incoming_queue_lock_);
+    // StartScheduling() takes care of tasks posted before it is called.
+    if (message_loop_ && is_ready_for_scheduling_)
+      ScheduleWork();
   }
 
   return true;
 }
 
+IncomingTaskQueue::IncomingTask* IncomingTaskQueue::TakeIncomingTasks() {
+  subtle::AtomicWord last_task =
+      subtle::NoBarrier_AtomicExchange(&incoming_queue_, 0);
+  // Pairs with the release in PostPendingTask().
+  subtle::MemoryBarrier();
+  return reinterpret_cast<IncomingTask*>(last_task);
+}
+
 void IncomingTaskQueue::ScheduleWork() {
+  // This should only be called while the lock is taken.
+  incoming_queue_lock_.AssertAcquired();
   DCHECK(is_ready_for_scheduling_);
   // Wake up the message loop.
   message_loop_->ScheduleWork();
@@ -175,7 +242,7 @@ void IncomingTaskQueue::ScheduleWork() {
   // waiting for more work again. The message loop will always attempt to
   // reload from the incoming queue before waiting again so we clear this flag
   // in ReloadWorkQueue().
-  message_loop_scheduled_ = true;
+  subtle::NoBarrier_Store(&message_loop_scheduled_, 1);
 }
 
 }  // namespace internal
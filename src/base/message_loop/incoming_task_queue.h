@@ -5,7 +5,10 @@
 #ifndef BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 #define BASE_MESSAGE_LOOP_INCOMING_TASK_QUEUE_H_
 
+#include "base/atomic_sequence_num.h"
+#include "base/atomicops.h"
 #include "base/base_export.h"
+#include "base/debug/task_annotator.h"
 #include "base/memory/ref_counted.h"
 #include "base/pending_task.h"
 #include "base/synchronization/lock.h"
@@ -21,6 +24,11 @@ namespace internal {
 // Implements a queue of tasks posted to the message loop running on the current
 // thread. This class takes care of synchronizing posting tasks from different
 // threads and together with MessageLoop ensures clean shutdown.
+//
+// Posting does not take a lock: tasks are pushed onto a lock-free list that
+// the message loop's thread takes over in one atomic exchange. The lock is only
+// taken to wake up the loop, which happens once per batch of tasks that finds
+// the loop idle, and to disconnect from the loop on shutdown.
 class BASE_EXPORT IncomingTaskQueue
     : public RefCountedThreadSafe<IncomingTaskQueue> {
  public:
@@ -50,6 +58,11 @@ class BASE_EXPORT IncomingTaskQueue
   // require high resolution timers.
   int ReloadWorkQueue(TaskQueue* work_queue);
 
+  // Returns the TaskAnnotator which is used to add debug information to posted
+  // tasks. It is owned by the queue so that it can be used while posting
+  // without touching the message loop.
+  debug::TaskAnnotator* task_annotator() { return &task_annotator_; }
+
   // Disconnects |this| from the parent message loop.
   void WillDestroyCurrentMessageLoop();
 
@@ -59,6 +72,20 @@ class BASE_EXPORT IncomingTaskQueue
 
  private:
   friend class RefCountedThreadSafe<IncomingTaskQueue>;
+
+  // An element of |incoming_queue_|.
+  struct IncomingTask {
+    explicit IncomingTask(const PendingTask& pending_task);
+    ~IncomingTask();
+
+    PendingTask pending_task;
+
+    // The task that was posted before this one while it is in
+    // |incoming_queue_|, and the one posted after it once ReloadWorkQueue()
+    // has put the tasks back in order.
+    IncomingTask* link;
+  };
+
   virtual ~IncomingTaskQueue();
 
   // Calculates the time at which a PendingTask should run.
@@ -70,30 +97,41 @@ class BASE_EXPORT IncomingTaskQueue
   // does not retain |pending_task->task| beyond this function call.
   bool PostPendingTask(PendingTask* pending_task);
 
-  // Wakes up the message loop and schedules work.
+  // Removes all tasks from |incoming_queue_| and returns the one that was
+  // posted last, or NULL if there were none.
+  IncomingTask* TakeIncomingTasks();
+
+  // Wakes up the message loop and schedules work, if it is still around and
+  // ready for it.
   void ScheduleWork();
 
-  // Number of tasks that require high resolution timing. This value is kept
-  // so that ReloadWorkQueue() completes in constant time.
-  int high_res_task_count_;
+  // Number of tasks in |incoming_queue_| that require high resolution timing.
+  subtle::Atomic32 high_res_task_count_;
 
-  // The lock that protects access to the members of this class.
+  // The lock that protects |message_loop_| and |is_ready_for_scheduling_|.
   base::Lock incoming_queue_lock_;
 
-  // An incoming queue of tasks that are acquired under a mutex for processing
-  // on this instance's thread. These tasks have not yet been been pushed to
-  // |message_loop_|.
-  TaskQueue incoming_queue_;
+  // The last IncomingTask* posted to this instance's thread, or 0. Each task
+  // links to the one that was posted before it. These tasks have not yet been
+  // pushed to |message_loop_|.
+  subtle::AtomicWord incoming_queue_;
 
   // Points to the message loop that owns |this|.
   MessageLoop* message_loop_;
 
+  // Non-zero until WillDestroyCurrentMessageLoop() is called. Lets posting
+  // reject tasks without taking |incoming_queue_lock_|.
+  subtle::Atomic32 accepting_tasks_;
+
+  // Used to annotate tasks as they are posted and run.
+  debug::TaskAnnotator task_annotator_;
+
   // The next sequence number to use for delayed tasks.
-  int next_sequence_num_;
+  AtomicSequenceNumber next_sequence_num_;
 
-  // True if our message loop has already been scheduled and does not need to be
-  // scheduled again until an empty reload occurs.
-  bool message_loop_scheduled_;
+  // Non-zero if our message loop has already been scheduled and does not need
+  // to be scheduled again until an empty reload occurs.
+  subtle::Atomic32 message_loop_scheduled_;
 
   // True if we always need to call ScheduleWork when receiving a new task, even
   // if the incoming queue was not empty.
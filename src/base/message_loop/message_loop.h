@@ -11,7 +11,6 @@
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/callback_forward.h"
-#include "base/debug/task_annotator.h"
 #include "base/location.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
@@ -396,10 +395,6 @@ class BASE_EXPORT MessageLoop : public MessagePump::Delegate {
   // Returns true if the message loop is "idle". Provided for testing.
   bool IsIdleForTesting();
 
-  // Returns the TaskAnnotator which is used to add debug information to posted
-  // tasks.
-  debug::TaskAnnotator* task_annotator() { return &task_annotator_; }
-
   // Runs the specified PendingTask.
   void RunTask(const PendingTask& pending_task);
 
@@ -539,8 +534,6 @@ class BASE_EXPORT MessageLoop : public MessagePump::Delegate {
 
   ObserverList<TaskObserver> task_observers_;
 
-  debug::TaskAnnotator task_annotator_;
-
   scoped_refptr<internal::IncomingTaskQueue> incoming_task_queue_;
 
   // A task runner which we haven't bound to a thread yet.
@@ -19,6 +19,7 @@
 #include "base/logging.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/metrics/sample_vector.h"
+#include "base/metrics/shared_histogram_allocator.h"
 #include "base/metrics/statistics_recorder.h"
 #include "base/pickle.h"
 #include "base/strings/string_util.h"
@@ -103,6 +104,7 @@ HistogramBase* Histogram::FactoryGet(const std::string& name,
         new Histogram(name, minimum, maximum, registered_ranges);
 
     tentative_histogram->SetFlags(flags);
+    tentative_histogram->AllocateSamplesInSharedMemory();
     histogram =
         StatisticsRecorder::RegisterOrDeleteDuplicate(tentative_histogram);
   }
@@ -341,6 +343,23 @@ Histogram::Histogram(const std::string& name,
 Histogram::~Histogram() {
 }
 
+void Histogram::AllocateSamplesInSharedMemory() {
+  SharedHistogramAllocator* allocator =
+      SharedHistogramAllocator::GetForCurrentProcess();
+  if (!allocator)
+    return;
+
+  // The reader finds or creates its version of the histogram with
+  // DeserializeHistogramInfo(), which expects the construction arguments to
+  // come with this flag, as they do over IPC.
+  SetFlags(kIPCSerializationSourceFlag);
+  scoped_ptr<SampleVector> shared_samples = allocator->AllocateSamples(*this);
+  if (!shared_samples)
+    return;
+  samples_ = shared_samples.Pass();
+  SetFlags(kSharedMemorySourceFlag);
+}
+
 bool Histogram::PrintEmptyBucket(size_t index) const {
   return true;
 }
@@ -607,6 +626,7 @@ HistogramBase* LinearHistogram::FactoryGetWithRangeDescription(
     }
 
     tentative_histogram->SetFlags(flags);
+    tentative_histogram->AllocateSamplesInSharedMemory();
     histogram =
         StatisticsRecorder::RegisterOrDeleteDuplicate(tentative_histogram);
   }
@@ -713,6 +733,7 @@ HistogramBase* BooleanHistogram::FactoryGet(const std::string& name,
         new BooleanHistogram(name, registered_ranges);
 
     tentative_histogram->SetFlags(flags);
+    tentative_histogram->AllocateSamplesInSharedMemory();
     histogram =
         StatisticsRecorder::RegisterOrDeleteDuplicate(tentative_histogram);
   }
@@ -776,6 +797,7 @@ HistogramBase* CustomHistogram::FactoryGet(
         new CustomHistogram(name, registered_ranges);
 
     tentative_histogram->SetFlags(flags);
+    tentative_histogram->AllocateSamplesInSharedMemory();
 
     histogram =
         StatisticsRecorder::RegisterOrDeleteDuplicate(tentative_histogram);
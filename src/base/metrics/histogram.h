@@ -198,6 +198,12 @@ class BASE_EXPORT Histogram : public HistogramBase {
 
   ~Histogram() override;
 
+  // Moves the samples of a histogram that has not been registered yet into
+  // the shared memory of SharedHistogramAllocator::GetForCurrentProcess(), if
+  // there is an allocator and the memory is not full. Called by the factories
+  // after setting the flags.
+  void AllocateSamplesInSharedMemory();
+
   // HistogramBase implementation:
   bool SerializeInfoImpl(base::Pickle* pickle) const override;
 
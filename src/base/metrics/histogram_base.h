@@ -79,6 +79,14 @@ class BASE_EXPORT HistogramBase {
     // to shortcut looking up the callback if it doesn't exist.
     kCallbackExists = 0x20,
 
+    // Indicates that the samples of this histogram are kept in memory shared
+    // with another process, which reads them from there (see
+    // SharedHistogramAllocator). They are not sent over IPC, and if we observe
+    // this flag on a histogram being aggregated into from shared memory, then
+    // we are running in single process mode and the aggregation should not
+    // take place.
+    kSharedMemorySourceFlag = 0x40,
+
     // Only for Histogram and its sub classes: fancy bucket-naming support.
     kHexRangePrintingFlag = 0x8000,
   };
@@ -23,6 +23,12 @@ class BucketRanges;
 class BASE_EXPORT SampleVector : public HistogramSamples {
  public:
   explicit SampleVector(const BucketRanges* bucket_ranges);
+  // Keeps the counts in |counts|, which must have room for one count per
+  // bucket, and the sum and the redundant count in |meta|. Both must outlive
+  // this object. Used for samples in shared memory.
+  SampleVector(const BucketRanges* bucket_ranges,
+               HistogramBase::AtomicCount* counts,
+               HistogramSamples::Metadata* meta);
   ~SampleVector() override;
 
   // HistogramSamples implementation:
@@ -45,7 +51,13 @@ class BASE_EXPORT SampleVector : public HistogramSamples {
  private:
   FRIEND_TEST_ALL_PREFIXES(HistogramTest, CorruptSampleCounts);
 
-  std::vector<HistogramBase::AtomicCount> counts_;
+  // Used unless the counts are kept elsewhere.
+  std::vector<HistogramBase::AtomicCount> local_counts_;
+
+  // Points to the storage of |local_counts_| or to the counts passed to the
+  // constructor; there are |counts_size_| of them.
+  HistogramBase::AtomicCount* const counts_;
+  const size_t counts_size_;
 
   // Shares the same BucketRanges with Histogram object.
   const BucketRanges* const bucket_ranges_;
@@ -55,7 +67,8 @@ class BASE_EXPORT SampleVector : public HistogramSamples {
 
 class BASE_EXPORT SampleVectorIterator : public SampleCountIterator {
  public:
-  SampleVectorIterator(const std::vector<HistogramBase::AtomicCount>* counts,
+  SampleVectorIterator(const HistogramBase::AtomicCount* counts,
+                       size_t counts_size,
                        const BucketRanges* bucket_ranges);
   ~SampleVectorIterator() override;
 
@@ -72,7 +85,8 @@ class BASE_EXPORT SampleVectorIterator : public SampleCountIterator {
  private:
   void SkipEmptyBuckets();
 
-  const std::vector<HistogramBase::AtomicCount>* counts_;
+  const HistogramBase::AtomicCount* counts_;
+  size_t counts_size_;
   const BucketRanges* bucket_ranges_;
 
   size_t index_;
@@ -0,0 +1,303 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/shared_histogram_allocator.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/atomicops.h"
+#include "base/logging.h"
+#include "base/metrics/bucket_ranges.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/sample_vector.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/pickle.h"
+
+namespace base {
+
+namespace {
+
+// Identifies a segment created by SharedHistogramAllocator::Create().
+const uint32 kSegmentCookie = 0x48495354;  // "HIST"
+
+// The start of every record is aligned to this, which suffices for the sum.
+const size_t kRecordAlignment = 8;
+
+struct SegmentHeader {
+  uint32 cookie;
+
+  // The size of the segment, as passed to Create().
+  uint32 size;
+
+  // The number of bytes in use, including this header. Advanced with a
+  // release store once a record is complete.
+  subtle::Atomic32 used;
+
+  uint32 reserved;
+};
+
+struct HistogramRecord {
+  // The size of the record, including this header and the padding that aligns
+  // the next record.
+  uint32 record_size;
+
+  uint32 bucket_count;
+
+  // The size of the construction arguments, which follow the counts.
+  uint32 info_size;
+
+  uint32 reserved;
+
+  HistogramSamples::Metadata meta;
+
+  // Followed by |bucket_count| counts and |info_size| bytes of construction
+  // arguments.
+};
+
+size_t RoundUpToAlignment(size_t size) {
+  return (size + kRecordAlignment - 1) & ~(kRecordAlignment - 1);
+}
+
+// The size of the Metadata, and thus of HistogramRecord, differs between 32
+// and 64 bit builds, but the layout of the segment must not, so the headers
+// have fixed sizes.
+const size_t kSegmentHeaderSize = 16;
+const size_t kRecordHeaderSize = 32;
+static_assert(sizeof(SegmentHeader) == kSegmentHeaderSize,
+              "SegmentHeader has an unexpected size");
+static_assert(sizeof(HistogramRecord) <= kRecordHeaderSize,
+              "HistogramRecord does not fit into its header");
+
+// The allocator set with SetForCurrentProcess().
+subtle::AtomicWord g_allocator = 0;
+
+}  // namespace
+
+struct SharedHistogramAllocator::ImportedHistogram {
+  // The histogram of this process that the samples are merged into.
+  Histogram* histogram;
+
+  // The samples in the segment.
+  scoped_ptr<SampleVector> shared_samples;
+
+  // The part of |shared_samples| that has been merged already.
+  scoped_ptr<SampleVector> merged_samples;
+};
+
+SharedHistogramAllocator::SharedHistogramAllocator(
+    scoped_ptr<SharedMemory> shared_memory,
+    size_t size)
+    : shared_memory_(shared_memory.Pass()),
+      size_(size),
+      import_offset_(kSegmentHeaderSize),
+      corrupt_(false) {}
+
+SharedHistogramAllocator::~SharedHistogramAllocator() {}
+
+// static
+scoped_ptr<SharedHistogramAllocator> SharedHistogramAllocator::Create(
+    size_t size) {
+  if (size < kSegmentHeaderSize || size > static_cast<size_t>(kint32max))
+    return scoped_ptr<SharedHistogramAllocator>();
+
+  // The segment is zero-filled, which is what new records rely on.
+  scoped_ptr<SharedMemory> shared_memory(new SharedMemory);
+  if (!shared_memory->CreateAndMapAnonymous(size))
+    return scoped_ptr<SharedHistogramAllocator>();
+
+  SegmentHeader* header = static_cast<SegmentHeader*>(shared_memory->memory());
+  header->cookie = kSegmentCookie;
+  header->size = static_cast<uint32>(size);
+  subtle::Release_Store(&header->used, kSegmentHeaderSize);
+  return make_scoped_ptr(
+      new SharedHistogramAllocator(shared_memory.Pass(), size));
+}
+
+// static
+scoped_ptr<SharedHistogramAllocator> SharedHistogramAllocator::CreateFromHandle(
+    const SharedMemoryHandle& handle,
+    size_t size) {
+  scoped_ptr<SharedMemory> shared_memory(new SharedMemory(handle, false));
+  if (size < kSegmentHeaderSize || !shared_memory->Map(size))
+    return scoped_ptr<SharedHistogramAllocator>();
+
+  const SegmentHeader* header =
+      static_cast<const SegmentHeader*>(shared_memory->memory());
+  if (header->cookie != kSegmentCookie || header->size != size)
+    return scoped_ptr<SharedHistogramAllocator>();
+  return make_scoped_ptr(
+      new SharedHistogramAllocator(shared_memory.Pass(), size));
+}
+
+// static
+void SharedHistogramAllocator::SetForCurrentProcess(
+    scoped_ptr<SharedHistogramAllocator> allocator) {
+  DCHECK(!GetForCurrentProcess());
+  subtle::Release_Store(&g_allocator,
+                        reinterpret_cast<subtle::AtomicWord>(allocator.get()));
+  ignore_result(allocator.release());
+}
+
+// static
+SharedHistogramAllocator* SharedHistogramAllocator::GetForCurrentProcess() {
+  return reinterpret_cast<SharedHistogramAllocator*>(
+      subtle::Acquire_Load(&g_allocator));
+}
+
+scoped_ptr<SampleVector> SharedHistogramAllocator::AllocateSamples(
+    const Histogram& histogram) {
+  Pickle info;
+  if (!histogram.SerializeInfo(&info))
+    return scoped_ptr<SampleVector>();
+
+  const BucketRanges* ranges = histogram.bucket_ranges();
+  size_t counts_size =
+      ranges->bucket_count() * sizeof(HistogramBase::AtomicCount);
+  size_t record_size =
+      RoundUpToAlignment(kRecordHeaderSize + counts_size + info.size());
+
+  AutoLock lock(lock_);
+  char* record_memory;
+  HistogramRecord* record;
+  RecordOffsetMap::const_iterator found =
+      record_offsets_.find(histogram.histogram_name());
+  if (found != record_offsets_.end()) {
+    // Threads that race to create a histogram each build one, and all but the
+    // one that gets registered are deleted again. They share a record, so that
+    // the deleted ones don't use up the segment, which is never freed.
+    record_memory =
+        static_cast<char*>(shared_memory_->memory()) + found->second;
+    record = reinterpret_cast<HistogramRecord*>(record_memory);
+    if (record->record_size != record_size ||
+        record->info_size != info.size() ||
+        memcmp(record_memory + kRecordHeaderSize + counts_size, info.data(),
+               info.size()) != 0) {
+      // The construction arguments don't match, so the factory will not
+      // return this histogram anyway.
+      return scoped_ptr<SampleVector>();
+    }
+  } else {
+    SegmentHeader* header =
+        static_cast<SegmentHeader*>(shared_memory_->memory());
+    size_t offset = subtle::NoBarrier_Load(&header->used);
+    if (record_size > size_ - offset)
+      return scoped_ptr<SampleVector>();
+
+    // The counts and the metadata start out zero, like the rest of the
+    // segment.
+    record_memory = static_cast<char*>(shared_memory_->memory()) + offset;
+    record = reinterpret_cast<HistogramRecord*>(record_memory);
+    record->record_size = static_cast<uint32>(record_size);
+    record->bucket_count = static_cast<uint32>(ranges->bucket_count());
+    record->info_size = static_cast<uint32>(info.size());
+    memcpy(record_memory + kRecordHeaderSize + counts_size, info.data(),
+           info.size());
+    subtle::Release_Store(&header->used,
+                          static_cast<subtle::Atomic32>(offset + record_size));
+    record_offsets_[histogram.histogram_name()] = offset;
+  }
+
+  return make_scoped_ptr(new SampleVector(
+      ranges,
+      reinterpret_cast<HistogramBase::AtomicCount*>(record_memory +
+                                                    kRecordHeaderSize),
+      &record->meta));
+}
+
+void SharedHistogramAllocator::MergeDeltas() {
+  // The segment is written by a process that is not trusted, so everything
+  // read from it is checked before it is used, and read only once.
+  const char* memory = static_cast<const char*>(shared_memory_->memory());
+  const SegmentHeader* header = reinterpret_cast<const SegmentHeader*>(memory);
+  size_t used = std::min(
+      static_cast<size_t>(static_cast<uint32>(subtle::Acquire_Load(
+          &header->used))),
+      size_);
+  while (!corrupt_ && import_offset_ < used &&
+         used - import_offset_ >= kRecordHeaderSize) {
+    const HistogramRecord* record =
+        reinterpret_cast<const HistogramRecord*>(memory + import_offset_);
+    size_t record_size = record->record_size;
+    size_t bucket_count = record->bucket_count;
+    size_t info_size = record->info_size;
+    if (record_size > used - import_offset_ ||
+        record_size % kRecordAlignment != 0 ||
+        bucket_count > Histogram::kBucketCount_MAX ||
+        info_size > record_size ||
+        kRecordHeaderSize + bucket_count * sizeof(HistogramBase::AtomicCount) +
+                info_size >
+            record_size) {
+      DLOG(ERROR) << "Malformed histogram record in shared memory";
+      corrupt_ = true;
+      break;
+    }
+
+    ImportedHistogram* imported =
+        ImportHistogram(import_offset_, bucket_count, info_size);
+    if (imported)
+      imported_histograms_.push_back(imported);
+    import_offset_ += record_size;
+  }
+
+  for (ScopedVector<ImportedHistogram>::iterator it =
+           imported_histograms_.begin();
+       it != imported_histograms_.end(); ++it) {
+    ImportedHistogram* imported = *it;
+    scoped_ptr<SampleVector> delta(
+        new SampleVector(imported->histogram->bucket_ranges()));
+    delta->Add(*imported->shared_samples);
+    delta->Subtract(*imported->merged_samples);
+    if (!delta->redundant_count() && !delta->TotalCount())
+      continue;
+    imported->histogram->AddSamples(*delta);
+    imported->merged_samples->Add(*delta);
+  }
+}
+
+SharedHistogramAllocator::ImportedHistogram*
+SharedHistogramAllocator::ImportHistogram(size_t offset,
+                                          size_t bucket_count,
+                                          size_t info_size) {
+  char* record_memory = static_cast<char*>(shared_memory_->memory()) + offset;
+  size_t counts_size = bucket_count * sizeof(HistogramBase::AtomicCount);
+
+  // Copied, so that the other process cannot change it while it is read.
+  std::string info(record_memory + kRecordHeaderSize + counts_size,
+                   info_size);
+  Pickle pickle(info.data(), checked_cast<int>(info.size()));
+  PickleIterator iter(pickle);
+  HistogramBase* histogram = DeserializeHistogramInfo(&iter);
+  if (!histogram)
+    return NULL;
+
+  if (histogram->flags() & HistogramBase::kSharedMemorySourceFlag) {
+    DVLOG(1) << "Single process mode, histogram observed and not copied: "
+             << histogram->histogram_name();
+    return NULL;
+  }
+  if (histogram->GetHistogramType() == SPARSE_HISTOGRAM)
+    return NULL;
+
+  Histogram* target = static_cast<Histogram*>(histogram);
+  const BucketRanges* ranges = target->bucket_ranges();
+  if (ranges->bucket_count() != bucket_count)
+    return NULL;
+
+  HistogramRecord* record = reinterpret_cast<HistogramRecord*>(record_memory);
+  ImportedHistogram* imported = new ImportedHistogram;
+  imported->histogram = target;
+  imported->shared_samples.reset(new SampleVector(
+      ranges,
+      reinterpret_cast<HistogramBase::AtomicCount*>(record_memory +
+                                                    kRecordHeaderSize),
+      &record->meta));
+  imported->merged_samples.reset(new SampleVector(ranges));
+  return imported;
+}
+
+}  // namespace base
@@ -0,0 +1,127 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_METRICS_SHARED_HISTOGRAM_ALLOCATOR_H_
+#define BASE_METRICS_SHARED_HISTOGRAM_ALLOCATOR_H_
+
+#include <map>
+#include <string>
+
+#include "base/base_export.h"
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/memory/shared_memory.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+class Histogram;
+class SampleVector;
+
+// SharedHistogramAllocator lays out the samples of histograms in a segment of
+// shared memory, so that a process can record samples without telling anyone
+// while another process reads them directly from the segment.
+//
+// One process (usually the browser) creates the segment with Create() and
+// hands it to another one (a child process), which maps it with
+// CreateFromHandle() and makes it the allocator for all histograms that are
+// created from then on with SetForCurrentProcess(). The samples of those
+// histograms are then recorded into the segment exactly as they would be into
+// memory of the process, without any locking. The creator of the segment
+// periodically calls MergeDeltas() to add what was recorded since the last
+// call to the histograms of its own StatisticsRecorder. As the segment
+// outlives the process that records into it, nothing is lost if that process
+// dies between two merges.
+//
+// The segment starts with a header, followed by one record per histogram.
+// Each record holds the sum, the redundant count and the bucket counts of the
+// samples, followed by the construction arguments of the histogram as
+// HistogramBase::SerializeInfo() writes them. Records are only appended, and
+// each is published by advancing the used size of the segment once it is
+// complete. The reader does not trust the contents of the segment.
+//
+// Only SampleVector based histograms (i.e. Histogram and its subclasses) are
+// allocated in shared memory. Sparse histograms, histograms created before
+// the allocator is set and histograms that no longer fit into the segment
+// keep their samples in memory of their process.
+class BASE_EXPORT SharedHistogramAllocator {
+ public:
+  ~SharedHistogramAllocator();
+
+  // Creates and maps a segment of |size| bytes for another process to
+  // allocate histograms in. Returns NULL on failure.
+  static scoped_ptr<SharedHistogramAllocator> Create(size_t size);
+
+  // Maps a segment of |size| bytes that was created with Create(), possibly
+  // in another process. Returns NULL if it cannot be mapped or is not such a
+  // segment.
+  static scoped_ptr<SharedHistogramAllocator> CreateFromHandle(
+      const SharedMemoryHandle& handle,
+      size_t size);
+
+  // Makes |allocator| the one that new histograms of this process keep their
+  // samples in. It is leaked, as the histograms never go away. Can only be
+  // called once.
+  static void SetForCurrentProcess(
+      scoped_ptr<SharedHistogramAllocator> allocator);
+
+  // Returns the allocator set with SetForCurrentProcess(), or NULL.
+  static SharedHistogramAllocator* GetForCurrentProcess();
+
+  // Allocates the samples of |histogram|, which has not been registered yet,
+  // in the segment. Histograms of the same name share their samples. Returns
+  // NULL if the segment is full, or if a histogram of the same name but with
+  // other construction arguments was allocated before. Thread safe.
+  scoped_ptr<SampleVector> AllocateSamples(const Histogram& histogram);
+
+  // Adds the samples that were recorded in the segment since the last call to
+  // the histograms of the same name in this process, creating them as needed.
+  // Must not be called on more than one thread at a time.
+  void MergeDeltas();
+
+  // The segment, e.g. to share it with another process.
+  SharedMemory* shared_memory() { return shared_memory_.get(); }
+
+ private:
+  struct ImportedHistogram;
+
+  SharedHistogramAllocator(scoped_ptr<SharedMemory> shared_memory,
+                           size_t size);
+
+  // Finds or creates the histogram of this process that matches the record
+  // at |offset|, which has been checked to hold |bucket_count| counts and
+  // |info_size| bytes of construction arguments. Returns NULL if the record
+  // does not describe a histogram that can be merged into.
+  ImportedHistogram* ImportHistogram(size_t offset,
+                                     size_t bucket_count,
+                                     size_t info_size);
+
+  scoped_ptr<SharedMemory> shared_memory_;
+  const size_t size_;
+
+  // Serializes AllocateSamples().
+  Lock lock_;
+
+  // The offsets of the records that AllocateSamples() wrote, by histogram
+  // name.
+  typedef std::map<std::string, size_t> RecordOffsetMap;
+  RecordOffsetMap record_offsets_;
+
+  // The offset of the first record that MergeDeltas() did not look at yet.
+  size_t import_offset_;
+
+  // Set when MergeDeltas() finds a malformed record, after which it stops
+  // looking at new records.
+  bool corrupt_;
+
+  // The histograms found by MergeDeltas().
+  ScopedVector<ImportedHistogram> imported_histograms_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedHistogramAllocator);
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_SHARED_HISTOGRAM_ALLOCATOR_H_
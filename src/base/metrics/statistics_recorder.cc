@@ -4,8 +4,11 @@
 
 #include "base/metrics/statistics_recorder.h"
 
+#include <string.h>
+
 #include "base/at_exit.h"
 #include "base/debug/leak_annotations.h"
+#include "base/hash.h"
 #include "base/json/string_escape.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
@@ -19,10 +22,81 @@ namespace {
 // Initialize histogram statistics gathering system.
 base::LazyInstance<base::StatisticsRecorder>::Leaky g_statistics_recorder_ =
     LAZY_INSTANCE_INITIALIZER;
+
+// The number of histograms the index has room for initially. It doubles
+// whenever it is half full.
+const size_t kInitialIndexCapacity = 1024;
 }  // namespace
 
 namespace base {
 
+// An open addressing hash table from the hash of a histogram name to the
+// histogram, which only ever grows. Entries are published with release
+// stores, so lookups are safe while another thread inserts. Inserts must be
+// serialized by the caller.
+class StatisticsRecorder::HistogramIndex {
+ public:
+  // |capacity| must be a power of two.
+  explicit HistogramIndex(size_t capacity)
+      : capacity_(capacity), size_(0), entries_(new Entry[capacity]) {
+    DCHECK_EQ(0u, capacity & (capacity - 1));
+    memset(entries_.get(), 0, capacity * sizeof(Entry));
+  }
+
+  HistogramBase* Find(const std::string& name, uint32 name_hash) const {
+    // There is always an empty entry, which ends the search.
+    for (size_t i = name_hash;; ++i) {
+      const Entry& entry = entries_[i & (capacity_ - 1)];
+      HistogramBase* histogram = reinterpret_cast<HistogramBase*>(
+          subtle::Acquire_Load(&entry.histogram));
+      if (!histogram)
+        return NULL;
+      if (entry.name_hash == name_hash && histogram->histogram_name() == name)
+        return histogram;
+    }
+  }
+
+  // Returns false if the index is too full to add |histogram|.
+  bool Insert(HistogramBase* histogram, uint32 name_hash) {
+    if ((size_ + 1) * 2 > capacity_)
+      return false;
+    for (size_t i = name_hash;; ++i) {
+      Entry& entry = entries_[i & (capacity_ - 1)];
+      if (entry.histogram)
+        continue;
+      entry.name_hash = name_hash;
+      subtle::Release_Store(&entry.histogram,
+                            reinterpret_cast<subtle::AtomicWord>(histogram));
+      ++size_;
+      return true;
+    }
+  }
+
+  // Returns a copy with twice the capacity.
+  HistogramIndex* CreateLargerCopy() const {
+    HistogramIndex* copy = new HistogramIndex(capacity_ * 2);
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (entries_[i].histogram) {
+        copy->Insert(reinterpret_cast<HistogramBase*>(entries_[i].histogram),
+                     entries_[i].name_hash);
+      }
+    }
+    return copy;
+  }
+
+ private:
+  struct Entry {
+    uint32 name_hash;
+    subtle::AtomicWord histogram;
+  };
+
+  const size_t capacity_;
+  size_t size_;
+  scoped_ptr<Entry[]> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(HistogramIndex);
+};
+
 // static
 void StatisticsRecorder::Initialize() {
   // Ensure that an instance of the StatisticsRecorder object is created.
@@ -31,10 +105,7 @@ void StatisticsRecorder::Initialize() {
 
 // static
 bool StatisticsRecorder::IsActive() {
-  if (lock_ == NULL)
-    return false;
-  base::AutoLock auto_lock(*lock_);
-  return NULL != histograms_;
+  return subtle::Acquire_Load(&index_) != 0;
 }
 
 // static
@@ -61,6 +132,7 @@ HistogramBase* StatisticsRecorder::RegisterOrDeleteDuplicate(
       HistogramMap::iterator it = histograms_->find(HistogramNameRef(name));
       if (histograms_->end() == it) {
         (*histograms_)[HistogramNameRef(name)] = histogram;
+        AddToIndexWhileLocked(histogram);
         ANNOTATE_LEAKING_OBJECT_PTR(histogram);  // see crbug.com/79322
         // If there are callbacks for this histogram, we set the kCallbackExists
         // flag.
@@ -223,16 +295,11 @@ void StatisticsRecorder::GetBucketRanges(
 
 // static
 HistogramBase* StatisticsRecorder::FindHistogram(const std::string& name) {
-  if (lock_ == NULL)
-    return NULL;
-  base::AutoLock auto_lock(*lock_);
-  if (histograms_ == NULL)
+  const HistogramIndex* index =
+      reinterpret_cast<const HistogramIndex*>(subtle::Acquire_Load(&index_));
+  if (!index)
     return NULL;
-
-  HistogramMap::iterator it = histograms_->find(HistogramNameRef(name));
-  if (histograms_->end() == it)
-    return NULL;
-  return it->second;
+  return index->Find(name, Hash(name));
 }
 
 // static
@@ -302,6 +369,23 @@ void StatisticsRecorder::GetSnapshot(const std::string& query,
   }
 }
 
+// static
+void StatisticsRecorder::AddToIndexWhileLocked(HistogramBase* histogram) {
+  lock_->AssertAcquired();
+  HistogramIndex* index =
+      reinterpret_cast<HistogramIndex*>(subtle::NoBarrier_Load(&index_));
+  uint32 name_hash = Hash(histogram->histogram_name());
+  if (index->Insert(histogram, name_hash))
+    return;
+
+  HistogramIndex* larger_index = index->CreateLargerCopy();
+  bool inserted = larger_index->Insert(histogram, name_hash);
+  DCHECK(inserted);
+  ANNOTATE_LEAKING_OBJECT_PTR(index);
+  subtle::Release_Store(&index_,
+                        reinterpret_cast<subtle::AtomicWord>(larger_index));
+}
+
 // This singleton instance should be started during the single threaded portion
 // of main(), and hence it is not thread safe.  It initializes globals to
 // provide support for all future calls.
@@ -320,6 +404,8 @@ StatisticsRecorder::StatisticsRecorder() {
   histograms_ = new HistogramMap;
   callbacks_ = new CallbackMap;
   ranges_ = new RangesMap;
+  HistogramIndex* index = new HistogramIndex(kInitialIndexCapacity);
+  subtle::Release_Store(&index_, reinterpret_cast<subtle::AtomicWord>(index));
 
   if (VLOG_IS_ON(1))
     AtExitManager::RegisterCallback(&DumpHistogramsToVlog, this);
@@ -349,8 +435,12 @@ StatisticsRecorder::~StatisticsRecorder() {
     histograms_ = NULL;
     callbacks_ = NULL;
     ranges_ = NULL;
+    // Lookups may still be using the index.
+    ANNOTATE_LEAKING_OBJECT_PTR(
+        reinterpret_cast<HistogramIndex*>(subtle::NoBarrier_Load(&index_)));
+    subtle::Release_Store(&index_, 0);
   }
-  // We are going to leak the histograms and the ranges.
+  // We are going to leak the histograms, the ranges and the index.
 }
 
 
@@ -362,5 +452,7 @@ StatisticsRecorder::CallbackMap* StatisticsRecorder::callbacks_ = NULL;
 StatisticsRecorder::RangesMap* StatisticsRecorder::ranges_ = NULL;
 // static
 base::Lock* StatisticsRecorder::lock_ = NULL;
+// static
+subtle::AtomicWord StatisticsRecorder::index_ = 0;
 
 }  // namespace base
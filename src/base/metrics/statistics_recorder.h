@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 
+#include "base/atomicops.h"
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/callback.h"
@@ -67,7 +68,8 @@ class BASE_EXPORT StatisticsRecorder {
   static void GetBucketRanges(std::vector<const BucketRanges*>* output);
 
   // Find a histogram by name. It matches the exact name. This method is thread
-  // safe.  It returns NULL if a matching histogram is not found.
+  // safe and does not take a lock.  It returns NULL if a matching histogram is
+  // not found.
   static HistogramBase* FindHistogram(const std::string& name);
 
   // GetSnapshot copies some of the pointers to registered histograms into the
@@ -95,6 +97,8 @@ class BASE_EXPORT StatisticsRecorder {
   static OnSampleCallback FindCallback(const std::string& histogram_name);
 
  private:
+  class HistogramIndex;
+
   // HistogramNameRef holds a weak const ref to the name field of the associated
   // Histogram object, allowing re-use of the underlying string storage for the
   // map keys. The wrapper is required as using "const std::string&" as the key
@@ -141,6 +145,10 @@ class BASE_EXPORT StatisticsRecorder {
 
   static void DumpHistogramsToVlog(void* instance);
 
+  // Adds |histogram|, which was just added to |histograms_|, to |index_|.
+  // Must be called with |lock_| held.
+  static void AddToIndexWhileLocked(HistogramBase* histogram);
+
   static HistogramMap* histograms_;
   static CallbackMap* callbacks_;
   static RangesMap* ranges_;
@@ -148,6 +156,12 @@ class BASE_EXPORT StatisticsRecorder {
   // Lock protects access to above maps.
   static base::Lock* lock_;
 
+  // A HistogramIndex of the histograms in |histograms_|, which is read
+  // without holding |lock_|. It is NULL whenever |histograms_| is, and is
+  // replaced by a larger copy when it fills up; as readers may still be
+  // looking at the old copy, that one is leaked.
+  static subtle::AtomicWord index_;
+
   DISALLOW_COPY_AND_ASSIGN(StatisticsRecorder);
 };
 
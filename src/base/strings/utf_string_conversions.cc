@@ -7,34 +7,192 @@
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversion_utils.h"
+#include "base/third_party/icu/icu_utf.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#endif
 
 namespace base {
 
 namespace {
 
+// ASCII fast paths ------------------------------------------------------------
+
+template<typename CHAR>
+inline bool IsASCIIUnit(CHAR c) {
+  return (c & ~0x7F) == 0;
+}
+
+template<typename SRC_CHAR, typename DEST_CHAR>
+size_t CopyASCIIChars(const SRC_CHAR* src, size_t src_len, DEST_CHAR* dest) {
+  size_t i = 0;
+  for (; i < src_len && IsASCIIUnit(src[i]); ++i)
+    dest[i] = static_cast<DEST_CHAR>(src[i]);
+  return i;
+}
+
+// Copies the longest prefix of |src| that consists of ASCII characters to
+// |dest|, converting each code unit, and returns its length.
+template<typename SRC_CHAR, typename DEST_CHAR>
+size_t CopyASCIIPrefix(const SRC_CHAR* src, size_t src_len, DEST_CHAR* dest) {
+  return CopyASCIIChars(src, src_len, dest);
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+// UTF-8 to UTF-16 and back are the conversions that large amounts of text go
+// through, so those copy 16 ASCII characters at a time.
+const size_t kBlockSize = sizeof(__m128i);
+
+template<>
+size_t CopyASCIIPrefix(const char* src, size_t src_len, char16* dest) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + kBlockSize <= src_len; i += kBlockSize) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    // Non-ASCII bytes have their top bit set.
+    if (_mm_movemask_epi8(block))
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                     _mm_unpacklo_epi8(block, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + kBlockSize / 2),
+                     _mm_unpackhi_epi8(block, zero));
+  }
+  return i + CopyASCIIChars(src + i, src_len - i, dest + i);
+}
+
+template<>
+size_t CopyASCIIPrefix(const char16* src, size_t src_len, char* dest) {
+  const __m128i non_ascii_bits = _mm_set1_epi16(static_cast<short>(0xFF80));
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + kBlockSize <= src_len; i += kBlockSize) {
+    __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i high = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(src + i + kBlockSize / 2));
+    __m128i bits = _mm_and_si128(_mm_or_si128(low, high), non_ascii_bits);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(bits, zero)) != 0xFFFF)
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                     _mm_packus_epi16(low, high));
+  }
+  return i + CopyASCIIChars(src + i, src_len - i, dest + i);
+}
+
+#endif  // defined(ARCH_CPU_X86_FAMILY)
+
 // Generalized Unicode converter -----------------------------------------------
 
+// Reads the code point at |*char_index| like ReadUnicodeCharacter().
+template<typename SRC_CHAR>
+inline bool ReadCharacter(const SRC_CHAR* src,
+                          int32 src_len,
+                          int32* char_index,
+                          uint32* code_point) {
+  return ReadUnicodeCharacter(src, src_len, char_index, code_point);
+}
+
+// Decodes well-formed two and three byte sequences, which make up all of the
+// BMP, inline and leaves everything else to ReadUnicodeCharacter(), so that
+// malformed input is replaced exactly as before.
+template<>
+inline bool ReadCharacter(const char* src,
+                          int32 src_len,
+                          int32* char_index,
+                          uint32* code_point) {
+  const uint8* s = reinterpret_cast<const uint8*>(src);
+  int32 i = *char_index;
+  if (s[i] >= 0xC2 && s[i] <= 0xDF && i + 1 < src_len &&
+      (s[i + 1] & 0xC0) == 0x80) {
+    *code_point = ((s[i] & 0x1F) << 6) | (s[i + 1] & 0x3F);
+    *char_index = i + 1;
+    return true;
+  }
+  if ((s[i] & 0xF0) == 0xE0 && i + 2 < src_len &&
+      (s[i + 1] & 0xC0) == 0x80 && (s[i + 2] & 0xC0) == 0x80) {
+    uint32 c = ((s[i] & 0x0F) << 12) | ((s[i + 1] & 0x3F) << 6) |
+               (s[i + 2] & 0x3F);
+    // Overlong sequences and surrogates are errors.
+    if (c >= 0x800 && (c < 0xD800 || c > 0xDFFF)) {
+      *code_point = c;
+      *char_index = i + 2;
+      return true;
+    }
+  }
+  return ReadUnicodeCharacter(src, src_len, char_index, code_point);
+}
+
+// Appends |code_point| to |dest| at |*dest_len|, which must have room for it,
+// and advances |*dest_len|.
+inline void AppendUnsafe(char* dest, size_t* dest_len, uint32 code_point) {
+  CBU8_APPEND_UNSAFE(dest, *dest_len, code_point);
+}
+
+inline void AppendUnsafe(char16* dest, size_t* dest_len, uint32 code_point) {
+  CBU16_APPEND_UNSAFE(dest, *dest_len, code_point);
+}
+
+#if defined(WCHAR_T_IS_UTF32)
+inline void AppendUnsafe(wchar_t* dest, size_t* dest_len, uint32 code_point) {
+  dest[(*dest_len)++] = static_cast<wchar_t>(code_point);
+}
+#endif  // defined(WCHAR_T_IS_UTF32)
+
+// Returns the largest number of code units of |DEST_CHAR| that one code unit
+// of |SRC_CHAR| can turn into. A UTF-16 unit is at most 3 bytes of UTF-8 (the
+// 4 byte sequences come from surrogate pairs), and a UTF-32 unit at most 2
+// UTF-16 units or 4 bytes.
+template<typename SRC_CHAR, typename DEST_CHAR>
+size_t MaxDestUnitsPerSrcUnit() {
+  if (sizeof(DEST_CHAR) == 1)
+    return sizeof(SRC_CHAR) == 2 ? 3 : sizeof(SRC_CHAR);
+  return sizeof(SRC_CHAR) > sizeof(DEST_CHAR) ? 2 : 1;
+}
+
 // Converts the given source Unicode character type to the given destination
 // Unicode character type as a STL string. The given input buffer and size
 // determine the source, and the given output STL string will be replaced by
 // the result.
+//
+// The output is sized for the worst case up front and written through a
+// pointer, and runs of ASCII characters are copied without decoding them.
 template<typename SRC_CHAR, typename DEST_STRING>
 bool ConvertUnicode(const SRC_CHAR* src,
                     size_t src_len,
                     DEST_STRING* output) {
+  typedef typename DEST_STRING::value_type DEST_CHAR;
+  output->resize(src_len * MaxDestUnitsPerSrcUnit<SRC_CHAR, DEST_CHAR>());
+  if (src_len == 0)
+    return true;
+  DEST_CHAR* dest = &(*output)[0];
+  size_t dest_len = 0;
+
   // ICU requires 32-bit numbers.
   bool success = true;
   int32 src_len32 = static_cast<int32>(src_len);
   for (int32 i = 0; i < src_len32; i++) {
+    if (IsASCIIUnit(src[i])) {
+      size_t ascii_len = CopyASCIIPrefix(src + i, src_len32 - i,
+                                         dest + dest_len);
+      i += static_cast<int32>(ascii_len) - 1;
+      dest_len += ascii_len;
+      continue;
+    }
     uint32 code_point;
-    if (ReadUnicodeCharacter(src, src_len32, &i, &code_point)) {
-      WriteUnicodeCharacter(code_point, output);
-    } else {
-      WriteUnicodeCharacter(0xFFFD, output);
+    if (!ReadCharacter(src, src_len32, &i, &code_point)) {
+      code_point = 0xFFFD;
       success = false;
     }
+    AppendUnsafe(dest, &dest_len, code_point);
   }
 
+  output->resize(dest_len);
+  // Do not hold on to the space for the worst case, which is up to 4 times
+  // what is needed.
+  if (output->capacity() > 2 * dest_len)
+    DEST_STRING(*output).swap(*output);
   return success;
 }
 
@@ -47,7 +205,6 @@ bool WideToUTF8(const wchar_t* src, size_t src_len, std::string* output) {
     output->assign(src, src + src_len);
     return true;
   } else {
-    PrepareForUTF8Output(src, src_len, output);
     return ConvertUnicode(src, src_len, output);
   }
 }
@@ -58,7 +215,6 @@ std::string WideToUTF8(const std::wstring& wide) {
   }
 
   std::string ret;
-  PrepareForUTF8Output(wide.data(), wide.length(), &ret);
   ConvertUnicode(wide.data(), wide.length(), &ret);
   return ret;
 }
@@ -68,7 +224,6 @@ bool UTF8ToWide(const char* src, size_t src_len, std::wstring* output) {
     output->assign(src, src + src_len);
     return true;
   } else {
-    PrepareForUTF16Or32Output(src, src_len, output);
     return ConvertUnicode(src, src_len, output);
   }
 }
@@ -79,7 +234,6 @@ std::wstring UTF8ToWide(StringPiece utf8) {
   }
 
   std::wstring ret;
-  PrepareForUTF16Or32Output(utf8.data(), utf8.length(), &ret);
   ConvertUnicode(utf8.data(), utf8.length(), &ret);
   return ret;
 }
@@ -110,10 +264,6 @@ std::wstring UTF16ToWide(const string16& utf16) {
 #elif defined(WCHAR_T_IS_UTF32)
 
 bool WideToUTF16(const wchar_t* src, size_t src_len, string16* output) {
-  output->clear();
-  // Assume that normally we won't have any non-BMP characters so the counts
-  // will be the same.
-  output->reserve(src_len);
   return ConvertUnicode(src, src_len, output);
 }
 
@@ -124,10 +274,6 @@ string16 WideToUTF16(const std::wstring& wide) {
 }
 
 bool UTF16ToWide(const char16* src, size_t src_len, std::wstring* output) {
-  output->clear();
-  // Assume that normally we won't have any non-BMP characters so the counts
-  // will be the same.
-  output->reserve(src_len);
   return ConvertUnicode(src, src_len, output);
 }
 
@@ -148,7 +294,6 @@ bool UTF8ToUTF16(const char* src, size_t src_len, string16* output) {
     output->assign(src, src + src_len);
     return true;
   } else {
-    PrepareForUTF16Or32Output(src, src_len, output);
     return ConvertUnicode(src, src_len, output);
   }
 }
@@ -159,7 +304,6 @@ string16 UTF8ToUTF16(StringPiece utf8) {
   }
 
   string16 ret;
-  PrepareForUTF16Or32Output(utf8.data(), utf8.length(), &ret);
   // Ignore the success flag of this call, it will do the best it can for
   // invalid input, which is what we want here.
   ConvertUnicode(utf8.data(), utf8.length(), &ret);
@@ -171,7 +315,6 @@ bool UTF16ToUTF8(const char16* src, size_t src_len, std::string* output) {
     output->assign(src, src + src_len);
     return true;
   } else {
-    PrepareForUTF8Output(src, src_len, output);
     return ConvertUnicode(src, src_len, output);
   }
 }
@@ -208,7 +351,6 @@ std::string UTF16ToUTF8(StringPiece16 utf16) {
     return std::string(utf16.data(), utf16.data() + utf16.length());
 
   std::string ret;
-  PrepareForUTF8Output(utf16.data(), utf16.length(), &ret);
   ConvertUnicode(utf16.data(), utf16.length(), &ret);
   return ret;
 }
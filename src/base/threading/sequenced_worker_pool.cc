@@ -328,6 +328,8 @@ class SequencedWorkerPool::Inner {
   void ThreadLoop(Worker* this_worker);
 
  private:
+  typedef std::set<SequencedTask, SequencedTaskLessThan> PendingTaskSet;
+
   enum GetWorkStatus {
     GET_WORK_FOUND,
     GET_WORK_NOT_FOUND,
@@ -381,6 +383,20 @@ class SequencedWorkerPool::Inner {
   // sequence token.
   bool IsSequenceTokenRunnable(int sequence_token_id) const;
 
+  // Adds a newly posted task to |runnable_tasks_| or to its sequence. Must be
+  // called from within the lock.
+  void LockedAddPendingTask(const SequencedTask& task);
+
+  // Removes |task| from |runnable_tasks_|. Does not make the next task in its
+  // sequence runnable; see LockedUpdateRunnableSequenceTask. Must be called
+  // from within the lock.
+  void LockedRemoveRunnableTask(PendingTaskSet::iterator task);
+
+  // Makes sure that |runnable_tasks_| holds the first pending task of the given
+  // sequence, unless a thread is running that sequence. Must be called from
+  // within the lock.
+  void LockedUpdateRunnableSequenceTask(int sequence_token_id);
+
   // Checks if all threads are busy and the addition of one more could run an
   // additional task waiting in the queue. This must be called from within
   // the lock.
@@ -454,19 +470,37 @@ class SequencedWorkerPool::Inner {
   // or SKIP_ON_SHUTDOWN flag set.
   size_t blocking_shutdown_thread_count_;
 
-  // A set of all pending tasks in time-to-run order. These are tasks that are
-  // either waiting for a thread to run on, waiting for their time to run,
-  // or blocked on a previous task in their sequence. We have to iterate over
-  // the tasks by time-to-run order, so we use the set instead of the
-  // traditional priority_queue.
-  typedef std::set<SequencedTask, SequencedTaskLessThan> PendingTaskSet;
-  PendingTaskSet pending_tasks_;
+  // The pending tasks that could run as soon as a thread is free and their
+  // time to run has come, in time-to-run order: all tasks without a sequence
+  // token, and the first task of every sequence that no thread is running. We
+  // have to remove tasks from the middle when shutting down, so we use the set
+  // instead of the traditional priority_queue.
+  PendingTaskSet runnable_tasks_;
+
+  // The pending tasks of one sequence token.
+  struct PendingSequence {
+    PendingSequence();
+    ~PendingSequence();
+
+    // The task of this sequence in |runnable_tasks_|, if
+    // |has_runnable_task|.
+    PendingTaskSet::iterator runnable_task;
+    bool has_runnable_task;
+
+    // The other tasks of this sequence, in time-to-run order.
+    PendingTaskSet waiting_tasks;
+  };
+
+  // Sequences that have pending tasks, by sequence token ID. Keeps finding the
+  // next runnable task independent of how many tasks are blocked on a
+  // previous task in their sequence.
+  typedef std::map<int, PendingSequence> PendingSequenceMap;
+  PendingSequenceMap pending_sequences_;
 
   // The next sequence number for a new sequenced task.
   int64 next_sequence_task_number_;
 
-  // Number of tasks in the pending_tasks_ list that are marked as blocking
-  // shutdown.
+  // Number of pending tasks that are marked as blocking shutdown.
   size_t blocking_shutdown_pending_task_count_;
 
   // Lists all sequence tokens currently executing.
@@ -545,6 +579,11 @@ LazyInstance<ThreadLocalPointer<SequencedWorkerPool::Worker>>::Leaky
 
 // Inner definitions ---------------------------------------------------------
 
+SequencedWorkerPool::Inner::PendingSequence::PendingSequence()
+    : has_runnable_task(false) {}
+
+SequencedWorkerPool::Inner::PendingSequence::~PendingSequence() {}
+
 SequencedWorkerPool::Inner::Inner(
     SequencedWorkerPool* worker_pool,
     size_t max_threads,
@@ -651,7 +690,7 @@ bool SequencedWorkerPool::Inner::PostTask(
     if (optional_token_name)
       sequenced.sequence_token_id = LockedGetNamedTokenID(*optional_token_name);
 
-    pending_tasks_.insert(sequenced);
+    LockedAddPendingTask(sequenced);
     if (shutdown_behavior == BLOCK_SHUTDOWN)
       blocking_shutdown_pending_task_count_++;
 
@@ -691,7 +730,8 @@ void SequencedWorkerPool::Inner::CleanupForTesting() {
   CHECK_EQ(CLEANUP_DONE, cleanup_state_);
   if (shutdown_called_)
     return;
-  if (pending_tasks_.empty() && waiting_thread_count_ == threads_.size())
+  if (runnable_tasks_.empty() && pending_sequences_.empty() &&
+      waiting_thread_count_ == threads_.size())
     return;
   cleanup_state_ = CLEANUP_REQUESTED;
   cleanup_idlers_ = 0;
@@ -953,41 +993,18 @@ SequencedWorkerPool::Inner::GetWorkStatus SequencedWorkerPool::Inner::GetWork(
     std::vector<Closure>* delete_these_outside_lock) {
   lock_.AssertAcquired();
 
-  // Find the next task with a sequence token that's not currently in use.
-  // If the token is in use, that means another thread is running something
-  // in that sequence, and we can't run it without going out-of-order.
-  //
-  // This algorithm is simple and fair, but inefficient in some cases. For
-  // example, say somebody schedules 1000 slow tasks with the same sequence
-  // number. We'll have to go through all those tasks each time we feel like
-  // there might be work to schedule. If this proves to be a problem, we
-  // should make this more efficient.
-  //
-  // One possible enhancement would be to keep a map from sequence ID to a
-  // list of pending but currently blocked SequencedTasks for that ID.
-  // When a worker finishes a task of one sequence token, it can pick up the
-  // next one from that token right away.
-  //
-  // This may lead to starvation if there are sufficient numbers of sequences
-  // in use. To alleviate this, we could add an incrementing priority counter
-  // to each SequencedTask. Then maintain a priority_queue of all runnable
-  // tasks, sorted by priority counter. When a sequenced task is completed
-  // we would pop the head element off of that tasks pending list and add it
-  // to the priority queue. Then we would run the first item in the priority
-  // queue.
-
+  // Find the first task in time-to-run order with a sequence token that's
+  // not currently in use. If the token is in use, that means another thread
+  // is running something in that sequence, and we can't run it without going
+  // out-of-order. Tasks like that are not in |runnable_tasks_|; they wait in
+  // |pending_sequences_| until the task running their sequence completes.
   GetWorkStatus status = GET_WORK_NOT_FOUND;
-  int unrunnable_tasks = 0;
-  PendingTaskSet::iterator i = pending_tasks_.begin();
   // We assume that the loop below doesn't take too long and so we can just do
   // a single call to TimeTicks::Now().
   const TimeTicks current_time = TimeTicks::Now();
-  while (i != pending_tasks_.end()) {
-    if (!IsSequenceTokenRunnable(i->sequence_token_id)) {
-      unrunnable_tasks++;
-      ++i;
-      continue;
-    }
+  while (!runnable_tasks_.empty()) {
+    PendingTaskSet::iterator i = runnable_tasks_.begin();
+    int sequence_token_id = i->sequence_token_id;
 
     if (shutdown_called_ && i->shutdown_behavior != BLOCK_SHUTDOWN) {
       // We're shutting down and the task we just found isn't blocking
@@ -1006,7 +1023,8 @@ SequencedWorkerPool::Inner::GetWorkStatus SequencedWorkerPool::Inner::GetWork(
       // vector they passed to us once the lock is exited to make this
       // happen.
       delete_these_outside_lock->push_back(i->task);
-      pending_tasks_.erase(i++);
+      LockedRemoveRunnableTask(i);
+      LockedUpdateRunnableSequenceTask(sequence_token_id);
       continue;
     }
 
@@ -1017,14 +1035,16 @@ SequencedWorkerPool::Inner::GetWorkStatus SequencedWorkerPool::Inner::GetWork(
       if (cleanup_state_ == CLEANUP_RUNNING) {
         // Deferred tasks are deleted when cleaning up, see Inner::ThreadLoop.
         delete_these_outside_lock->push_back(i->task);
-        pending_tasks_.erase(i);
+        LockedRemoveRunnableTask(i);
+        LockedUpdateRunnableSequenceTask(sequence_token_id);
       }
       break;
     }
 
-    // Found a runnable task.
+    // Found a runnable task. The next task in its sequence becomes runnable
+    // once this one has run, see DidRunWorkerTask.
     *task = *i;
-    pending_tasks_.erase(i);
+    LockedRemoveRunnableTask(i);
     if (task->shutdown_behavior == BLOCK_SHUTDOWN) {
       blocking_shutdown_pending_task_count_--;
     }
@@ -1075,8 +1095,10 @@ void SequencedWorkerPool::Inner::DidRunWorkerTask(const SequencedTask& task) {
     blocking_shutdown_thread_count_--;
   }
 
-  if (task.sequence_token_id)
+  if (task.sequence_token_id) {
     current_sequences_.erase(task.sequence_token_id);
+    LockedUpdateRunnableSequenceTask(task.sequence_token_id);
+  }
 }
 
 bool SequencedWorkerPool::Inner::IsSequenceTokenRunnable(
@@ -1087,6 +1109,62 @@ bool SequencedWorkerPool::Inner::IsSequenceTokenRunnable(
           current_sequences_.end();
 }
 
+void SequencedWorkerPool::Inner::LockedAddPendingTask(
+    const SequencedTask& task) {
+  lock_.AssertAcquired();
+  if (!task.sequence_token_id) {
+    runnable_tasks_.insert(task);
+    return;
+  }
+  pending_sequences_[task.sequence_token_id].waiting_tasks.insert(task);
+  LockedUpdateRunnableSequenceTask(task.sequence_token_id);
+}
+
+void SequencedWorkerPool::Inner::LockedRemoveRunnableTask(
+    PendingTaskSet::iterator task) {
+  lock_.AssertAcquired();
+  int sequence_token_id = task->sequence_token_id;
+  runnable_tasks_.erase(task);
+  if (!sequence_token_id)
+    return;
+
+  PendingSequenceMap::iterator found =
+      pending_sequences_.find(sequence_token_id);
+  DCHECK(found != pending_sequences_.end());
+  DCHECK(found->second.has_runnable_task);
+  found->second.has_runnable_task = false;
+  if (found->second.waiting_tasks.empty())
+    pending_sequences_.erase(found);
+}
+
+void SequencedWorkerPool::Inner::LockedUpdateRunnableSequenceTask(
+    int sequence_token_id) {
+  lock_.AssertAcquired();
+  DCHECK(sequence_token_id);
+  if (!IsSequenceTokenRunnable(sequence_token_id))
+    return;
+  PendingSequenceMap::iterator found =
+      pending_sequences_.find(sequence_token_id);
+  if (found == pending_sequences_.end() ||
+      found->second.waiting_tasks.empty()) {
+    return;
+  }
+
+  PendingSequence* sequence = &found->second;
+  PendingTaskSet::iterator first_waiting = sequence->waiting_tasks.begin();
+  if (sequence->has_runnable_task) {
+    // A task posted later may still have to run first if the runnable one
+    // was posted with a delay.
+    if (!SequencedTaskLessThan()(*first_waiting, *sequence->runnable_task))
+      return;
+    sequence->waiting_tasks.insert(*sequence->runnable_task);
+    runnable_tasks_.erase(sequence->runnable_task);
+  }
+  sequence->runnable_task = runnable_tasks_.insert(*first_waiting).first;
+  sequence->has_runnable_task = true;
+  sequence->waiting_tasks.erase(first_waiting);
+}
+
 int SequencedWorkerPool::Inner::PrepareToStartAdditionalThreadIfHelpful() {
   lock_.AssertAcquired();
   // How thread creation works:
@@ -1124,13 +1202,10 @@ int SequencedWorkerPool::Inner::PrepareToStartAdditionalThreadIfHelpful() {
       threads_.size() < max_threads_ &&
       waiting_thread_count_ == 0) {
     // We could use an additional thread if there's work to be done.
-    for (PendingTaskSet::const_iterator i = pending_tasks_.begin();
-         i != pending_tasks_.end(); ++i) {
-      if (IsSequenceTokenRunnable(i->sequence_token_id)) {
-        // Found a runnable task, mark the thread as being started.
-        thread_being_created_ = true;
-        return static_cast<int>(threads_.size() + 1);
-      }
+    if (!runnable_tasks_.empty()) {
+      // Found a runnable task, mark the thread as being started.
+      thread_being_created_ = true;
+      return static_cast<int>(threads_.size() + 1);
     }
   }
   return 0;
@@ -0,0 +1,183 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/malloc_sampling_dump_provider.h"
+
+#include <stdint.h>
+
+#include "base/allocator/allocator_shim.h"
+#include "base/trace_event/memory_profiler_allocation_context.h"
+#include "base/trace_event/memory_profiler_heap_dump_writer.h"
+#include "base/trace_event/process_memory_dump.h"
+#include "base/trace_event/trace_event_argument.h"
+#include "base/trace_event/trace_event_memory_overhead.h"
+
+namespace base {
+namespace trace_event {
+
+// static
+const size_t MallocSamplingDumpProvider::kSamplingIntervalBytes = 128 * 1024;
+
+namespace {
+
+// The number of buckets of |sample_counts_|, 2^16.
+const int kSampleCountBits = 16;
+const size_t kNumSampleCounts = 1 << kSampleCountBits;
+
+// Per-thread state of the sampler. These are plain thread-locals rather than
+// ThreadLocalStorage slots because the latter allocate on first use in a
+// thread, which would recurse into the hooks.
+
+// The bytes allocated by the thread since the end of the last interval.
+__thread size_t g_bytes_since_sample = 0;
+
+// Set while the thread is in the profiler, so that the allocations the
+// profiler makes itself are not sampled. Besides avoiding the recursion, this
+// keeps a thread that holds |lock_| from taking it again.
+__thread bool g_in_profiler = false;
+
+// The sample that the last free on the thread removed, so that it can be put
+// back if the block was passed to a realloc() that failed. Its address is null
+// if the last free did not remove a sample.
+__thread AllocationRegister::Allocation g_last_removed_sample;
+
+class AutoProfilerScope {
+ public:
+  AutoProfilerScope() { g_in_profiler = true; }
+  ~AutoProfilerScope() { g_in_profiler = false; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(AutoProfilerScope);
+};
+
+size_t SampleCountIndex(void* address) {
+  // Allocations are at least 8 byte aligned, and large ones are page aligned,
+  // so the address is hashed rather than masked.
+  uint32_t bits = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(address));
+  return (bits * 2654435761u) >> (32 - kSampleCountBits);
+}
+
+}  // namespace
+
+// static
+MallocSamplingDumpProvider* MallocSamplingDumpProvider::GetInstance() {
+  return Singleton<MallocSamplingDumpProvider,
+                   LeakySingletonTraits<MallocSamplingDumpProvider>>::get();
+}
+
+MallocSamplingDumpProvider::MallocSamplingDumpProvider()
+    : heap_profiling_enabled_(false) {}
+
+MallocSamplingDumpProvider::~MallocSamplingDumpProvider() {}
+
+bool MallocSamplingDumpProvider::OnMemoryDump(const MemoryDumpArgs& args,
+                                              ProcessMemoryDump* pmd) {
+  if (args.level_of_detail != MemoryDumpLevelOfDetail::DETAILED)
+    return true;
+
+  scoped_refptr<TracedValue> heap_dump;
+  TraceEventMemoryOverhead overhead;
+  {
+    // The writer allocates while |lock_| is held.
+    AutoProfilerScope profiler_scope;
+    AutoLock lock(lock_);
+    if (!heap_profiling_enabled_)
+      return true;
+
+    HeapDumpWriter writer(pmd->session_state()->stack_frame_deduplicator());
+    for (const auto& allocation : *allocation_register_)
+      writer.InsertAllocation(allocation.context, allocation.size);
+    allocation_register_->EstimateTraceMemoryOverhead(&overhead);
+    heap_dump = writer.WriteHeapDump();
+  }
+
+  pmd->AddHeapDump("malloc", heap_dump);
+  overhead.DumpInto("tracing/heap_profiler_malloc", pmd);
+  return true;
+}
+
+void MallocSamplingDumpProvider::OnHeapProfilingEnabled(bool enabled) {
+  bool has_samples;
+  {
+    AutoLock lock(lock_);
+    if (enabled && !allocation_register_) {
+      allocation_register_.reset(new AllocationRegister);
+      sample_counts_.reset(new subtle::Atomic32[kNumSampleCounts]());
+    }
+    heap_profiling_enabled_ = enabled;
+    has_samples = !!allocation_register_;
+  }
+
+  // When profiling is disabled, the samples are still removed as they are
+  // freed, so that they are accurate if it is enabled again.
+  if (enabled)
+    allocator::SetAllocationHooks(&OnAllocation, &OnFree, &OnReallocFailed);
+  else if (has_samples)
+    allocator::SetAllocationHooks(nullptr, &OnFree, &OnReallocFailed);
+}
+
+// static
+void MallocSamplingDumpProvider::OnAllocation(void* address, size_t size) {
+  size_t bytes = g_bytes_since_sample + size;
+  if (bytes < kSamplingIntervalBytes) {
+    g_bytes_since_sample = bytes;
+    return;
+  }
+
+  // Attribute all the intervals that this allocation completes to it.
+  g_bytes_since_sample = bytes % kSamplingIntervalBytes;
+  if (g_in_profiler)
+    return;
+  AutoProfilerScope profiler_scope;
+  // This allocates the first time it is called on a thread.
+  AllocationContext context = AllocationContextTracker::GetContextSnapshot();
+  GetInstance()->InsertSample(address, bytes - g_bytes_since_sample, context);
+}
+
+// static
+void MallocSamplingDumpProvider::OnFree(void* address) {
+  g_last_removed_sample.address = nullptr;
+  MallocSamplingDumpProvider* self = GetInstance();
+  if (!subtle::NoBarrier_Load(&self->sample_counts_[SampleCountIndex(address)]))
+    return;
+  if (g_in_profiler)
+    return;
+  AutoProfilerScope profiler_scope;
+  self->RemoveSample(address, &g_last_removed_sample);
+}
+
+// static
+void MallocSamplingDumpProvider::OnReallocFailed(void* address) {
+  if (g_last_removed_sample.address != address)
+    return;
+  g_last_removed_sample.address = nullptr;
+  AutoProfilerScope profiler_scope;
+  GetInstance()->InsertSample(address, g_last_removed_sample.size,
+                              g_last_removed_sample.context);
+}
+
+void MallocSamplingDumpProvider::InsertSample(
+    void* address,
+    size_t size,
+    const AllocationContext& context) {
+  AutoLock lock(lock_);
+  if (!allocation_register_->Remove(address)) {
+    subtle::NoBarrier_AtomicIncrement(
+        &sample_counts_[SampleCountIndex(address)], 1);
+  }
+  allocation_register_->Insert(address, size, context);
+}
+
+void MallocSamplingDumpProvider::RemoveSample(
+    void* address,
+    AllocationRegister::Allocation* removed_sample) {
+  AutoLock lock(lock_);
+  if (allocation_register_->Remove(address, removed_sample)) {
+    subtle::NoBarrier_AtomicIncrement(
+        &sample_counts_[SampleCountIndex(address)], -1);
+  }
+}
+
+}  // namespace trace_event
+}  // namespace base
@@ -0,0 +1,79 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TRACE_EVENT_MALLOC_SAMPLING_DUMP_PROVIDER_H_
+#define BASE_TRACE_EVENT_MALLOC_SAMPLING_DUMP_PROVIDER_H_
+
+#include "base/atomicops.h"
+#include "base/macros.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/singleton.h"
+#include "base/synchronization/lock.h"
+#include "base/trace_event/memory_dump_provider.h"
+#include "base/trace_event/memory_profiler_allocation_register.h"
+
+namespace base {
+namespace trace_event {
+
+// Heap profiler for the allocations that go through the allocator shim (see
+// base/allocator/allocator_shim.h). While heap profiling is enabled, it
+// records a sample of the allocations in an AllocationRegister together with
+// the pseudo stack of the allocating thread, and detailed memory dumps
+// contain the samples that have not been freed as the "malloc" heap dump.
+//
+// Allocations are sampled by byte interval: every thread counts the bytes it
+// allocates, and the allocation that completes one or more intervals of
+// kSamplingIntervalBytes is recorded with the size of those intervals, so
+// the sizes in the heap dump add up to the allocated bytes. Allocations that
+// are not sampled only cost the thread-local counter, and frees only look
+// at a table of counters indexed by address unless the address might have
+// been sampled, so that the profiler can be left enabled.
+class BASE_EXPORT MallocSamplingDumpProvider : public MemoryDumpProvider {
+ public:
+  // The number of bytes a thread allocates per sample, on average.
+  static const size_t kSamplingIntervalBytes;
+
+  static MallocSamplingDumpProvider* GetInstance();
+
+  // MemoryDumpProvider implementation.
+  bool OnMemoryDump(const MemoryDumpArgs& args,
+                    ProcessMemoryDump* pmd) override;
+  void OnHeapProfilingEnabled(bool enabled) override;
+
+ private:
+  friend struct DefaultSingletonTraits<MallocSamplingDumpProvider>;
+
+  MallocSamplingDumpProvider();
+  ~MallocSamplingDumpProvider() override;
+
+  // The hooks installed in the allocator shim.
+  static void OnAllocation(void* address, size_t size);
+  static void OnFree(void* address);
+  static void OnReallocFailed(void* address);
+
+  void InsertSample(void* address,
+                    size_t size,
+                    const AllocationContext& context);
+  // Copies the removed sample to |removed_sample|, if there was one.
+  void RemoveSample(void* address,
+                    AllocationRegister::Allocation* removed_sample);
+
+  // Protects |allocation_register_| and |heap_profiling_enabled_|.
+  Lock lock_;
+
+  scoped_ptr<AllocationRegister> allocation_register_;
+  bool heap_profiling_enabled_;
+
+  // The number of samples in |allocation_register_| per bucket of addresses.
+  // Only modified with |lock_| held, but read without it to tell whether a
+  // freed address can have been sampled.
+  scoped_ptr<subtle::Atomic32[]> sample_counts_;
+
+  DISALLOW_COPY_AND_ASSIGN(MallocSamplingDumpProvider);
+};
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // BASE_TRACE_EVENT_MALLOC_SAMPLING_DUMP_PROVIDER_H_
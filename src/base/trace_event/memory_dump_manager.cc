@@ -36,6 +36,10 @@
 #include "base/trace_event/winheap_dump_provider_win.h"
 #endif
 
+#if defined(USE_EXPERIMENTAL_ALLOCATOR_SHIM)
+#include "base/trace_event/malloc_sampling_dump_provider.h"
+#endif
+
 namespace base {
 namespace trace_event {
 
@@ -173,6 +177,11 @@ void MemoryDumpManager::Initialize(MemoryDumpManagerDelegate* delegate,
   RegisterDumpProvider(WinHeapDumpProvider::GetInstance(), "WinHeap", nullptr);
 #endif
 
+#if defined(USE_EXPERIMENTAL_ALLOCATOR_SHIM)
+  RegisterDumpProvider(MallocSamplingDumpProvider::GetInstance(),
+                       "MallocSampling", nullptr);
+#endif
+
   // If tracing was enabled before initializing MemoryDumpManager, we missed the
   // OnTraceLogEnabled() event. Synthetize it so we can late-join the party.
   bool is_tracing_already_enabled = TraceLog::GetInstance()->IsEnabled();
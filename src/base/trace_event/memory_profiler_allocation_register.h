@@ -67,9 +67,13 @@ class BASE_EXPORT AllocationRegister {
   // the hash table.)
   void Insert(void* address, size_t size, AllocationContext context);
 
-  // Removes the address from the table if it is present. It is ok to call this
-  // with a null pointer.
-  void Remove(void* address);
+  // Removes the address from the table if it is present, and returns whether
+  // it was. It is ok to call this with a null pointer.
+  bool Remove(void* address);
+
+  // Like Remove(), but also copies the details of the removed allocation to
+  // |allocation| if the address was present.
+  bool Remove(void* address, Allocation* allocation);
 
   ConstIterator begin() const;
   ConstIterator end() const;
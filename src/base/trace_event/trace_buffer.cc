@@ -4,14 +4,65 @@
 
 #include "base/trace_event/trace_buffer.h"
 
+#include <map>
+#include <queue>
+
 #include "base/memory/scoped_vector.h"
+#include "base/stl_util.h"
 #include "base/trace_event/trace_event_impl.h"
+#include "base/trace_event/trace_file.h"
 
 namespace base {
 namespace trace_event {
 
 namespace {
 
+// A copy of the chunks of another buffer, which is only used to iterate over
+// them, e.g. by TraceLog::FlushButLeaveBufferIntact().
+class ClonedTraceBuffer : public TraceBuffer {
+ public:
+  ClonedTraceBuffer() : current_iteration_index_(0) {}
+
+  // The only implemented method.
+  const TraceBufferChunk* NextChunk() override {
+    return current_iteration_index_ < chunks_.size()
+               ? chunks_[current_iteration_index_++]
+               : NULL;
+  }
+
+  scoped_ptr<TraceBufferChunk> GetChunk(size_t* index) override {
+    NOTIMPLEMENTED();
+    return scoped_ptr<TraceBufferChunk>();
+  }
+  void ReturnChunk(size_t index, scoped_ptr<TraceBufferChunk>) override {
+    NOTIMPLEMENTED();
+  }
+  bool IsFull() const override { return false; }
+  size_t Size() const override { return 0; }
+  size_t Capacity() const override { return 0; }
+  TraceEvent* GetEventByHandle(TraceEventHandle handle) override {
+    return NULL;
+  }
+  scoped_ptr<TraceBuffer> CloneForIteration() const override {
+    NOTIMPLEMENTED();
+    return scoped_ptr<TraceBuffer>();
+  }
+  void EstimateTraceMemoryOverhead(
+      TraceEventMemoryOverhead* overhead) override {
+    NOTIMPLEMENTED();
+  }
+
+  void AddChunk(scoped_ptr<TraceBufferChunk> chunk) {
+    chunks_.push_back(chunk.Pass());
+  }
+
+ private:
+  size_t current_iteration_index_;
+  ScopedVector<TraceBufferChunk> chunks_;
+
+  DISALLOW_COPY_AND_ASSIGN(ClonedTraceBuffer);
+};
+
 class TraceBufferRingBuffer : public TraceBuffer {
  public:
   TraceBufferRingBuffer(size_t max_chunks)
@@ -103,7 +154,8 @@ class TraceBufferRingBuffer : public TraceBuffer {
       if (chunk_index >= chunks_.size())  // Skip uninitialized chunks.
         continue;
       TraceBufferChunk* chunk = chunks_[chunk_index];
-      cloned_buffer->chunks_.push_back(chunk ? chunk->Clone().release() : NULL);
+      cloned_buffer->AddChunk(chunk ? chunk->Clone()
+                                    : scoped_ptr<TraceBufferChunk>());
     }
     return cloned_buffer.Pass();
   }
@@ -121,43 +173,6 @@ class TraceBufferRingBuffer : public TraceBuffer {
   }
 
  private:
-  class ClonedTraceBuffer : public TraceBuffer {
-   public:
-    ClonedTraceBuffer() : current_iteration_index_(0) {}
-
-    // The only implemented method.
-    const TraceBufferChunk* NextChunk() override {
-      return current_iteration_index_ < chunks_.size()
-                 ? chunks_[current_iteration_index_++]
-                 : NULL;
-    }
-
-    scoped_ptr<TraceBufferChunk> GetChunk(size_t* index) override {
-      NOTIMPLEMENTED();
-      return scoped_ptr<TraceBufferChunk>();
-    }
-    void ReturnChunk(size_t index, scoped_ptr<TraceBufferChunk>) override {
-      NOTIMPLEMENTED();
-    }
-    bool IsFull() const override { return false; }
-    size_t Size() const override { return 0; }
-    size_t Capacity() const override { return 0; }
-    TraceEvent* GetEventByHandle(TraceEventHandle handle) override {
-      return NULL;
-    }
-    scoped_ptr<TraceBuffer> CloneForIteration() const override {
-      NOTIMPLEMENTED();
-      return scoped_ptr<TraceBuffer>();
-    }
-    void EstimateTraceMemoryOverhead(
-        TraceEventMemoryOverhead* overhead) override {
-      NOTIMPLEMENTED();
-    }
-
-    size_t current_iteration_index_;
-    ScopedVector<TraceBufferChunk> chunks_;
-  };
-
   bool QueueIsEmpty() const { return queue_head_ == queue_tail_; }
 
   size_t QueueSize() const {
@@ -284,6 +299,139 @@ class TraceBufferVector : public TraceBuffer {
   DISALLOW_COPY_AND_ASSIGN(TraceBufferVector);
 };
 
+class TraceBufferStreamingToFile : public TraceBuffer {
+ public:
+  TraceBufferStreamingToFile(size_t max_retained_chunks, const FilePath& path)
+      : max_retained_chunks_(max_retained_chunks),
+        current_chunk_seq_(1),
+        writer_(new TraceFileWriter(path)) {}
+
+  ~TraceBufferStreamingToFile() override {
+    FinishWriting();
+    STLDeleteValues(&retained_chunks_);
+  }
+
+  scoped_ptr<TraceBufferChunk> GetChunk(size_t* index) override {
+    // Chunk indices wrap around like those of TraceBufferRingBuffer; the
+    // sequence number tells chunks with the same index apart.
+    *index = (current_chunk_seq_ - 1) % (TraceBufferChunk::kMaxChunkIndex + 1);
+    scoped_ptr<TraceBufferChunk> chunk(
+        new TraceBufferChunk(current_chunk_seq_++));
+    // Zero chunk_seq is not allowed.
+    if (!current_chunk_seq_)
+      current_chunk_seq_ = 1;
+    return chunk.Pass();
+  }
+
+  void ReturnChunk(size_t index, scoped_ptr<TraceBufferChunk> chunk) override {
+    DCHECK(chunk);
+    // Chunks that come back after the file was finished are lost.
+    if (!writer_)
+      return;
+    // Retained chunks are keyed by sequence number, because a thread can
+    // hold on to its chunk while the indices wrap around. Only a chunk that
+    // was held while the sequence numbers wrapped around can collide; it is
+    // written out right away.
+    uint32 seq = chunk->seq();
+    if (ContainsKey(retained_chunks_, seq)) {
+      writer_->WriteChunk(chunk.Pass());
+      return;
+    }
+    retained_chunks_[seq] = chunk.release();
+    retained_chunk_seqs_.push(seq);
+
+    // Keep the most recent chunks around, so that the durations of events in
+    // them can still be updated, and write out the older ones. Events whose
+    // chunk was written already are not updated any more, so a complete event
+    // that ends after that is written without its duration.
+    if (retained_chunk_seqs_.size() > max_retained_chunks_)
+      WriteOldestChunk();
+  }
+
+  bool IsFull() const override { return false; }
+
+  size_t Size() const override {
+    // This is approximate because not all of the chunks are full.
+    return retained_chunks_.size() * TraceBufferChunk::kTraceBufferChunkSize;
+  }
+
+  size_t Capacity() const override {
+    return max_retained_chunks_ * TraceBufferChunk::kTraceBufferChunkSize;
+  }
+
+  TraceEvent* GetEventByHandle(TraceEventHandle handle) override {
+    ChunkMap::iterator found = retained_chunks_.find(handle.chunk_seq);
+    if (found == retained_chunks_.end())
+      return NULL;
+    return found->second->GetEventAt(handle.event_index);
+  }
+
+  const TraceBufferChunk* NextChunk() override {
+    FinishWriting();
+    return NULL;
+  }
+
+  scoped_ptr<TraceBuffer> CloneForIteration() const override {
+    // TraceLog does not stream in monitoring mode, so this is only here to
+    // give a complete buffer. The chunks that were written out already are
+    // not read back.
+    scoped_ptr<ClonedTraceBuffer> cloned_buffer(new ClonedTraceBuffer());
+    std::queue<uint32> seqs = retained_chunk_seqs_;
+    for (; !seqs.empty(); seqs.pop()) {
+      ChunkMap::const_iterator it = retained_chunks_.find(seqs.front());
+      DCHECK(it != retained_chunks_.end());
+      cloned_buffer->AddChunk(it->second->Clone());
+    }
+    return cloned_buffer.Pass();
+  }
+
+  void EstimateTraceMemoryOverhead(
+      TraceEventMemoryOverhead* overhead) override {
+    overhead->Add("TraceBufferStreamingToFile", sizeof(*this));
+    for (ChunkMap::iterator it = retained_chunks_.begin();
+         it != retained_chunks_.end(); ++it) {
+      it->second->EstimateTraceMemoryOverhead(overhead);
+    }
+  }
+
+ private:
+  typedef std::map<uint32, TraceBufferChunk*> ChunkMap;
+
+  void WriteOldestChunk() {
+    ChunkMap::iterator oldest =
+        retained_chunks_.find(retained_chunk_seqs_.front());
+    retained_chunk_seqs_.pop();
+    DCHECK(oldest != retained_chunks_.end());
+    writer_->WriteChunk(make_scoped_ptr(oldest->second));
+    retained_chunks_.erase(oldest);
+  }
+
+  // Writes the retained chunks and waits for the file to be complete. This
+  // joins the writer thread, whose file operations may add trace events, so
+  // it must not be called while TraceLog's lock is held.
+  void FinishWriting() {
+    if (!writer_)
+      return;
+    while (!retained_chunk_seqs_.empty())
+      WriteOldestChunk();
+    writer_->Finish();
+    writer_.reset();
+  }
+
+  size_t max_retained_chunks_;
+  uint32 current_chunk_seq_;
+
+  // The chunks that have been returned but not written yet, by sequence
+  // number, and their sequence numbers in the order in which they were
+  // returned.
+  ChunkMap retained_chunks_;
+  std::queue<uint32> retained_chunk_seqs_;
+
+  scoped_ptr<TraceFileWriter> writer_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceBufferStreamingToFile);
+};
+
 }  // namespace
 
 TraceBufferChunk::TraceBufferChunk(uint32 seq) : next_free_(0), seq_(seq) {}
@@ -392,5 +540,11 @@ TraceBuffer* TraceBuffer::CreateTraceBufferVectorOfSize(size_t max_chunks) {
   return new TraceBufferVector(max_chunks);
 }
 
+TraceBuffer* TraceBuffer::CreateTraceBufferStreamingToFile(
+    size_t max_retained_chunks,
+    const FilePath& path) {
+  return new TraceBufferStreamingToFile(max_retained_chunks, path);
+}
+
 }  // namespace trace_event
 }  // namespace base
@@ -6,6 +6,7 @@
 #define BASE_TRACE_EVENT_TRACE_BUFFER_H_
 
 #include "base/base_export.h"
+#include "base/files/file_path.h"
 #include "base/trace_event/trace_event.h"
 #include "base/trace_event/trace_event_impl.h"
 
@@ -79,6 +80,17 @@ class BASE_EXPORT TraceBuffer {
 
   static TraceBuffer* CreateTraceBufferRingBuffer(size_t max_chunks);
   static TraceBuffer* CreateTraceBufferVectorOfSize(size_t max_chunks);
+
+  // Creates a buffer that streams its chunks to |path| in the format of
+  // TraceFileWriter once more than |max_retained_chunks| have been returned,
+  // so that it never fills up. Events in chunks that were written already
+  // can't be looked up by handle any more. Iterating the buffer, and deleting
+  // it, writes the remaining chunks and joins the writer thread, so neither
+  // may happen while TraceLog's lock is held. Iterating returns no chunks;
+  // ConvertTraceFileToJSON() reads them back.
+  static TraceBuffer* CreateTraceBufferStreamingToFile(
+      size_t max_retained_chunks,
+      const FilePath& path);
 };
 
 // TraceResultBuffer collects and converts trace fragments returned by TraceLog
@@ -6,6 +6,7 @@
 
 #include "base/format_macros.h"
 #include "base/json/string_escape.h"
+#include "base/pickle.h"
 #include "base/process/process_handle.h"
 #include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
@@ -35,6 +36,22 @@ void CopyTraceEventParameter(char** buffer,
   }
 }
 
+// An argument that was already converted to the trace format, e.g. when it was
+// written to a file.
+class TraceFormatString : public ConvertableToTraceFormat {
+ public:
+  explicit TraceFormatString(const std::string& value) : value_(value) {}
+
+  void AppendAsTraceFormat(std::string* out) const override { *out += value_; }
+
+ private:
+  ~TraceFormatString() override {}
+
+  const std::string value_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceFormatString);
+};
+
 }  // namespace
 
 TraceEvent::TraceEvent()
@@ -273,6 +290,16 @@ void TraceEvent::AppendValueAsJSON(unsigned char type,
 void TraceEvent::AppendAsJSON(
     std::string* out,
     const ArgumentFilterPredicate& argument_filter_predicate) const {
+  AppendAsJSON(out, argument_filter_predicate,
+               TraceLog::GetInstance()->process_id(),
+               TraceLog::GetCategoryGroupName(category_group_enabled_));
+}
+
+void TraceEvent::AppendAsJSON(
+    std::string* out,
+    const ArgumentFilterPredicate& argument_filter_predicate,
+    int default_process_id,
+    const char* category_group_name) const {
   int64 time_int64 = timestamp_.ToInternalValue();
   int process_id;
   int thread_id;
@@ -281,11 +308,9 @@ void TraceEvent::AppendAsJSON(
     process_id = process_id_;
     thread_id = -1;
   } else {
-    process_id = TraceLog::GetInstance()->process_id();
+    process_id = default_process_id;
     thread_id = thread_id_;
   }
-  const char* category_group_name =
-      TraceLog::GetCategoryGroupName(category_group_enabled_);
 
   // Category group checked at category creation time.
   DCHECK(!strchr(name_, '"'));
@@ -421,5 +446,126 @@ void TraceEvent::AppendPrettyPrinted(std::ostringstream* out) const {
   }
 }
 
+void TraceEvent::WriteToPickle(Pickle* pickle) const {
+  pickle->WriteInt64(timestamp_.ToInternalValue());
+  pickle->WriteInt64(thread_timestamp_.ToInternalValue());
+  pickle->WriteInt64(duration_.ToInternalValue());
+  pickle->WriteInt64(thread_duration_.ToInternalValue());
+  pickle->WriteUInt64(id_);
+  pickle->WriteUInt64(context_id_);
+  pickle->WriteUInt64(bind_id_);
+  // Either the thread or the process ID, see |flags_|.
+  pickle->WriteInt(thread_id_);
+  pickle->WriteUInt32(flags_);
+  pickle->WriteInt(phase_);
+  pickle->WriteString(TraceLog::GetCategoryGroupName(category_group_enabled_));
+  pickle->WriteString(name_);
+
+  int num_args = 0;
+  while (num_args < kTraceMaxNumArgs && arg_names_[num_args])
+    ++num_args;
+  pickle->WriteInt(num_args);
+  for (int i = 0; i < num_args; ++i) {
+    pickle->WriteString(arg_names_[i]);
+    pickle->WriteInt(arg_types_[i]);
+    switch (arg_types_[i]) {
+      case TRACE_VALUE_TYPE_STRING:
+      case TRACE_VALUE_TYPE_COPY_STRING:
+        pickle->WriteBool(arg_values_[i].as_string != NULL);
+        if (arg_values_[i].as_string)
+          pickle->WriteString(arg_values_[i].as_string);
+        break;
+      case TRACE_VALUE_TYPE_CONVERTABLE:
+        pickle->WriteString(convertable_values_[i]->ToString());
+        break;
+      default:
+        pickle->WriteUInt64(arg_values_[i].as_uint);
+        break;
+    }
+  }
+}
+
+bool TraceEvent::InitializeFromPickle(PickleIterator* iter,
+                                      std::string* category_group_name) {
+  int64 timestamp;
+  int64 thread_timestamp;
+  int64 duration;
+  int64 thread_duration;
+  uint64 id;
+  uint64 context_id;
+  uint64 bind_id;
+  int thread_id;
+  uint32 flags;
+  int phase;
+  std::string name;
+  int num_args;
+  if (!iter->ReadInt64(&timestamp) || !iter->ReadInt64(&thread_timestamp) ||
+      !iter->ReadInt64(&duration) || !iter->ReadInt64(&thread_duration) ||
+      !iter->ReadUInt64(&id) || !iter->ReadUInt64(&context_id) ||
+      !iter->ReadUInt64(&bind_id) || !iter->ReadInt(&thread_id) ||
+      !iter->ReadUInt32(&flags) || !iter->ReadInt(&phase) ||
+      !iter->ReadString(category_group_name) || !iter->ReadString(&name) ||
+      !iter->ReadInt(&num_args)) {
+    return false;
+  }
+  if (num_args < 0 || num_args > kTraceMaxNumArgs)
+    return false;
+
+  std::string arg_names[kTraceMaxNumArgs];
+  const char* arg_name_pointers[kTraceMaxNumArgs];
+  unsigned char arg_types[kTraceMaxNumArgs];
+  unsigned long long arg_values[kTraceMaxNumArgs];
+  std::string string_values[kTraceMaxNumArgs];
+  scoped_refptr<ConvertableToTraceFormat> convertable_values[kTraceMaxNumArgs];
+  for (int i = 0; i < num_args; ++i) {
+    int arg_type;
+    if (!iter->ReadString(&arg_names[i]) || !iter->ReadInt(&arg_type))
+      return false;
+    arg_name_pointers[i] = arg_names[i].c_str();
+    arg_types[i] = static_cast<unsigned char>(arg_type);
+    arg_values[i] = 0;
+    switch (arg_type) {
+      case TRACE_VALUE_TYPE_STRING:
+      case TRACE_VALUE_TYPE_COPY_STRING: {
+        bool has_value;
+        if (!iter->ReadBool(&has_value) ||
+            (has_value && !iter->ReadString(&string_values[i]))) {
+          return false;
+        }
+        TraceValue value;
+        value.as_uint = 0;
+        value.as_string = has_value ? string_values[i].c_str() : NULL;
+        arg_values[i] = value.as_uint;
+        arg_types[i] = TRACE_VALUE_TYPE_COPY_STRING;
+        break;
+      }
+      case TRACE_VALUE_TYPE_CONVERTABLE:
+        if (!iter->ReadString(&string_values[i]))
+          return false;
+        convertable_values[i] = new TraceFormatString(string_values[i]);
+        break;
+      default: {
+        uint64 value;
+        if (!iter->ReadUInt64(&value))
+          return false;
+        arg_values[i] = value;
+        break;
+      }
+    }
+  }
+
+  // The names are only valid during this call, so have them copied. The
+  // category group is not one of this process's, so it is left out.
+  Initialize(thread_id, TimeTicks::FromInternalValue(timestamp),
+             ThreadTicks::FromInternalValue(thread_timestamp),
+             static_cast<char>(phase), NULL, name.c_str(), id, context_id,
+             bind_id, num_args,
+             arg_name_pointers, arg_types, arg_values, convertable_values,
+             flags | TRACE_EVENT_FLAG_COPY);
+  duration_ = TimeDelta::FromInternalValue(duration);
+  thread_duration_ = TimeDelta::FromInternalValue(thread_duration);
+  return true;
+}
+
 }  // namespace trace_event
 }  // namespace base
@@ -26,6 +26,8 @@
 
 namespace base {
 
+class Pickle;
+class PickleIterator;
 class WaitableEvent;
 class MessageLoop;
 
@@ -120,8 +122,24 @@ class BASE_EXPORT TraceEvent {
   void AppendAsJSON(
       std::string* out,
       const ArgumentFilterPredicate& argument_filter_predicate) const;
+  // As above, for events that were not recorded by this process, such as
+  // those read back by InitializeFromPickle(). |default_process_id| is used
+  // for events that do not carry their own process ID.
+  void AppendAsJSON(std::string* out,
+                    const ArgumentFilterPredicate& argument_filter_predicate,
+                    int default_process_id,
+                    const char* category_group_name) const;
   void AppendPrettyPrinted(std::ostringstream* out) const;
 
+  // Serialize event data to a compact binary form, which is read back by
+  // InitializeFromPickle(). Convertable arguments are stored in their trace
+  // format, and all strings are copied. The category group of a read event is
+  // not registered with TraceLog; its name is returned in
+  // |category_group_name| instead, and category_group_enabled() is NULL.
+  void WriteToPickle(Pickle* pickle) const;
+  bool InitializeFromPickle(PickleIterator* iter,
+                            std::string* category_group_name);
+
   static void AppendValueAsJSON(unsigned char type,
                                 TraceValue value,
                                 std::string* out);
@@ -0,0 +1,200 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_file.h"
+
+#include "base/logging.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/pickle.h"
+#include "base/stl_util.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/trace_event/trace_buffer.h"
+#include "base/trace_event/trace_event_impl.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+// Identifies the format of the file in its header record.
+const char kTraceFileMagic[] = "Chrome binary trace";
+const int kTraceFileVersion = 1;
+
+// The most chunks that may wait to be written before new ones are dropped.
+const size_t kMaxPendingChunks = 1024;
+
+// Records larger than this are not read back.
+const uint32 kMaxRecordSize = 64 * 1024 * 1024;
+
+// The size of the JSON fragments passed to the output callback, as in
+// TraceLog::ConvertTraceEventsToTraceFormat().
+const size_t kJSONFragmentSizeInBytes = 100 * 1024;
+
+// Reads the next record of |file| into |*data|. Returns false at the end of
+// the file or if the record is malformed, setting |*at_end| accordingly.
+bool ReadRecord(File* file, std::string* data, bool* at_end) {
+  uint32 size;
+  int bytes_read =
+      file->ReadAtCurrentPos(reinterpret_cast<char*>(&size), sizeof(size));
+  *at_end = bytes_read == 0;
+  if (bytes_read != sizeof(size) || size > kMaxRecordSize)
+    return false;
+  data->resize(size);
+  return size == 0 ||
+         file->ReadAtCurrentPos(string_as_array(data), size) ==
+             static_cast<int>(size);
+}
+
+}  // namespace
+
+TraceFileWriter::TraceFileWriter(const FilePath& path)
+    : SimpleThread("TraceFileWriter"),
+      path_(path),
+      has_work_cv_(&lock_),
+      finishing_(false),
+      dropped_chunk_count_(0) {
+  Start();
+}
+
+TraceFileWriter::~TraceFileWriter() {
+  DCHECK(HasBeenJoined());
+}
+
+void TraceFileWriter::WriteChunk(scoped_ptr<TraceBufferChunk> chunk) {
+  AutoLock lock(lock_);
+  DCHECK(!finishing_);
+  if (pending_chunks_.size() >= kMaxPendingChunks) {
+    ++dropped_chunk_count_;
+    return;
+  }
+  pending_chunks_.push_back(chunk.Pass());
+  has_work_cv_.Signal();
+}
+
+void TraceFileWriter::Finish() {
+  {
+    AutoLock lock(lock_);
+    DCHECK(!finishing_);
+    finishing_ = true;
+    has_work_cv_.Signal();
+  }
+
+  // The trace is not complete before the writer is done, so wait for it even
+  // on threads that should not do IO.
+  ThreadRestrictions::ScopedAllowIO allow_io;
+  Join();
+  DLOG_IF(WARNING, dropped_chunk_count_)
+      << "Dropped " << dropped_chunk_count_ << " trace buffer chunks because "
+      << path_.value() << " could not be written fast enough";
+}
+
+void TraceFileWriter::Run() {
+  file_.Initialize(path_, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+  if (file_.IsValid()) {
+    Pickle header;
+    header.WriteString(kTraceFileMagic);
+    header.WriteInt(kTraceFileVersion);
+    header.WriteInt(TraceLog::GetInstance()->process_id());
+    if (!WriteRecord(header))
+      file_.Close();
+  }
+  DLOG_IF(ERROR, !file_.IsValid()) << "Failed to write " << path_.value();
+
+  for (;;) {
+    ScopedVector<TraceBufferChunk> chunks;
+    bool finishing;
+    {
+      AutoLock lock(lock_);
+      while (pending_chunks_.empty() && !finishing_)
+        has_work_cv_.Wait();
+      chunks.swap(pending_chunks_);
+      finishing = finishing_;
+    }
+
+    for (size_t i = 0; i < chunks.size() && file_.IsValid(); ++i) {
+      const TraceBufferChunk* chunk = chunks[i];
+      Pickle pickle;
+      pickle.WriteSizeT(chunk->size());
+      for (size_t j = 0; j < chunk->size(); ++j)
+        chunk->GetEventAt(j)->WriteToPickle(&pickle);
+      if (!WriteRecord(pickle)) {
+        DLOG(ERROR) << "Failed to write " << path_.value();
+        file_.Close();
+      }
+    }
+
+    if (finishing)
+      break;
+  }
+  file_.Close();
+}
+
+bool TraceFileWriter::WriteRecord(const Pickle& pickle) {
+  uint32 size = static_cast<uint32>(pickle.size());
+  return file_.WriteAtCurrentPos(reinterpret_cast<const char*>(&size),
+                                 sizeof(size)) == sizeof(size) &&
+         file_.WriteAtCurrentPos(static_cast<const char*>(pickle.data()),
+                                 size) == static_cast<int>(size);
+}
+
+bool ConvertTraceFileToJSON(const FilePath& path,
+                            const TraceLog::OutputCallback& output_callback) {
+  scoped_refptr<RefCountedString> json_events_str_ptr = new RefCountedString();
+  File file(path, File::FLAG_OPEN | File::FLAG_READ);
+  std::string record;
+  bool at_end = false;
+  // Events that do not carry their own process ID are written out with the
+  // one of the process that recorded the file.
+  int process_id = 0;
+  bool success = file.IsValid() && ReadRecord(&file, &record, &at_end);
+  if (success) {
+    Pickle header(record.data(), static_cast<int>(record.size()));
+    PickleIterator iter(header);
+    std::string magic;
+    int version;
+    success = iter.ReadString(&magic) && magic == kTraceFileMagic &&
+              iter.ReadInt(&version) && version == kTraceFileVersion &&
+              iter.ReadInt(&process_id);
+  }
+
+  while (success) {
+    if (!ReadRecord(&file, &record, &at_end)) {
+      success = at_end;
+      break;
+    }
+    Pickle pickle(record.data(), static_cast<int>(record.size()));
+    PickleIterator iter(pickle);
+    size_t num_events;
+    if (!iter.ReadSizeT(&num_events) ||
+        num_events > TraceBufferChunk::kTraceBufferChunkSize) {
+      success = false;
+      break;
+    }
+    for (size_t i = 0; i < num_events; ++i) {
+      TraceEvent event;
+      std::string category_group_name;
+      if (!event.InitializeFromPickle(&iter, &category_group_name)) {
+        success = false;
+        break;
+      }
+      size_t size = json_events_str_ptr->size();
+      if (size > kJSONFragmentSizeInBytes) {
+        output_callback.Run(json_events_str_ptr, true);
+        json_events_str_ptr = new RefCountedString();
+      } else if (size) {
+        json_events_str_ptr->data().append(",\n");
+      }
+      event.AppendAsJSON(&json_events_str_ptr->data(),
+                         ArgumentFilterPredicate(), process_id,
+                         category_group_name.c_str());
+    }
+  }
+
+  DLOG_IF(ERROR, !success) << "Failed to read " << path.value();
+  output_callback.Run(json_events_str_ptr, false);
+  return success;
+}
+
+}  // namespace trace_event
+}  // namespace base
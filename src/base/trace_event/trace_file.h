@@ -0,0 +1,82 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TRACE_EVENT_TRACE_FILE_H_
+#define BASE_TRACE_EVENT_TRACE_FILE_H_
+
+#include "base/base_export.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/simple_thread.h"
+#include "base/trace_event/trace_log.h"
+
+namespace base {
+
+class Pickle;
+
+namespace trace_event {
+
+class TraceBufferChunk;
+
+// Writes completed TraceBufferChunks to a file in a compact binary format on
+// a thread of its own, so that a recording session does not have to keep all
+// of its events in memory. The file consists of a header record followed by
+// one record per chunk; each record is a Pickle preceded by its size.
+//
+// The writer thread only waits on a condition variable and writes to the
+// file; it does not run a message loop, so handing chunks to it never posts
+// tasks, which would add trace events while TraceLog's lock is held.
+class BASE_EXPORT TraceFileWriter : public SimpleThread {
+ public:
+  // Starts the writer thread, which creates the file at |path|.
+  explicit TraceFileWriter(const FilePath& path);
+  ~TraceFileWriter() override;
+
+  // Queues |chunk| to be written. If the file cannot keep up and too many
+  // chunks are queued already, |chunk| is dropped instead.
+  void WriteChunk(scoped_ptr<TraceBufferChunk> chunk);
+
+  // Writes all queued chunks, closes the file and joins the writer thread.
+  void Finish();
+
+  // SimpleThread:
+  void Run() override;
+
+ private:
+  bool WriteRecord(const Pickle& pickle);
+
+  const FilePath path_;
+
+  // Only used on the writer thread.
+  File file_;
+
+  // Protects the members below.
+  Lock lock_;
+
+  // Signaled when chunks are queued or Finish() is called.
+  ConditionVariable has_work_cv_;
+
+  ScopedVector<TraceBufferChunk> pending_chunks_;
+  bool finishing_;
+  size_t dropped_chunk_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TraceFileWriter);
+};
+
+// Reads a file written by TraceFileWriter and converts its events to the JSON
+// format TraceLog::Flush() produces, passing it to |output_callback| in the
+// same kind of fragments. Returns false if the file cannot be read or is
+// malformed; |output_callback| is still run with |has_more_events| false.
+BASE_EXPORT bool ConvertTraceFileToJSON(
+    const FilePath& path,
+    const TraceLog::OutputCallback& output_callback);
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // BASE_TRACE_EVENT_TRACE_FILE_H_
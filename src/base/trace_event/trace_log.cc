@@ -79,6 +79,9 @@ const size_t kTraceEventRingBufferChunks = kTraceEventVectorBufferChunks / 4;
 const size_t kMonitorTraceEventBufferChunks = 30000 / kTraceBufferChunkSize;
 // ECHO_TO_CONSOLE needs a small buffer to hold the unfinished COMPLETE events.
 const size_t kEchoToConsoleTraceEventBufferChunks = 256;
+// The number of most recent chunks that a buffer streaming to a file keeps
+// in memory, so that the durations of their events can still be updated.
+const size_t kStreamingTraceEventRetainedChunks = 256;
 
 const size_t kTraceEventBufferSizeInBytes = 100 * 1024;
 const int kThreadFlushTimeoutMs = 3000;
@@ -586,6 +589,8 @@ void TraceLog::GetKnownCategoryGroups(
 
 void TraceLog::SetEnabled(const TraceConfig& trace_config, Mode mode) {
   std::vector<EnabledStateObserver*> observer_list;
+  // Deleted after |lock_| is released, see UseNextTraceBuffer().
+  scoped_ptr<TraceBuffer> previous_logged_events;
   {
     AutoLock lock(lock_);
 
@@ -620,9 +625,9 @@ void TraceLog::SetEnabled(const TraceConfig& trace_config, Mode mode) {
 
     mode_ = mode;
 
-    if (new_options != old_options) {
+    if (new_options != old_options || !streaming_output_file_.empty()) {
       subtle::NoBarrier_Store(&trace_options_, new_options);
-      UseNextTraceBuffer();
+      previous_logged_events = UseNextTraceBuffer();
     }
 
     num_traces_recorded_++;
@@ -694,6 +699,12 @@ TraceConfig TraceLog::GetCurrentTraceConfig() const {
   return trace_config_;
 }
 
+void TraceLog::SetStreamingOutputFile(const FilePath& path) {
+  AutoLock lock(lock_);
+  DCHECK(!IsEnabled());
+  streaming_output_file_ = path;
+}
+
 void TraceLog::SetDisabled() {
   AutoLock lock(lock_);
   SetDisabledWhileLocked();
@@ -958,8 +969,7 @@ void TraceLog::FinishFlush(int generation, bool discard_events) {
   {
     AutoLock lock(lock_);
 
-    previous_logged_events.swap(logged_events_);
-    UseNextTraceBuffer();
+    previous_logged_events = UseNextTraceBuffer();
     thread_message_loops_.clear();
 
     flush_task_runner_ = NULL;
@@ -1064,11 +1074,13 @@ void TraceLog::FlushButLeaveBufferIntact(
                                   argument_filter_predicate);
 }
 
-void TraceLog::UseNextTraceBuffer() {
+scoped_ptr<TraceBuffer> TraceLog::UseNextTraceBuffer() {
+  scoped_ptr<TraceBuffer> previous_logged_events = logged_events_.Pass();
   logged_events_.reset(CreateTraceBuffer());
   subtle::NoBarrier_AtomicIncrement(&generation_, 1);
   thread_shared_chunk_.reset();
   thread_shared_chunk_index_ = 0;
+  return previous_logged_events.Pass();
 }
 
 TraceEventHandle TraceLog::AddTraceEvent(
@@ -1695,6 +1707,21 @@ void TraceLog::SetCurrentThreadBlocksMessageLoop() {
 
 TraceBuffer* TraceLog::CreateTraceBuffer() {
   InternalTraceOptions options = trace_options();
+  if (!streaming_output_file_.empty()) {
+    FilePath path = streaming_output_file_;
+    streaming_output_file_.clear();
+    // Only a recording that keeps every event can be streamed: monitoring
+    // flushes a copy of the buffer while it keeps recording, and the other
+    // modes drop or don't keep events. Also, the file would contain the
+    // arguments that the filter is meant to keep out of the trace.
+    if (mode_ == RECORDING_MODE && (options & kInternalRecordUntilFull) &&
+        !(options & kInternalEnableArgumentFilter)) {
+      return TraceBuffer::CreateTraceBufferStreamingToFile(
+          kStreamingTraceEventRetainedChunks, path);
+    }
+    DLOG(WARNING) << "Not streaming a trace that doesn't record until full "
+                  << "or that uses argument filtering to " << path.value();
+  }
   if (options & kInternalRecordContinuously)
     return TraceBuffer::CreateTraceBufferRingBuffer(
         kTraceEventRingBufferChunks);
@@ -10,6 +10,7 @@
 
 #include "base/atomicops.h"
 #include "base/containers/hash_tables.h"
+#include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
@@ -80,6 +81,17 @@ class BASE_EXPORT TraceLog : public MemoryDumpProvider {
   // be merged into the current category filter.
   void SetEnabled(const TraceConfig& trace_config, Mode mode);
 
+  // Makes the next SetEnabled() that starts a recording stream the trace
+  // events to |path| as they are recorded, instead of keeping them in memory
+  // until Flush(). The metadata events are streamed along with the others, so
+  // Flush() then returns no events; they are read back with
+  // ConvertTraceFileToJSON() once Flush() is done. Only the most recent
+  // chunks are kept in memory, so a complete event that ends long after it
+  // began, when its chunk was written already, is written without its
+  // duration. Ignored unless the trace is recorded in RECORDING_MODE with
+  // RECORD_UNTIL_FULL and without argument filtering.
+  void SetStreamingOutputFile(const FilePath& path);
+
   // Disables normal tracing for all categories.
   void SetDisabled();
 
@@ -406,7 +418,9 @@ class BASE_EXPORT TraceLog : public MemoryDumpProvider {
   bool CheckGeneration(int generation) const {
     return generation == this->generation();
   }
-  void UseNextTraceBuffer();
+  // Returns the previous buffer, which must be deleted after |lock_| is
+  // released.
+  scoped_ptr<TraceBuffer> UseNextTraceBuffer();
 
   TimeTicks OffsetNow() const { return OffsetTimestamp(TimeTicks::Now()); }
   TimeTicks OffsetTimestamp(const TimeTicks& timestamp) const {
@@ -449,6 +463,9 @@ class BASE_EXPORT TraceLog : public MemoryDumpProvider {
 
   TimeTicks buffer_limit_reached_timestamp_;
 
+  // Consumed by the next CreateTraceBuffer().
+  FilePath streaming_output_file_;
+
   // XORed with TraceID to make it unlikely to collide with other processes.
   unsigned long long process_id_hash_;
 
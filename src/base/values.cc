@@ -383,16 +383,15 @@ bool DictionaryValue::GetAsDictionary(const DictionaryValue** out_value) const {
 
 bool DictionaryValue::HasKey(const std::string& key) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator current_entry = dictionary_.find(key);
-  DCHECK((current_entry == dictionary_.end()) || current_entry->second);
-  return current_entry != dictionary_.end();
+  Value* const* current_entry = dictionary_.Find(key);
+  DCHECK(!current_entry || *current_entry);
+  return current_entry != NULL;
 }
 
 void DictionaryValue::Clear() {
-  ValueMap::iterator dict_iterator = dictionary_.begin();
-  while (dict_iterator != dictionary_.end()) {
-    delete dict_iterator->second;
-    ++dict_iterator;
+  for (Storage::const_iterator it = dictionary_.begin();
+       it != dictionary_.end(); ++it) {
+    delete it.value();
   }
 
   dictionary_.clear();
@@ -453,12 +452,11 @@ void DictionaryValue::SetWithoutPathExpansion(const std::string& key,
   Value* bare_ptr = in_value.release();
   // If there's an existing value here, we need to delete it, because
   // we own all our children.
-  std::pair<ValueMap::iterator, bool> ins_res =
-      dictionary_.insert(std::make_pair(key, bare_ptr));
+  std::pair<Value**, bool> ins_res = dictionary_.Insert(key, bare_ptr);
   if (!ins_res.second) {
-    DCHECK_NE(ins_res.first->second, bare_ptr);  // This would be bogus
-    delete ins_res.first->second;
-    ins_res.first->second = bare_ptr;
+    DCHECK_NE(*ins_res.first, bare_ptr);  // This would be bogus
+    delete *ins_res.first;
+    *ins_res.first = bare_ptr;
   }
 }
 
@@ -643,13 +641,12 @@ bool DictionaryValue::GetList(const std::string& path, ListValue** out_value) {
 bool DictionaryValue::GetWithoutPathExpansion(const std::string& key,
                                               const Value** out_value) const {
   DCHECK(IsStringUTF8(key));
-  ValueMap::const_iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
+  Value* const* entry = dictionary_.Find(key);
+  if (!entry)
     return false;
 
-  const Value* entry = entry_iterator->second;
   if (out_value)
-    *out_value = entry;
+    *out_value = *entry;
   return true;
 }
 
@@ -772,16 +769,14 @@ bool DictionaryValue::Remove(const std::string& path,
 bool DictionaryValue::RemoveWithoutPathExpansion(const std::string& key,
                                                  scoped_ptr<Value>* out_value) {
   DCHECK(IsStringUTF8(key));
-  ValueMap::iterator entry_iterator = dictionary_.find(key);
-  if (entry_iterator == dictionary_.end())
+  Value* entry = NULL;
+  if (!dictionary_.Remove(key, &entry))
     return false;
 
-  Value* entry = entry_iterator->second;
   if (out_value)
     out_value->reset(entry);
   else
     delete entry;
-  dictionary_.erase(entry_iterator);
   return true;
 }
 
@@ -831,7 +826,7 @@ void DictionaryValue::MergeDictionary(const DictionaryValue* dictionary) {
 }
 
 void DictionaryValue::Swap(DictionaryValue* other) {
-  dictionary_.swap(other->dictionary_);
+  dictionary_.Swap(&other->dictionary_);
 }
 
 DictionaryValue::Iterator::Iterator(const DictionaryValue& target)
@@ -843,10 +838,11 @@ DictionaryValue::Iterator::~Iterator() {}
 DictionaryValue* DictionaryValue::DeepCopy() const {
   DictionaryValue* result = new DictionaryValue;
 
-  for (ValueMap::const_iterator current_entry(dictionary_.begin());
+  // The keys are visited in order, so each one is appended to |result|.
+  for (Storage::const_iterator current_entry(dictionary_.begin());
        current_entry != dictionary_.end(); ++current_entry) {
-    result->SetWithoutPathExpansion(current_entry->first,
-                                    current_entry->second->DeepCopy());
+    result->SetWithoutPathExpansion(current_entry.key(),
+                                    current_entry.value()->DeepCopy());
   }
 
   return result;
@@ -28,6 +28,7 @@
 #include "base/base_export.h"
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/containers/flat_sorted_map.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/strings/string16.h"
 #include "base/strings/string_piece.h"
@@ -208,6 +209,11 @@ class BASE_EXPORT BinaryValue: public Value {
 // parsing for recursive access; see the comment at the top of the file. Keys
 // are |std::string|s and should be UTF-8 encoded.
 class BASE_EXPORT DictionaryValue : public Value {
+ private:
+  // Most dictionaries are small, so the children are kept in a sorted vector
+  // until there are more than 32 of them.
+  typedef FlatSortedMap<std::string, Value*, 32> Storage;
+
  public:
   // Returns |value| if it is a dictionary, nullptr otherwise.
   static scoped_ptr<DictionaryValue> From(scoped_ptr<Value> value);
@@ -364,12 +370,12 @@ class BASE_EXPORT DictionaryValue : public Value {
     bool IsAtEnd() const { return it_ == target_.dictionary_.end(); }
     void Advance() { ++it_; }
 
-    const std::string& key() const { return it_->first; }
-    const Value& value() const { return *it_->second; }
+    const std::string& key() const { return it_.key(); }
+    const Value& value() const { return *it_.value(); }
 
    private:
     const DictionaryValue& target_;
-    ValueMap::const_iterator it_;
+    Storage::const_iterator it_;
   };
 
   // Overridden from Value:
@@ -379,7 +385,7 @@ class BASE_EXPORT DictionaryValue : public Value {
   bool Equals(const Value* other) const override;
 
  private:
-  ValueMap dictionary_;
+  Storage dictionary_;
 
   DISALLOW_COPY_AND_ASSIGN(DictionaryValue);
 };
@@ -354,6 +354,8 @@
         'playback/display_item.h',
         'playback/display_item_list.cc',
         'playback/display_item_list.h',
+        'playback/display_item_list_bounds_calculator.cc',
+        'playback/display_item_list_bounds_calculator.h',
         'playback/display_item_list_settings.cc',
         'playback/display_item_list_settings.h',
         'playback/display_item_proto_factory.cc',
@@ -362,6 +364,7 @@
         'playback/display_list_raster_source.h',
         'playback/display_list_recording_source.cc',
         'playback/display_list_recording_source.h',
+        'playback/draw_image.cc',
         'playback/draw_image.h',
         'playback/drawing_display_item.cc',
         'playback/drawing_display_item.h',
@@ -369,6 +372,8 @@
         'playback/filter_display_item.h',
         'playback/float_clip_display_item.cc',
         'playback/float_clip_display_item.h',
+        'playback/image_hijack_canvas.cc',
+        'playback/image_hijack_canvas.h',
         'playback/largest_display_item.cc',
         'playback/largest_display_item.h',
         'playback/transform_display_item.cc',
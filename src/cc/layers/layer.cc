@@ -1530,6 +1530,7 @@ void Layer::OnOpacityAnimated(float opacity) {
             effect_tree_index())) {
       if (node->owner_id == id()) {
         node->data.opacity = opacity;
+        node->data.opacity_changed = true;
         layer_tree_host_->property_trees()->effect_tree.set_needs_update(true);
       }
     }
@@ -1600,6 +1601,7 @@ void Layer::OnTransformIsPotentiallyAnimatingChanged(bool is_animating) {
       node->data.local_starting_animation_scale = 0.f;
       node->data.has_only_translation_animations = true;
     }
+    node->data.needs_local_transform_update = true;
     transform_tree.set_needs_update(true);
   }
 }
@@ -76,6 +76,7 @@ LayerImpl::LayerImpl(LayerTreeImpl* tree_impl,
       blend_mode_(SkXfermode::kSrcOver_Mode),
       draw_blend_mode_(SkXfermode::kSrcOver_Mode),
       num_descendants_that_draw_content_(0),
+      property_trees_update_number_(-1),
       transform_tree_index_(-1),
       effect_tree_index_(-1),
       clip_tree_index_(-1),
@@ -308,6 +309,9 @@ void LayerImpl::TakeCopyRequestsAndTransformToTarget(
 
   layer_tree_impl()->RemoveLayerWithCopyOutputRequest(this);
   layer_tree_impl()->set_needs_update_draw_properties();
+  // The visible rect covered the whole layer for the copy requests, so it has
+  // to be recomputed.
+  property_trees_update_number_ = -1;
 }
 
 void LayerImpl::ClearRenderSurfaceLayerList() {
@@ -878,6 +882,8 @@ void LayerImpl::UpdatePropertyTreeTransformIsAnimated(bool is_animated) {
         node->data.has_only_translation_animations = true;
       }
 
+      // Animation properties are recomputed along with the node's transforms.
+      node->data.needs_local_transform_update = true;
       transform_tree.set_needs_update(true);
     }
   }
@@ -897,6 +903,7 @@ void LayerImpl::UpdatePropertyTreeOpacity() {
     if (node->owner_id != id())
       return;
     node->data.opacity = opacity_;
+    node->data.opacity_changed = true;
     effect_tree.set_needs_update(true);
   }
 }
@@ -186,6 +186,16 @@ class CC_EXPORT LayerImpl : public LayerAnimationValueObserver,
     clip_rect_in_target_space_from_property_trees_ = rect;
   }
 
+  // The PropertyTrees::layer_update_number of the last update of visible rects
+  // that saw this layer. The visible rect and draw properties computed by that
+  // update are only reused if it was the previous one.
+  int property_trees_update_number() const {
+    return property_trees_update_number_;
+  }
+  void set_property_trees_update_number(int update_number) {
+    property_trees_update_number_ = update_number;
+  }
+
   void set_should_flatten_transform_from_property_tree(bool should_flatten) {
     should_flatten_transform_from_property_tree_ = should_flatten;
     SetNeedsPushProperties();
@@ -809,6 +819,7 @@ class CC_EXPORT LayerImpl : public LayerAnimationValueObserver,
 
   gfx::Rect visible_rect_from_property_trees_;
   gfx::Rect clip_rect_in_target_space_from_property_trees_;
+  int property_trees_update_number_;
   int transform_tree_index_;
   int effect_tree_index_;
   int clip_tree_index_;
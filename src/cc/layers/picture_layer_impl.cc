@@ -535,6 +535,15 @@ void PictureLayerImpl::UpdateRasterSource(
       << " bounds " << bounds().ToString() << " pile "
       << raster_source->GetSize().ToString();
 
+  // A raster source from a commit is not in use by raster yet, which makes
+  // this the time to let it draw decoded images from the tile manager. On
+  // activation, the raster source is the one of the pending twin.
+  TileManager* tile_manager = layer_tree_impl()->tile_manager();
+  if (!pending_set && tile_manager) {
+    raster_source->SetImageDecodeController(
+        tile_manager->image_decode_controller());
+  }
+
   // The |raster_source_| is initially null, so have to check for that for the
   // first frame.
   bool could_have_tilings = raster_source_.get() && CanHaveTilings();
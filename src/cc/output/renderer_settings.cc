@@ -22,7 +22,8 @@ RendererSettings::RendererSettings()
       highp_threshold_min(0),
       use_rgba_4444_textures(false),
       texture_id_allocation_chunk_size(64),
-      use_gpu_memory_buffer_resources(false) {}
+      use_gpu_memory_buffer_resources(false),
+      software_renderer_band_count(1) {}
 
 RendererSettings::~RendererSettings() {
 }
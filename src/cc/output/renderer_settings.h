@@ -27,6 +27,11 @@ class CC_EXPORT RendererSettings {
   bool use_rgba_4444_textures;
   size_t texture_id_allocation_chunk_size;
   bool use_gpu_memory_buffer_resources;
+  // The number of horizontal bands that the software renderer draws the root
+  // render pass in, in parallel. Values below 2 draw it on one thread. The
+  // bands are only drawn in parallel if the renderer's TaskGraphRunner has a
+  // dedicated worker for all but one of them.
+  int software_renderer_band_count;
 };
 
 }  // namespace cc
@@ -4,6 +4,9 @@
 
 #include "cc/output/software_renderer.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/trace_event/trace_event.h"
 #include "cc/base/math_util.h"
 #include "cc/output/compositor_frame.h"
@@ -22,9 +25,12 @@
 #include "skia/ext/opacity_filter_canvas.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkColor.h"
+#include "third_party/skia/include/core/SkDevice.h"
 #include "third_party/skia/include/core/SkImageFilter.h"
 #include "third_party/skia/include/core/SkMatrix.h"
 #include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkPicture.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
 #include "third_party/skia/include/core/SkPoint.h"
 #include "third_party/skia/include/core/SkShader.h"
 #include "third_party/skia/include/effects/SkLayerRasterizer.h"
@@ -49,26 +55,70 @@ bool IsScaleAndIntegerTranslate(const SkMatrix& matrix) {
          SkScalarNearlyZero(matrix[SkMatrix::kMPersp2] - 1.0f);
 }
 
+// Plays back a recorded render pass into the |band| of |bitmap|.
+void DrawPictureIntoBand(const SkPicture* picture,
+                         const SkBitmap& bitmap,
+                         const gfx::Rect& band) {
+  SkBitmap band_bitmap;
+  if (!bitmap.extractSubset(&band_bitmap, gfx::RectToSkIRect(band)))
+    return;
+  // The band's canvas can only draw into the band, whatever clips the pass
+  // replaces its clip with.
+  SkCanvas canvas(band_bitmap);
+  canvas.translate(-band.x(), -band.y());
+  picture->playback(&canvas);
+}
+
+class DrawBandTask : public Task {
+ public:
+  DrawBandTask(const skia::RefPtr<SkPicture>& picture,
+               const SkBitmap& bitmap,
+               const gfx::Rect& band)
+      : picture_(picture), bitmap_(bitmap), band_(band) {}
+
+  // Overridden from Task:
+  void RunOnWorkerThread() override {
+    TRACE_EVENT0("cc", "DrawBandTask::RunOnWorkerThread");
+    DrawPictureIntoBand(picture_.get(), bitmap_, band_);
+  }
+
+ protected:
+  ~DrawBandTask() override {}
+
+ private:
+  skia::RefPtr<SkPicture> picture_;
+  SkBitmap bitmap_;
+  gfx::Rect band_;
+
+  DISALLOW_COPY_AND_ASSIGN(DrawBandTask);
+};
+
 }  // anonymous namespace
 
 scoped_ptr<SoftwareRenderer> SoftwareRenderer::Create(
     RendererClient* client,
     const RendererSettings* settings,
     OutputSurface* output_surface,
-    ResourceProvider* resource_provider) {
-  return make_scoped_ptr(new SoftwareRenderer(
-      client, settings, output_surface, resource_provider));
+    ResourceProvider* resource_provider,
+    TaskGraphRunner* task_graph_runner) {
+  return make_scoped_ptr(new SoftwareRenderer(client, settings, output_surface,
+                                              resource_provider,
+                                              task_graph_runner));
 }
 
 SoftwareRenderer::SoftwareRenderer(RendererClient* client,
                                    const RendererSettings* settings,
                                    OutputSurface* output_surface,
-                                   ResourceProvider* resource_provider)
+                                   ResourceProvider* resource_provider,
+                                   TaskGraphRunner* task_graph_runner)
     : DirectRenderer(client, settings, output_surface, resource_provider),
       is_scissor_enabled_(false),
       is_backbuffer_discarded_(false),
       output_device_(output_surface->software_device()),
-      current_canvas_(NULL) {
+      current_canvas_(NULL),
+      task_graph_runner_(task_graph_runner) {
+  if (task_graph_runner_)
+    namespace_token_ = task_graph_runner_->GetNamespaceToken();
   if (resource_provider_) {
     capabilities_.max_texture_size = resource_provider_->max_texture_size();
     capabilities_.best_texture_format =
@@ -96,6 +146,7 @@ void SoftwareRenderer::BeginDrawingFrame(DrawingFrame* frame) {
 
 void SoftwareRenderer::FinishDrawingFrame(DrawingFrame* frame) {
   TRACE_EVENT0("cc", "SoftwareRenderer::FinishDrawingFrame");
+  DCHECK(!root_render_pass_recorder_);
   current_framebuffer_lock_ = nullptr;
   current_framebuffer_canvas_.clear();
   current_canvas_ = NULL;
@@ -111,6 +162,17 @@ void SoftwareRenderer::SwapBuffers(const CompositorFrameMetadata& metadata) {
   output_surface_->SwapBuffers(&compositor_frame);
 }
 
+void SoftwareRenderer::FinishDrawingQuadList() {
+  if (!root_render_pass_recorder_)
+    return;
+
+  skia::RefPtr<SkPicture> picture =
+      skia::AdoptRef(root_render_pass_recorder_->endRecordingAsPicture());
+  root_render_pass_recorder_ = nullptr;
+  current_canvas_ = root_canvas_;
+  DrawRootRenderPassInBands(picture);
+}
+
 bool SoftwareRenderer::FlippedFramebuffer(const DrawingFrame* frame) const {
   return false;
 }
@@ -202,6 +264,17 @@ void SoftwareRenderer::PrepareSurfaceForPass(
     DrawingFrame* frame,
     SurfaceInitializationMode initialization_mode,
     const gfx::Rect& render_pass_scissor) {
+  if (frame->current_render_pass == frame->root_render_pass &&
+      CanDrawRootRenderPassInBands(frame)) {
+    // Record the pass while its quads are drawn, and play it back into bands
+    // of the root canvas in parallel once they all have been.
+    DCHECK_EQ(current_canvas_, root_canvas_);
+    SkISize size = root_canvas_->getDeviceSize();
+    root_render_pass_recorder_.reset(new SkPictureRecorder);
+    current_canvas_ =
+        root_render_pass_recorder_->beginRecording(size.width(), size.height());
+  }
+
   switch (initialization_mode) {
     case SURFACE_INITIALIZATION_MODE_PRESERVE:
       EnsureScissorTestDisabled();
@@ -229,6 +302,88 @@ bool SoftwareRenderer::IsSoftwareResource(ResourceId resource_id) const {
   return false;
 }
 
+SkBitmap SoftwareRenderer::GetBitmapForCurrentCanvas(
+    const SkBitmap& bitmap) const {
+  SkBitmap result = bitmap;
+  // A recording copies the pixels of mutable bitmaps. The pixels of a locked
+  // resource do not change until the recording has been played back, and the
+  // lock's bitmap has a pixel ref of its own.
+  if (root_render_pass_recorder_)
+    result.setImmutable();
+  return result;
+}
+
+bool SoftwareRenderer::CanDrawRootRenderPassInBands(
+    const DrawingFrame* frame) const {
+  if (!task_graph_runner_ || settings_->software_renderer_band_count < 2 ||
+      !root_canvas_)
+    return false;
+
+  // The bands are drawn directly into the pixels of the root canvas, which
+  // bypasses the copy-on-write of its SkSurface, if any. That is fine because
+  // SoftwareOutputDevice keeps its surface to itself and never takes an image
+  // snapshot of it; copy requests read the pixels back into their own bitmap.
+  SkImageInfo info;
+  size_t row_bytes;
+  SkIPoint origin;
+  if (!root_canvas_->accessTopLayerPixels(&info, &row_bytes, &origin) ||
+      !origin.isZero())
+    return false;
+
+  // Background filters read back what the pass has drawn so far, which is not
+  // in the root canvas while the pass is recorded.
+  for (const DrawQuad* quad : frame->current_render_pass->quad_list) {
+    if (quad->material == DrawQuad::RENDER_PASS &&
+        ShouldApplyBackgroundFilters(RenderPassDrawQuad::MaterialCast(quad)))
+      return false;
+  }
+  return true;
+}
+
+void SoftwareRenderer::DrawRootRenderPassInBands(
+    const skia::RefPtr<SkPicture>& picture) {
+  TRACE_EVENT0("cc", "SoftwareRenderer::DrawRootRenderPassInBands");
+  SkImageInfo info;
+  size_t row_bytes;
+  void* pixels = root_canvas_->accessTopLayerPixels(&info, &row_bytes);
+  DCHECK(pixels);
+  SkBitmap bitmap;
+  if (!bitmap.installPixels(info, pixels, row_bytes) || bitmap.empty())
+    return;
+
+  int band_count =
+      std::min(settings_->software_renderer_band_count, bitmap.height());
+  int band_height = (bitmap.height() + band_count - 1) / band_count;
+  std::vector<gfx::Rect> bands;
+  for (int y = 0; y < bitmap.height(); y += band_height) {
+    bands.push_back(gfx::Rect(0, y, bitmap.width(),
+                              std::min(band_height, bitmap.height() - y)));
+  }
+
+  // Workers draw all bands but the first, which this thread draws meanwhile.
+  // This only draws the bands in parallel if |task_graph_runner_| has a
+  // worker for each of the other bands, and nothing else to run.
+  Task::Vector tasks;
+  TaskGraph graph;
+  for (size_t i = 1; i < bands.size(); ++i) {
+    tasks.push_back(
+        make_scoped_refptr(new DrawBandTask(picture, bitmap, bands[i])));
+    graph.nodes.push_back(TaskGraph::Node(tasks.back().get(), 0u, 0u));
+  }
+  task_graph_runner_->ScheduleTasks(namespace_token_, &graph);
+
+  DrawPictureIntoBand(picture.get(), bitmap, bands[0]);
+
+  task_graph_runner_->WaitForTasksToFinishRunning(namespace_token_);
+  Task::Vector completed_tasks;
+  task_graph_runner_->CollectCompletedTasks(namespace_token_, &completed_tasks);
+  DCHECK_EQ(tasks.size(), completed_tasks.size());
+
+  // The pixels were changed behind the canvas' back, so give them a new
+  // generation ID.
+  root_canvas_->getTopDevice()->accessBitmap(true);
+}
+
 void SoftwareRenderer::DoDrawQuad(DrawingFrame* frame,
                                   const DrawQuad* quad,
                                   const gfx::QuadF* draw_region) {
@@ -404,11 +559,11 @@ void SoftwareRenderer::DrawTextureQuad(const DrawingFrame* frame,
                                                 quad->resource_id());
   if (!lock.valid())
     return;
-  const SkBitmap* bitmap = lock.sk_bitmap();
+  SkBitmap bitmap = GetBitmapForCurrentCanvas(*lock.sk_bitmap());
   gfx::RectF uv_rect = gfx::ScaleRect(gfx::BoundingRect(quad->uv_top_left,
                                                         quad->uv_bottom_right),
-                                      bitmap->width(),
-                                      bitmap->height());
+                                      bitmap.width(),
+                                      bitmap.height());
   gfx::RectF visible_uv_rect = MathUtil::ScaleRectProportional(
       uv_rect, gfx::RectF(quad->rect), gfx::RectF(quad->visible_rect));
   SkRect sk_uv_rect = gfx::RectFToSkRect(visible_uv_rect);
@@ -420,7 +575,7 @@ void SoftwareRenderer::DrawTextureQuad(const DrawingFrame* frame,
     current_canvas_->scale(1, -1);
 
   bool blend_background = quad->background_color != SK_ColorTRANSPARENT &&
-                          !bitmap->isOpaque();
+                          !bitmap.isOpaque();
   bool needs_layer = blend_background && (current_paint_.getAlpha() != 0xFF);
   if (needs_layer) {
     current_canvas_->saveLayerAlpha(&quad_rect, current_paint_.getAlpha());
@@ -433,7 +588,7 @@ void SoftwareRenderer::DrawTextureQuad(const DrawingFrame* frame,
   }
   current_paint_.setFilterQuality(
       quad->nearest_neighbor ? kNone_SkFilterQuality : kLow_SkFilterQuality);
-  current_canvas_->drawBitmapRect(*bitmap, sk_uv_rect, quad_rect,
+  current_canvas_->drawBitmapRect(bitmap, sk_uv_rect, quad_rect,
                                   &current_paint_);
   if (needs_layer)
     current_canvas_->restore();
@@ -460,9 +615,9 @@ void SoftwareRenderer::DrawTileQuad(const DrawingFrame* frame,
   SkRect uv_rect = gfx::RectFToSkRect(visible_tex_coord_rect);
   current_paint_.setFilterQuality(
       quad->nearest_neighbor ? kNone_SkFilterQuality : kLow_SkFilterQuality);
-  current_canvas_->drawBitmapRect(*lock.sk_bitmap(), uv_rect,
-                                  gfx::RectFToSkRect(visible_quad_vertex_rect),
-                                  &current_paint_);
+  current_canvas_->drawBitmapRect(
+      GetBitmapForCurrentCanvas(*lock.sk_bitmap()), uv_rect,
+      gfx::RectFToSkRect(visible_quad_vertex_rect), &current_paint_);
 }
 
 void SoftwareRenderer::DrawRenderPassQuad(const DrawingFrame* frame,
@@ -9,6 +9,9 @@
 #include "cc/base/cc_export.h"
 #include "cc/output/compositor_frame.h"
 #include "cc/output/direct_renderer.h"
+#include "cc/raster/task_graph_runner.h"
+
+class SkPictureRecorder;
 
 namespace cc {
 
@@ -31,7 +34,8 @@ class CC_EXPORT SoftwareRenderer : public DirectRenderer {
       RendererClient* client,
       const RendererSettings* settings,
       OutputSurface* output_surface,
-      ResourceProvider* resource_provider);
+      ResourceProvider* resource_provider,
+      TaskGraphRunner* task_graph_runner);
 
   ~SoftwareRenderer() override;
   const RendererCapabilitiesImpl& Capabilities() const override;
@@ -55,6 +59,7 @@ class CC_EXPORT SoftwareRenderer : public DirectRenderer {
                   const gfx::QuadF* draw_region) override;
   void BeginDrawingFrame(DrawingFrame* frame) override;
   void FinishDrawingFrame(DrawingFrame* frame) override;
+  void FinishDrawingQuadList() override;
   bool FlippedFramebuffer(const DrawingFrame* frame) const override;
   void EnsureScissorTestEnabled() override;
   void EnsureScissorTestDisabled() override;
@@ -65,7 +70,8 @@ class CC_EXPORT SoftwareRenderer : public DirectRenderer {
   SoftwareRenderer(RendererClient* client,
                    const RendererSettings* settings,
                    OutputSurface* output_surface,
-                   ResourceProvider* resource_provider);
+                   ResourceProvider* resource_provider,
+                   TaskGraphRunner* task_graph_runner);
 
   void DidChangeVisibility() override;
 
@@ -74,6 +80,10 @@ class CC_EXPORT SoftwareRenderer : public DirectRenderer {
   void ClearFramebuffer(DrawingFrame* frame);
   void SetClipRect(const gfx::Rect& rect);
   bool IsSoftwareResource(ResourceId resource_id) const;
+  SkBitmap GetBitmapForCurrentCanvas(const SkBitmap& bitmap) const;
+
+  bool CanDrawRootRenderPassInBands(const DrawingFrame* frame) const;
+  void DrawRootRenderPassInBands(const skia::RefPtr<SkPicture>& picture);
 
   void DrawCheckerboardQuad(const DrawingFrame* frame,
                             const CheckerboardDrawQuad* quad);
@@ -118,6 +128,15 @@ class CC_EXPORT SoftwareRenderer : public DirectRenderer {
       current_framebuffer_lock_;
   skia::RefPtr<SkCanvas> current_framebuffer_canvas_;
 
+  // Runs the tasks that draw bands of the root render pass. Null if the root
+  // render pass is always drawn on the compositor thread.
+  TaskGraphRunner* task_graph_runner_;
+  NamespaceToken namespace_token_;
+
+  // Records the root render pass while its quads are drawn, when it is drawn
+  // in bands.
+  scoped_ptr<SkPictureRecorder> root_render_pass_recorder_;
+
   DISALLOW_COPY_AND_ASSIGN(SoftwareRenderer);
 };
 
@@ -9,6 +9,7 @@
 #include "base/logging.h"
 #include "base/strings/stringprintf.h"
 #include "base/trace_event/trace_event_argument.h"
+#include "cc/playback/display_item_list_bounds_calculator.h"
 #include "cc/proto/display_item.pb.h"
 #include "cc/proto/gfx_conversions.h"
 #include "cc/proto/skia_conversions.h"
@@ -102,6 +103,12 @@ void ClipDisplayItem::AsValueInto(base::trace_event::TracedValue* array) const {
   array->AppendString(value);
 }
 
+void ClipDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  SkRect clip_rect = gfx::RectToSkRect(clip_rect_);
+  calculator->AddStartingClipDisplayItem(&clip_rect);
+}
+
 EndClipDisplayItem::EndClipDisplayItem() {
   DisplayItem::SetNew(true /* suitable_for_gpu_raster */, 0 /* op_count */,
                       0 /* external_memory_usage */);
@@ -129,4 +136,9 @@ void EndClipDisplayItem::AsValueInto(
   array->AppendString("EndClipDisplayItem");
 }
 
+void EndClipDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  calculator->AddEndingDisplayItem();
+}
+
 }  // namespace cc
@@ -6,6 +6,7 @@
 
 #include "base/strings/stringprintf.h"
 #include "base/trace_event/trace_event_argument.h"
+#include "cc/playback/display_item_list_bounds_calculator.h"
 #include "cc/proto/display_item.pb.h"
 #include "cc/proto/skia_conversions.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -77,6 +78,17 @@ void ClipPathDisplayItem::AsValueInto(
                                          clip_path_.countPoints()));
 }
 
+void ClipPathDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  // Only intersecting with the inside of the path restricts drawing to its
+  // bounds.
+  if (clip_op_ != SkRegion::kIntersect_Op || clip_path_.isInverseFillType()) {
+    calculator->AddStartingClipDisplayItem(nullptr);
+    return;
+  }
+  calculator->AddStartingClipDisplayItem(&clip_path_.getBounds());
+}
+
 EndClipPathDisplayItem::EndClipPathDisplayItem() {
   DisplayItem::SetNew(true /* suitable_for_gpu_raster */, 0 /* op_count */,
                       0 /* external_memory_usage */);
@@ -105,4 +117,9 @@ void EndClipPathDisplayItem::AsValueInto(
   array->AppendString("EndClipPathDisplayItem");
 }
 
+void EndClipPathDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  calculator->AddEndingDisplayItem();
+}
+
 }  // namespace cc
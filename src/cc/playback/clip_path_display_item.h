@@ -28,6 +28,8 @@ class CC_EXPORT ClipPathDisplayItem : public DisplayItem {
               const gfx::Rect& canvas_target_playback_rect,
               SkPicture::AbortCallback* callback) const override;
   void AsValueInto(base::trace_event::TracedValue* array) const override;
+  void ProcessForBounds(
+      DisplayItemListBoundsCalculator* calculator) const override;
 
  private:
   SkPath clip_path_;
@@ -50,6 +52,8 @@ class CC_EXPORT EndClipPathDisplayItem : public DisplayItem {
               const gfx::Rect& canvas_target_playback_rect,
               SkPicture::AbortCallback* callback) const override;
   void AsValueInto(base::trace_event::TracedValue* array) const override;
+  void ProcessForBounds(
+      DisplayItemListBoundsCalculator* calculator) const override;
 };
 
 }  // namespace cc
@@ -6,6 +6,7 @@
 
 #include "base/strings/stringprintf.h"
 #include "base/trace_event/trace_event_argument.h"
+#include "cc/playback/display_item_list_bounds_calculator.h"
 #include "cc/proto/display_item.pb.h"
 #include "cc/proto/gfx_conversions.h"
 #include "cc/proto/skia_conversions.h"
@@ -104,6 +105,16 @@ void CompositingDisplayItem::AsValueInto(
         static_cast<float>(bounds_.height())));
 }
 
+void CompositingDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  // Modes other than source-over, and color filters, can change the pixels
+  // below the parts of the layer that are transparent.
+  bool can_draw_outside_contents =
+      xfermode_ != SkXfermode::kSrcOver_Mode || color_filter_;
+  calculator->AddStartingLayerDisplayItem(has_bounds_ ? &bounds_ : nullptr,
+                                          can_draw_outside_contents);
+}
+
 EndCompositingDisplayItem::EndCompositingDisplayItem() {
   DisplayItem::SetNew(true /* suitable_for_gpu_raster */, 0 /* op_count */,
                       0 /* external_memory_usage */);
@@ -132,4 +143,9 @@ void EndCompositingDisplayItem::AsValueInto(
   array->AppendString("EndCompositingDisplayItem");
 }
 
+void EndCompositingDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  calculator->AddEndingDisplayItem();
+}
+
 }  // namespace cc
@@ -34,6 +34,8 @@ class CC_EXPORT CompositingDisplayItem : public DisplayItem {
               const gfx::Rect& canvas_target_playback_rect,
               SkPicture::AbortCallback* callback) const override;
   void AsValueInto(base::trace_event::TracedValue* array) const override;
+  void ProcessForBounds(
+      DisplayItemListBoundsCalculator* calculator) const override;
 
  private:
   uint8_t alpha_;
@@ -58,6 +60,8 @@ class CC_EXPORT EndCompositingDisplayItem : public DisplayItem {
               const gfx::Rect& canvas_target_playback_rect,
               SkPicture::AbortCallback* callback) const override;
   void AsValueInto(base::trace_event::TracedValue* array) const override;
+  void ProcessForBounds(
+      DisplayItemListBoundsCalculator* calculator) const override;
 };
 
 }  // namespace cc
@@ -23,15 +23,6 @@ SkRect MapRect(const SkMatrix& matrix, const SkRect& src) {
   return dst;
 }
 
-SkSize ExtractScale(const SkMatrix& matrix) {
-  SkSize scale = SkSize::Make(matrix.getScaleX(), matrix.getScaleY());
-  if (matrix.getType() & SkMatrix::kAffine_Mask) {
-    if (!matrix.decomposeScale(&scale))
-      scale.set(1, 1);
-  }
-  return scale;
-}
-
 // We're using an NWay canvas with no added canvases, so in effect
 // non-overridden functions are no-ops.
 class DiscardableImagesMetadataCanvas : public SkNWayCanvas {
@@ -84,7 +75,10 @@ class DiscardableImagesMetadataCanvas : public SkNWayCanvas {
                        const SkIRect& center,
                        const SkRect& dst,
                        const SkPaint* paint) override {
-    AddImage(image, dst, this->getTotalMatrix(), paint);
+    // ImageHijackCanvas draws nine-patch images as they are, so a scaled
+    // decode would never be used. Recording them unfiltered keeps them on the
+    // original size decode.
+    AddImage(image, dst, this->getTotalMatrix(), nullptr);
   }
 
  private:
@@ -98,7 +92,7 @@ class DiscardableImagesMetadataCanvas : public SkNWayCanvas {
         filter_quality = paint->getFilterQuality();
       }
       image_set_->push_back(
-          std::make_pair(DrawImage(image, ExtractScale(matrix), filter_quality),
+          std::make_pair(DrawImage(image, matrix, filter_quality),
                          gfx::SkRectToRectF(rect)));
     }
   }
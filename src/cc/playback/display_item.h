@@ -15,6 +15,8 @@ class SkCanvas;
 
 namespace cc {
 
+class DisplayItemListBoundsCalculator;
+
 namespace proto {
 class DisplayItem;
 }
@@ -37,6 +39,10 @@ class CC_EXPORT DisplayItem {
                       const gfx::Rect& canvas_target_playback_rect,
                       SkPicture::AbortCallback* callback) const = 0;
   virtual void AsValueInto(base::trace_event::TracedValue* array) const = 0;
+  // Adds the item to |calculator|, which computes the bounds of what the
+  // item can change for the list's spatial index.
+  virtual void ProcessForBounds(
+      DisplayItemListBoundsCalculator* calculator) const = 0;
 
   bool is_suitable_for_gpu_rasterization() const {
     return is_suitable_for_gpu_rasterization_;
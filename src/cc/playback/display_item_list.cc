@@ -4,6 +4,7 @@
 
 #include "cc/playback/display_item_list.h"
 
+#include <algorithm>
 #include <string>
 
 #include "base/numerics/safe_conversions.h"
@@ -13,6 +14,7 @@
 #include "cc/debug/picture_debug_util.h"
 #include "cc/debug/traced_display_item_list.h"
 #include "cc/debug/traced_value.h"
+#include "cc/playback/display_item_list_bounds_calculator.h"
 #include "cc/playback/display_item_list_settings.h"
 #include "cc/playback/display_item_proto_factory.h"
 #include "cc/playback/largest_display_item.h"
@@ -72,6 +74,7 @@ DisplayItemList::DisplayItemList(gfx::Rect layer_rect,
                                  const DisplayItemListSettings& settings,
                                  bool retain_individual_display_items)
     : items_(LargestDisplayItemSize(), kDefaultNumDisplayItemsToReserve),
+      has_rtree_(false),
       settings_(settings),
       retain_individual_display_items_(retain_individual_display_items),
       layer_rect_(layer_rect),
@@ -112,8 +115,29 @@ void DisplayItemList::Raster(SkCanvas* canvas,
   if (!settings_.use_cached_picture) {
     canvas->save();
     canvas->scale(contents_scale, contents_scale);
-    for (auto* item : items_)
-      item->Raster(canvas, canvas_target_playback_rect, callback);
+
+    // The playback rect is in the space of the device, while the index is in
+    // the space of the layer. An empty playback rect means no culling.
+    SkMatrix inverse;
+    if (!has_rtree_ || canvas_target_playback_rect.IsEmpty() ||
+        canvas->getTotalMatrix().hasPerspective() ||
+        !canvas->getTotalMatrix().invert(&inverse)) {
+      for (auto* item : items_)
+        item->Raster(canvas, canvas_target_playback_rect, callback);
+      canvas->restore();
+      return;
+    }
+
+    SkRect query_rect = gfx::RectToSkRect(canvas_target_playback_rect);
+    inverse.mapRect(&query_rect);
+    std::vector<size_t> indices;
+    rtree_.Search(gfx::SkRectToRectF(query_rect), &indices);
+    // The items have to be played back in the order that they were appended.
+    std::sort(indices.begin(), indices.end());
+    for (size_t index : indices) {
+      items_.ElementAt(index)->Raster(canvas, canvas_target_playback_rect,
+                                      callback);
+    }
     canvas->restore();
   } else {
     DCHECK(picture_);
@@ -196,6 +220,7 @@ void DisplayItemList::RemoveLast() {
   // don't need to remove it from approximate_op_count_, etc.
   DCHECK(retain_individual_display_items_);
   DCHECK(!settings_.use_cached_picture);
+  DCHECK(!has_rtree_);
   items_.RemoveLast();
 }
 
@@ -214,6 +239,15 @@ void DisplayItemList::Finalize() {
     canvas_.clear();
     is_suitable_for_gpu_rasterization_ =
         picture_->suitableForGpuRasterization(nullptr);
+  } else if (retain_individual_display_items_) {
+    DCHECK(!has_rtree_);
+    DisplayItemListBoundsCalculator calculator;
+    for (const DisplayItem* item : items_)
+      item->ProcessForBounds(&calculator);
+    std::vector<gfx::RectF> item_bounds;
+    calculator.Finish(&item_bounds);
+    rtree_.Build(item_bounds);
+    has_rtree_ = true;
   }
 }
 
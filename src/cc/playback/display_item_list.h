@@ -11,6 +11,7 @@
 #include "base/trace_event/trace_event.h"
 #include "cc/base/cc_export.h"
 #include "cc/base/list_container.h"
+#include "cc/base/rtree.h"
 #include "cc/playback/discardable_image_map.h"
 #include "cc/playback/display_item.h"
 #include "cc/playback/display_item_list_settings.h"
@@ -75,7 +76,8 @@ class CC_EXPORT DisplayItemList
   void RemoveLast();
 
   // Called after all items are appended, to process the items and, if
-  // applicable, create an internally cached SkPicture.
+  // applicable, create an internally cached SkPicture or the index that lets
+  // Raster() skip the items that are outside of the playback rect.
   void Finalize();
 
   bool IsSuitableForGpuRasterization() const;
@@ -115,6 +117,11 @@ class CC_EXPORT DisplayItemList
   ListContainer<DisplayItem> items_;
   skia::RefPtr<SkPicture> picture_;
 
+  // Indexes |items_| by the bounds of what they draw, in layer space, when
+  // they are played back individually. Built by Finalize().
+  RTree rtree_;
+  bool has_rtree_;
+
   scoped_ptr<SkPictureRecorder> recorder_;
   skia::RefPtr<SkCanvas> canvas_;
   const DisplayItemListSettings settings_;
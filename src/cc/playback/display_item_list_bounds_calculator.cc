@@ -0,0 +1,117 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/playback/display_item_list_bounds_calculator.h"
+
+#include <limits>
+
+#include "ui/gfx/skia_util.h"
+
+namespace cc {
+namespace {
+
+// Bounds that include everything a layer can contain, but whose corners can
+// still be added together.
+gfx::RectF EverythingRect() {
+  const float kMax = std::numeric_limits<float>::max() / 4;
+  return gfx::RectF(-kMax, -kMax, 2 * kMax, 2 * kMax);
+}
+
+}  // namespace
+
+DisplayItemListBoundsCalculator::DisplayItemListBoundsCalculator()
+    : matrix_(SkMatrix::I()), clip_(EverythingRect()) {}
+
+DisplayItemListBoundsCalculator::~DisplayItemListBoundsCalculator() {}
+
+void DisplayItemListBoundsCalculator::AddDrawingDisplayItem(
+    const SkRect& bounds) {
+  gfx::RectF layer_bounds = MapRect(bounds);
+  layer_bounds.Intersect(clip_);
+  bounds_.push_back(layer_bounds);
+  if (!starting_items_.empty())
+    starting_items_.back().contents_bounds.Union(layer_bounds);
+}
+
+void DisplayItemListBoundsCalculator::AddStartingClipDisplayItem(
+    const SkRect* clip_rect) {
+  AddStartingDisplayItem();
+  if (clip_rect)
+    clip_.Intersect(MapRect(*clip_rect));
+  else
+    clip_ = EverythingRect();
+}
+
+void DisplayItemListBoundsCalculator::AddStartingTransformDisplayItem(
+    const SkMatrix& matrix) {
+  AddStartingDisplayItem();
+  matrix_.preConcat(matrix);
+}
+
+void DisplayItemListBoundsCalculator::AddStartingLayerDisplayItem(
+    const SkRect* bounds,
+    bool can_draw_outside_contents) {
+  StartingItem* item = AddStartingDisplayItem();
+  if (bounds)
+    clip_.Intersect(MapRect(*bounds));
+  if (can_draw_outside_contents) {
+    item->has_fixed_bounds = true;
+    item->fixed_bounds = clip_;
+  }
+}
+
+void DisplayItemListBoundsCalculator::AddEndingDisplayItem() {
+  if (starting_items_.empty()) {
+    // This restores state that the list did not save, so it is always played
+    // back, as it was before the list had an index.
+    bounds_.push_back(EverythingRect());
+    return;
+  }
+
+  const StartingItem& item = starting_items_.back();
+  gfx::RectF pair_bounds =
+      item.has_fixed_bounds ? item.fixed_bounds : item.contents_bounds;
+  bounds_[item.index] = pair_bounds;
+  bounds_.push_back(pair_bounds);
+  matrix_ = item.matrix;
+  clip_ = item.clip;
+  starting_items_.pop_back();
+
+  if (!starting_items_.empty())
+    starting_items_.back().contents_bounds.Union(pair_bounds);
+}
+
+void DisplayItemListBoundsCalculator::Finish(std::vector<gfx::RectF>* bounds) {
+  for (const StartingItem& item : starting_items_)
+    bounds_[item.index] = EverythingRect();
+  starting_items_.clear();
+  bounds->swap(bounds_);
+  bounds_.clear();
+}
+
+DisplayItemListBoundsCalculator::StartingItem*
+DisplayItemListBoundsCalculator::AddStartingDisplayItem() {
+  // The bounds are known once the item that ends this one is added.
+  starting_items_.push_back(StartingItem());
+  StartingItem* item = &starting_items_.back();
+  item->index = bounds_.size();
+  item->matrix = matrix_;
+  item->clip = clip_;
+  item->has_fixed_bounds = false;
+  bounds_.push_back(gfx::RectF());
+  return item;
+}
+
+gfx::RectF DisplayItemListBoundsCalculator::MapRect(const SkRect& rect) const {
+  // Points behind the viewer do not map to meaningful bounds.
+  if (matrix_.hasPerspective())
+    return EverythingRect();
+  SkRect mapped;
+  matrix_.mapRect(&mapped, rect);
+  if (!mapped.isFinite())
+    return EverythingRect();
+  return gfx::SkRectToRectF(mapped);
+}
+
+}  // namespace cc
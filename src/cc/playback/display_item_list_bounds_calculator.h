@@ -0,0 +1,86 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_PLAYBACK_DISPLAY_ITEM_LIST_BOUNDS_CALCULATOR_H_
+#define CC_PLAYBACK_DISPLAY_ITEM_LIST_BOUNDS_CALCULATOR_H_
+
+#include <vector>
+
+#include "base/macros.h"
+#include "cc/base/cc_export.h"
+#include "third_party/skia/include/core/SkMatrix.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "ui/gfx/geometry/rect_f.h"
+
+namespace cc {
+
+// Computes the bounds in layer space of what each item of a display list can
+// change, for the list's spatial index. The items are added in order through
+// DisplayItem::ProcessForBounds().
+//
+// An item that starts a clip, transform or layer gets the same bounds as the
+// item that ends it, which are those of the items in between (or, for layers
+// that can change pixels outside of what they contain, the clip), so that a
+// rect either intersects both or neither.
+class CC_EXPORT DisplayItemListBoundsCalculator {
+ public:
+  DisplayItemListBoundsCalculator();
+  ~DisplayItemListBoundsCalculator();
+
+  // Adds an item that draws into |bounds|, in the space of the item.
+  void AddDrawingDisplayItem(const SkRect& bounds);
+
+  // Adds an item that intersects the clip with |clip_rect|, or that changes
+  // the clip in an unknown way if |clip_rect| is null.
+  void AddStartingClipDisplayItem(const SkRect* clip_rect);
+
+  // Adds an item that concatenates |matrix| to the transform.
+  void AddStartingTransformDisplayItem(const SkMatrix& matrix);
+
+  // Adds an item that saves a layer, which is limited to |bounds| if they are
+  // not null. If |can_draw_outside_contents|, e.g. because the layer is
+  // filtered or blended with a mode that changes transparent pixels,
+  // compositing the layer can change pixels that it did not draw into.
+  void AddStartingLayerDisplayItem(const SkRect* bounds,
+                                   bool can_draw_outside_contents);
+
+  // Adds the item that ends the innermost item that was started.
+  void AddEndingDisplayItem();
+
+  // Stores the bounds of all the items into |bounds|, indexed like the items.
+  // Items that are not paired get bounds that include everything.
+  void Finish(std::vector<gfx::RectF>* bounds);
+
+ private:
+  struct StartingItem {
+    size_t index;
+
+    // The transform and clip before the item, which the ending item restores.
+    SkMatrix matrix;
+    gfx::RectF clip;
+
+    // The union of the bounds of the items in between.
+    gfx::RectF contents_bounds;
+
+    // The bounds of layers that can change pixels outside of their contents.
+    bool has_fixed_bounds;
+    gfx::RectF fixed_bounds;
+  };
+
+  StartingItem* AddStartingDisplayItem();
+  gfx::RectF MapRect(const SkRect& rect) const;
+
+  std::vector<gfx::RectF> bounds_;
+  std::vector<StartingItem> starting_items_;
+
+  // The transform and the bounds of the clip that apply to the next item.
+  SkMatrix matrix_;
+  gfx::RectF clip_;
+
+  DISALLOW_COPY_AND_ASSIGN(DisplayItemListBoundsCalculator);
+};
+
+}  // namespace cc
+
+#endif  // CC_PLAYBACK_DISPLAY_ITEM_LIST_BOUNDS_CALCULATOR_H_
@@ -8,6 +8,7 @@
 #include "cc/base/region.h"
 #include "cc/debug/debug_colors.h"
 #include "cc/playback/display_item_list.h"
+#include "cc/playback/image_hijack_canvas.h"
 #include "skia/ext/analysis_canvas.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
@@ -39,7 +40,8 @@ DisplayListRasterSource::DisplayListRasterSource(
       slow_down_raster_scale_factor_for_debug_(
           other->slow_down_raster_scale_factor_for_debug_),
       should_attempt_to_use_distance_field_text_(false),
-      default_lcd_background_color_(other->default_lcd_background_color_) {}
+      default_lcd_background_color_(other->default_lcd_background_color_),
+      image_decode_controller_(nullptr) {}
 
 DisplayListRasterSource::DisplayListRasterSource(
     const DisplayListRasterSource* other,
@@ -58,7 +60,8 @@ DisplayListRasterSource::DisplayListRasterSource(
           other->slow_down_raster_scale_factor_for_debug_),
       should_attempt_to_use_distance_field_text_(
           other->should_attempt_to_use_distance_field_text_),
-      default_lcd_background_color_(other->default_lcd_background_color_) {}
+      default_lcd_background_color_(other->default_lcd_background_color_),
+      image_decode_controller_(other->image_decode_controller_) {}
 
 DisplayListRasterSource::~DisplayListRasterSource() {
 }
@@ -83,7 +86,16 @@ void DisplayListRasterSource::PlaybackToCanvas(
     float contents_scale) const {
   PrepareForPlaybackToCanvas(canvas, canvas_bitmap_rect, canvas_playback_rect,
                              contents_scale);
-  RasterCommon(canvas, NULL, canvas_bitmap_rect, canvas_playback_rect,
+
+  if (!image_decode_controller_) {
+    RasterCommon(canvas, NULL, canvas_bitmap_rect, canvas_playback_rect,
+                 contents_scale);
+    return;
+  }
+
+  // The tile manager has decoded the images of the rect ahead of raster.
+  ImageHijackCanvas hijack_canvas(canvas, image_decode_controller_);
+  RasterCommon(&hijack_canvas, NULL, canvas_bitmap_rect, canvas_playback_rect,
                contents_scale);
 }
 
@@ -243,6 +255,11 @@ void DisplayListRasterSource::GetDiscardableImagesInRect(
   display_list_->GetDiscardableImagesInRect(layer_rect, raster_scale, images);
 }
 
+void DisplayListRasterSource::SetImageDecodeController(
+    ImageDecodeController* image_decode_controller) {
+  image_decode_controller_ = image_decode_controller;
+}
+
 bool DisplayListRasterSource::CoversRect(const gfx::Rect& layer_rect) const {
   if (size_.IsEmpty())
     return false;
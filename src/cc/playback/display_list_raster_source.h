@@ -18,6 +18,7 @@
 namespace cc {
 class DisplayItemList;
 class DrawImage;
+class ImageDecodeController;
 
 class CC_EXPORT DisplayListRasterSource
     : public base::RefCountedThreadSafe<DisplayListRasterSource> {
@@ -77,6 +78,11 @@ class CC_EXPORT DisplayListRasterSource
                                   float raster_scale,
                                   std::vector<DrawImage>* images) const;
 
+  // Makes PlaybackToCanvas() draw the images that |image_decode_controller|
+  // has decoded from its cache. This has to be called before the raster
+  // source is used on other threads.
+  void SetImageDecodeController(ImageDecodeController* image_decode_controller);
+
   // Return true iff this raster source can raster the given rect in layer
   // space.
   bool CoversRect(const gfx::Rect& layer_rect) const;
@@ -134,6 +140,8 @@ class CC_EXPORT DisplayListRasterSource
   // threads with multi-threaded Ganesh.  Make this const or remove it.
   bool should_attempt_to_use_distance_field_text_;
   const SkColor default_lcd_background_color_;
+  // Only set before the raster source is shared with other threads.
+  ImageDecodeController* image_decode_controller_;
 
  private:
   // Called when analyzing a tile. We can use AnalysisCanvas as
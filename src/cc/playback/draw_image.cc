@@ -0,0 +1,28 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/playback/draw_image.h"
+
+namespace cc {
+namespace {
+
+SkSize ExtractScale(const SkMatrix& matrix) {
+  SkSize scale = SkSize::Make(matrix.getScaleX(), matrix.getScaleY());
+  if (matrix.getType() & SkMatrix::kAffine_Mask) {
+    if (!matrix.decomposeScale(&scale))
+      scale.set(1, 1);
+  }
+  return scale;
+}
+
+}  // namespace
+
+DrawImage::DrawImage(const SkImage* image,
+                     const SkMatrix& matrix,
+                     SkFilterQuality filter_quality)
+    : image_(image),
+      scale_(ExtractScale(matrix)),
+      filter_quality_(filter_quality) {}
+
+}  // namespace cc
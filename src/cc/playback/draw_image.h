@@ -5,19 +5,24 @@
 #ifndef CC_PLAYBACK_DRAW_IMAGE_H_
 #define CC_PLAYBACK_DRAW_IMAGE_H_
 
+#include "cc/base/cc_export.h"
 #include "third_party/skia/include/core/SkFilterQuality.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkMatrix.h"
 
 namespace cc {
 
-class DrawImage {
+class CC_EXPORT DrawImage {
  public:
   DrawImage() : image_(nullptr), filter_quality_(kNone_SkFilterQuality) {}
   DrawImage(const SkImage* image,
             const SkSize& scale,
             SkFilterQuality filter_quality)
       : image_(image), scale_(scale), filter_quality_(filter_quality) {}
+  // Takes the scale from |matrix|, which maps the image to device space.
+  DrawImage(const SkImage* image,
+            const SkMatrix& matrix,
+            SkFilterQuality filter_quality);
 
   const SkImage* image() const { return image_; }
   const SkSize& scale() const { return scale_; }
@@ -10,6 +10,7 @@
 #include "base/trace_event/trace_event_argument.h"
 #include "base/values.h"
 #include "cc/debug/picture_debug_util.h"
+#include "cc/playback/display_item_list_bounds_calculator.h"
 #include "cc/proto/display_item.pb.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkData.h"
@@ -107,6 +108,11 @@ void DrawingDisplayItem::AsValueInto(
   array->EndDictionary();
 }
 
+void DrawingDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  calculator->AddDrawingDisplayItem(picture_->cullRect());
+}
+
 void DrawingDisplayItem::CloneTo(DrawingDisplayItem* item) const {
   item->SetNew(picture_);
 }
@@ -7,6 +7,7 @@
 #include "base/strings/stringprintf.h"
 #include "base/trace_event/trace_event_argument.h"
 #include "cc/output/render_surface_filters.h"
+#include "cc/playback/display_item_list_bounds_calculator.h"
 #include "cc/proto/display_item.pb.h"
 #include "cc/proto/gfx_conversions.h"
 #include "skia/ext/refptr.h"
@@ -82,6 +83,14 @@ void FilterDisplayItem::AsValueInto(
                                          bounds_.ToString().c_str()));
 }
 
+void FilterDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  // Filters can move and create pixels anywhere within the layer's bounds.
+  SkRect bounds = gfx::RectFToSkRect(bounds_);
+  bool can_draw_outside_contents = true;
+  calculator->AddStartingLayerDisplayItem(&bounds, can_draw_outside_contents);
+}
+
 EndFilterDisplayItem::EndFilterDisplayItem() {
   DisplayItem::SetNew(true /* suitable_for_gpu_raster */, 0 /* op_count */,
                       0 /* external_memory_usage */);
@@ -110,4 +119,9 @@ void EndFilterDisplayItem::AsValueInto(
   array->AppendString("EndFilterDisplayItem");
 }
 
+void EndFilterDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  calculator->AddEndingDisplayItem();
+}
+
 }  // namespace cc
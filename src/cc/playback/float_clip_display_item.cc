@@ -6,6 +6,7 @@
 
 #include "base/strings/stringprintf.h"
 #include "base/trace_event/trace_event_argument.h"
+#include "cc/playback/display_item_list_bounds_calculator.h"
 #include "cc/proto/display_item.pb.h"
 #include "cc/proto/gfx_conversions.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -55,6 +56,12 @@ void FloatClipDisplayItem::AsValueInto(
                                          clip_rect_.ToString().c_str()));
 }
 
+void FloatClipDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  SkRect clip_rect = gfx::RectFToSkRect(clip_rect_);
+  calculator->AddStartingClipDisplayItem(&clip_rect);
+}
+
 EndFloatClipDisplayItem::EndFloatClipDisplayItem() {
   DisplayItem::SetNew(true /* suitable_for_gpu_raster */, 0 /* op_count */,
                       0 /* external_memory_usage */);
@@ -83,4 +90,9 @@ void EndFloatClipDisplayItem::AsValueInto(
   array->AppendString("EndFloatClipDisplayItem");
 }
 
+void EndFloatClipDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  calculator->AddEndingDisplayItem();
+}
+
 }  // namespace cc
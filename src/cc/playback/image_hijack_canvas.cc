@@ -0,0 +1,123 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cc/playback/image_hijack_canvas.h"
+
+#include <algorithm>
+
+#include "cc/playback/draw_image.h"
+#include "cc/tiles/image_decode_controller.h"
+#include "skia/ext/refptr.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkPaint.h"
+
+namespace cc {
+namespace {
+
+SkFilterQuality FilterQuality(const SkPaint* paint) {
+  return paint ? paint->getFilterQuality() : kNone_SkFilterQuality;
+}
+
+}  // namespace
+
+ImageHijackCanvas::ImageHijackCanvas(
+    SkCanvas* canvas,
+    ImageDecodeController* image_decode_controller)
+    : SkNWayCanvas(canvas->getBaseLayerSize().width(),
+                   canvas->getBaseLayerSize().height()),
+      image_decode_controller_(image_decode_controller) {
+  // This is set up before |canvas| is added, as it would be applied to
+  // |canvas| again otherwise.
+  SkIRect clip_bounds;
+  if (!canvas->getClipDeviceBounds(&clip_bounds))
+    clip_bounds.setEmpty();
+  clipRect(SkRect::Make(clip_bounds));
+  setMatrix(canvas->getTotalMatrix());
+  addCanvas(canvas);
+}
+
+void ImageHijackCanvas::onDrawPicture(const SkPicture* picture,
+                                      const SkMatrix* matrix,
+                                      const SkPaint* paint) {
+  SkCanvas::onDrawPicture(picture, matrix, paint);
+}
+
+void ImageHijackCanvas::onDrawImage(const SkImage* image,
+                                    SkScalar x,
+                                    SkScalar y,
+                                    const SkPaint* paint) {
+  // Only lazily generated images are decoded by the controller.
+  skia::RefPtr<SkImage> decoded_image;
+  if (image->isLazyGenerated()) {
+    decoded_image = image_decode_controller_->GetDecodedImageForDraw(
+        DrawImage(image, getTotalMatrix(), FilterQuality(paint)));
+  }
+  if (!decoded_image) {
+    SkNWayCanvas::onDrawImage(image, x, y, paint);
+    return;
+  }
+
+  DrawDecodedImageRect(
+      image, decoded_image.get(), SkRect::MakeIWH(image->width(),
+                                                  image->height()),
+      SkRect::MakeXYWH(x, y, image->width(), image->height()), paint,
+      kFast_SrcRectConstraint);
+}
+
+void ImageHijackCanvas::onDrawImageRect(const SkImage* image,
+                                        const SkRect* src,
+                                        const SkRect& dst,
+                                        const SkPaint* paint,
+                                        SrcRectConstraint constraint) {
+  skia::RefPtr<SkImage> decoded_image;
+  SkRect src_rect = src ? *src : SkRect::MakeIWH(image->width(),
+                                                 image->height());
+  if (image->isLazyGenerated()) {
+    // This matches the scale that DiscardableImageMap records for the draw.
+    SkMatrix matrix;
+    matrix.setRectToRect(src_rect, dst, SkMatrix::kFill_ScaleToFit);
+    matrix.postConcat(getTotalMatrix());
+    decoded_image = image_decode_controller_->GetDecodedImageForDraw(
+        DrawImage(image, matrix, FilterQuality(paint)));
+  }
+  if (!decoded_image) {
+    SkNWayCanvas::onDrawImageRect(image, src, dst, paint, constraint);
+    return;
+  }
+
+  DrawDecodedImageRect(image, decoded_image.get(), src_rect, dst, paint,
+                       constraint);
+}
+
+void ImageHijackCanvas::DrawDecodedImageRect(const SkImage* image,
+                                             const SkImage* decoded_image,
+                                             const SkRect& src,
+                                             const SkRect& dst,
+                                             const SkPaint* paint,
+                                             SrcRectConstraint constraint) {
+  if (decoded_image->width() == image->width() &&
+      decoded_image->height() == image->height()) {
+    SkNWayCanvas::onDrawImageRect(decoded_image, &src, dst, paint, constraint);
+    return;
+  }
+
+  // The decoded image has been filtered with the paint's quality when it was
+  // scaled down, and what is left of the scale is close to one, which
+  // bilinear filtering handles well.
+  SkPaint decoded_paint;
+  if (paint)
+    decoded_paint = *paint;
+  decoded_paint.setFilterQuality(
+      std::min(decoded_paint.getFilterQuality(), kLow_SkFilterQuality));
+
+  SkRect decoded_src = SkRect::MakeXYWH(
+      src.x() * decoded_image->width() / image->width(),
+      src.y() * decoded_image->height() / image->height(),
+      src.width() * decoded_image->width() / image->width(),
+      src.height() * decoded_image->height() / image->height());
+  SkNWayCanvas::onDrawImageRect(decoded_image, &decoded_src, dst,
+                                &decoded_paint, constraint);
+}
+
+}  // namespace cc
@@ -0,0 +1,59 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CC_PLAYBACK_IMAGE_HIJACK_CANVAS_H_
+#define CC_PLAYBACK_IMAGE_HIJACK_CANVAS_H_
+
+#include "base/macros.h"
+#include "cc/base/cc_export.h"
+#include "third_party/skia/include/utils/SkNWayCanvas.h"
+
+namespace cc {
+
+class ImageDecodeController;
+
+// Forwards all draws to |canvas|, except that the images that the
+// ImageDecodeController has decoded are drawn from its cache instead of being
+// decoded by Skia. The canvas starts out with the matrix and clip of
+// |canvas|, which it has to outlive.
+class CC_EXPORT ImageHijackCanvas : public SkNWayCanvas {
+ public:
+  ImageHijackCanvas(SkCanvas* canvas,
+                    ImageDecodeController* image_decode_controller);
+
+ protected:
+  // Ensure that pictures are unpacked by this canvas, instead of being
+  // forwarded to the raster canvas.
+  void onDrawPicture(const SkPicture* picture,
+                     const SkMatrix* matrix,
+                     const SkPaint* paint) override;
+
+  void onDrawImage(const SkImage* image,
+                   SkScalar x,
+                   SkScalar y,
+                   const SkPaint* paint) override;
+  void onDrawImageRect(const SkImage* image,
+                       const SkRect* src,
+                       const SkRect& dst,
+                       const SkPaint* paint,
+                       SrcRectConstraint constraint) override;
+
+ private:
+  // Draws the |src| rect of |image| into |dst| from |decoded_image|, which may
+  // have been scaled down.
+  void DrawDecodedImageRect(const SkImage* image,
+                            const SkImage* decoded_image,
+                            const SkRect& src,
+                            const SkRect& dst,
+                            const SkPaint* paint,
+                            SrcRectConstraint constraint);
+
+  ImageDecodeController* image_decode_controller_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImageHijackCanvas);
+};
+
+}  // namespace cc
+
+#endif  // CC_PLAYBACK_IMAGE_HIJACK_CANVAS_H_
@@ -6,6 +6,7 @@
 
 #include "base/strings/stringprintf.h"
 #include "base/trace_event/trace_event_argument.h"
+#include "cc/playback/display_item_list_bounds_calculator.h"
 #include "cc/proto/display_item.pb.h"
 #include "cc/proto/gfx_conversions.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -56,6 +57,11 @@ void TransformDisplayItem::AsValueInto(
                                          transform_.ToString().c_str()));
 }
 
+void TransformDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  calculator->AddStartingTransformDisplayItem(SkMatrix(transform_.matrix()));
+}
+
 EndTransformDisplayItem::EndTransformDisplayItem() {
   DisplayItem::SetNew(true /* suitable_for_gpu_raster */, 0 /* op_count */,
                       0 /* external_memory_usage */);
@@ -84,4 +90,9 @@ void EndTransformDisplayItem::AsValueInto(
   array->AppendString("EndTransformDisplayItem");
 }
 
+void EndTransformDisplayItem::ProcessForBounds(
+    DisplayItemListBoundsCalculator* calculator) const {
+  calculator->AddEndingDisplayItem();
+}
+
 }  // namespace cc
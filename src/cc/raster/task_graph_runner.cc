@@ -14,61 +14,6 @@
 namespace cc {
 namespace {
 
-// Helper class for iterating over all dependents of a task.
-class DependentIterator {
- public:
-  DependentIterator(TaskGraph* graph, const Task* task)
-      : graph_(graph),
-        task_(task),
-        current_index_(static_cast<size_t>(-1)),
-        current_node_(NULL) {
-    ++(*this);
-  }
-
-  TaskGraph::Node& operator->() const {
-    DCHECK_LT(current_index_, graph_->edges.size());
-    DCHECK_EQ(graph_->edges[current_index_].task, task_);
-    DCHECK(current_node_);
-    return *current_node_;
-  }
-
-  TaskGraph::Node& operator*() const {
-    DCHECK_LT(current_index_, graph_->edges.size());
-    DCHECK_EQ(graph_->edges[current_index_].task, task_);
-    DCHECK(current_node_);
-    return *current_node_;
-  }
-
-  // Note: Performance can be improved by keeping edges sorted.
-  DependentIterator& operator++() {
-    // Find next dependency edge for |task_|.
-    do {
-      ++current_index_;
-      if (current_index_ == graph_->edges.size())
-        return *this;
-    } while (graph_->edges[current_index_].task != task_);
-
-    // Now find the node for the dependent of this edge.
-    TaskGraph::Node::Vector::iterator it =
-        std::find_if(graph_->nodes.begin(),
-                     graph_->nodes.end(),
-                     TaskGraph::Node::TaskComparator(
-                         graph_->edges[current_index_].dependent));
-    DCHECK(it != graph_->nodes.end());
-    current_node_ = &(*it);
-
-    return *this;
-  }
-
-  operator bool() const { return current_index_ < graph_->edges.size(); }
-
- private:
-  TaskGraph* graph_;
-  const Task* task_;
-  size_t current_index_;
-  TaskGraph::Node* current_node_;
-};
-
 bool DependencyMismatch(const TaskGraph* graph) {
   // Value storage will be 0-initialized.
   base::hash_map<const Task*, size_t> dependents;
@@ -124,6 +69,23 @@ TaskGraphRunner::TaskNamespace::TaskNamespace() {}
 
 TaskGraphRunner::TaskNamespace::~TaskNamespace() {}
 
+// static
+void TaskGraphRunner::BuildDependents(TaskGraph* graph,
+                                      DependentsMap* dependents) {
+  DCHECK(dependents->empty());
+
+  base::hash_map<const Task*, TaskGraph::Node*> nodes;
+  for (TaskGraph::Node& node : graph->nodes)
+    nodes[node.task] = &node;
+
+  for (const TaskGraph::Edge& edge : graph->edges) {
+    base::hash_map<const Task*, TaskGraph::Node*>::iterator it =
+        nodes.find(edge.dependent);
+    DCHECK(it != nodes.end());
+    (*dependents)[edge.task].push_back(it->second);
+  }
+}
+
 TaskGraphRunner::TaskGraphRunner()
     : lock_(),
       has_ready_to_run_tasks_cv_(&lock_),
@@ -166,35 +128,33 @@ void TaskGraphRunner::ScheduleTasks(NamespaceToken token, TaskGraph* graph) {
 
     TaskNamespace& task_namespace = namespaces_[token.id_];
 
+    DependentsMap dependents;
+    BuildDependents(graph, &dependents);
+
     // First adjust number of dependencies to reflect completed tasks.
     for (Task::Vector::iterator it = task_namespace.completed_tasks.begin();
          it != task_namespace.completed_tasks.end();
          ++it) {
-      for (DependentIterator node_it(graph, it->get()); node_it; ++node_it) {
-        TaskGraph::Node& node = *node_it;
-        DCHECK_LT(0u, node.dependencies);
-        node.dependencies--;
+      DependentsMap::iterator dependents_it = dependents.find(it->get());
+      if (dependents_it == dependents.end())
+        continue;
+      for (TaskGraph::Node* node : dependents_it->second) {
+        DCHECK_LT(0u, node->dependencies);
+        node->dependencies--;
       }
     }
 
-    // Build new "ready to run" queue and remove nodes from old graph.
+    // Tasks in the new graph. Tasks of the old graph that are not in this set
+    // are canceled below.
+    base::hash_set<const Task*> new_tasks;
+
+    // Build new "ready to run" queue.
     task_namespace.ready_to_run_tasks.clear();
     for (TaskGraph::Node::Vector::iterator it = graph->nodes.begin();
          it != graph->nodes.end();
          ++it) {
       TaskGraph::Node& node = *it;
-
-      // Remove any old nodes that are associated with this task. The result is
-      // that the old graph is left with all nodes not present in this graph,
-      // which we use below to determine what tasks need to be canceled.
-      TaskGraph::Node::Vector::iterator old_it =
-          std::find_if(task_namespace.graph.nodes.begin(),
-                       task_namespace.graph.nodes.end(),
-                       TaskGraph::Node::TaskComparator(node.task));
-      if (old_it != task_namespace.graph.nodes.end()) {
-        std::swap(*old_it, task_namespace.graph.nodes.back());
-        task_namespace.graph.nodes.pop_back();
-      }
+      new_tasks.insert(node.task);
 
       // Task is not ready to run if dependencies are not yet satisfied.
       if (node.dependencies)
@@ -222,6 +182,7 @@ void TaskGraphRunner::ScheduleTasks(NamespaceToken token, TaskGraph* graph) {
 
     // Swap task graph.
     task_namespace.graph.Swap(graph);
+    task_namespace.dependents.swap(dependents);
 
     // Determine what tasks in old graph need to be canceled.
     for (TaskGraph::Node::Vector::iterator it = graph->nodes.begin();
@@ -229,6 +190,10 @@ void TaskGraphRunner::ScheduleTasks(NamespaceToken token, TaskGraph* graph) {
          ++it) {
       TaskGraph::Node& node = *it;
 
+      // Skip if still part of the new graph.
+      if (new_tasks.count(node.task))
+        continue;
+
       // Skip if already finished running task.
       if (node.task->HasFinishedRunning())
         continue;
@@ -406,8 +371,10 @@ void TaskGraphRunner::RunTaskWithLockAcquired() {
   // Add task to |running_tasks|.
   task_namespace->running_tasks.push_back(task.get());
 
-  // There may be more work available, so wake up another worker thread.
-  has_ready_to_run_tasks_cv_.Signal();
+  // If there is more work available, wake up another worker thread. Workers
+  // that find no work would only contend for |lock_|.
+  if (!ready_to_run_namespaces_.empty())
+    has_ready_to_run_tasks_cv_.Signal();
 
   // Call WillRun() before releasing |lock_| and running task.
   task->WillRun();
@@ -432,16 +399,20 @@ void TaskGraphRunner::RunTaskWithLockAcquired() {
   // Now iterate over all dependents to decrement dependencies and check if they
   // are ready to run.
   bool ready_to_run_namespaces_has_heap_properties = true;
-  for (DependentIterator it(&task_namespace->graph, task.get()); it; ++it) {
-    TaskGraph::Node& dependent_node = *it;
+  DependentsMap::iterator dependents_it =
+      task_namespace->dependents.find(task.get());
+  if (dependents_it != task_namespace->dependents.end()) {
+    for (TaskGraph::Node* dependent_node : dependents_it->second) {
+      DCHECK_LT(0u, dependent_node->dependencies);
+      dependent_node->dependencies--;
+      // Task is ready if it has no dependencies. Add it to
+      // |ready_to_run_tasks_|.
+      if (dependent_node->dependencies)
+        continue;
 
-    DCHECK_LT(0u, dependent_node.dependencies);
-    dependent_node.dependencies--;
-    // Task is ready if it has no dependencies. Add it to |ready_to_run_tasks_|.
-    if (!dependent_node.dependencies) {
       bool was_empty = task_namespace->ready_to_run_tasks.empty();
       task_namespace->ready_to_run_tasks.push_back(
-          PrioritizedTask(dependent_node.task, dependent_node.priority));
+          PrioritizedTask(dependent_node->task, dependent_node->priority));
       std::push_heap(task_namespace->ready_to_run_tasks.begin(),
                      task_namespace->ready_to_run_tasks.end(),
                      CompareTaskPriority);
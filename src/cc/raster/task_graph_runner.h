@@ -8,6 +8,7 @@
 #include <map>
 #include <vector>
 
+#include "base/containers/hash_tables.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/condition_variable.h"
@@ -153,6 +154,10 @@ class CC_EXPORT TaskGraphRunner {
 
   typedef std::vector<const Task*> TaskVector;
 
+  // Maps tasks to the nodes of a graph that depend on them.
+  typedef base::hash_map<const Task*, std::vector<TaskGraph::Node*>>
+      DependentsMap;
+
   struct TaskNamespace {
     typedef std::vector<TaskNamespace*> Vector;
 
@@ -162,6 +167,11 @@ class CC_EXPORT TaskGraphRunner {
     // Current task graph.
     TaskGraph graph;
 
+    // Dependents of each task in |graph|, which point into |graph.nodes|.
+    // Lets a completed task find the nodes to update without searching all
+    // edges and nodes while holding |lock_|.
+    DependentsMap dependents;
+
     // Ordered set of tasks that are ready to run.
     PrioritizedTask::Vector ready_to_run_tasks;
 
@@ -192,6 +202,11 @@ class CC_EXPORT TaskGraphRunner {
                                b->ready_to_run_tasks.front());
   }
 
+  // Fills |dependents| with the dependents of the tasks in |graph|. The
+  // result points into |graph->nodes| and stays valid when |graph| is
+  // swapped.
+  static void BuildDependents(TaskGraph* graph, DependentsMap* dependents);
+
   static bool HasFinishedRunningTasksInNamespace(
       const TaskNamespace* task_namespace) {
     return task_namespace->running_tasks.empty() &&
@@ -28,12 +28,14 @@ Display::Display(DisplayClient* client,
                  SurfaceManager* manager,
                  SharedBitmapManager* bitmap_manager,
                  gpu::GpuMemoryBufferManager* gpu_memory_buffer_manager,
-                 const RendererSettings& settings)
+                 const RendererSettings& settings,
+                 TaskGraphRunner* task_graph_runner)
     : client_(client),
       manager_(manager),
       bitmap_manager_(bitmap_manager),
       gpu_memory_buffer_manager_(gpu_memory_buffer_manager),
       settings_(settings),
+      task_graph_runner_(task_graph_runner),
       device_scale_factor_(1.f),
       swapped_since_resize_(false),
       scheduler_(nullptr),
@@ -120,8 +122,9 @@ void Display::InitializeRenderer() {
       return;
     renderer_ = renderer.Pass();
   } else {
-    scoped_ptr<SoftwareRenderer> renderer = SoftwareRenderer::Create(
-        this, &settings_, output_surface_.get(), resource_provider.get());
+    scoped_ptr<SoftwareRenderer> renderer =
+        SoftwareRenderer::Create(this, &settings_, output_surface_.get(),
+                                 resource_provider.get(), task_graph_runner_);
     if (!renderer)
       return;
     renderer_ = renderer.Pass();
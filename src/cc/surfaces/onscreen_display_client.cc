@@ -20,6 +20,7 @@ OnscreenDisplayClient::OnscreenDisplayClient(
     SharedBitmapManager* bitmap_manager,
     gpu::GpuMemoryBufferManager* gpu_memory_buffer_manager,
     const RendererSettings& settings,
+    TaskGraphRunner* task_graph_runner,
     scoped_refptr<base::SingleThreadTaskRunner> task_runner)
     : output_surface_(output_surface.Pass()),
       task_runner_(task_runner),
@@ -27,7 +28,8 @@ OnscreenDisplayClient::OnscreenDisplayClient(
                            manager,
                            bitmap_manager,
                            gpu_memory_buffer_manager,
-                           settings)),
+                           settings,
+                           task_graph_runner)),
       output_surface_lost_(false),
       disable_display_vsync_(settings.disable_display_vsync) {}
 
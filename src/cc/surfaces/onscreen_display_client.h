@@ -22,6 +22,7 @@ class ContextProvider;
 class DisplayScheduler;
 class SurfaceManager;
 class SurfaceDisplayOutputSurface;
+class TaskGraphRunner;
 
 // This class provides a DisplayClient implementation for drawing directly to an
 // onscreen context.
@@ -34,6 +35,7 @@ class CC_SURFACES_EXPORT OnscreenDisplayClient
       SharedBitmapManager* bitmap_manager,
       gpu::GpuMemoryBufferManager* gpu_memory_buffer_manager,
       const RendererSettings& settings,
+      TaskGraphRunner* task_graph_runner,
       scoped_refptr<base::SingleThreadTaskRunner> task_runner);
   ~OnscreenDisplayClient() override;
 
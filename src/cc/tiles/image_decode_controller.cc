@@ -4,20 +4,81 @@
 
 #include "cc/tiles/image_decode_controller.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "cc/debug/devtools_instrumentation.h"
+#include "skia/ext/image_operations.h"
+#include "third_party/skia/include/core/SkBitmap.h"
 
 namespace cc {
 namespace {
 
+// Scales below one are rounded up to the next of this many steps per power of
+// two, so that a decode is at most 19% larger than needed along each axis.
+const int kScaleStepsPerPowerOfTwo = 4;
+
+// Keeps scales that are a hair above a step, such as the ones that floating
+// point errors make of 0.5, from rounding up to the next step.
+const float kScaleStepEpsilon = 0.001f;
+
+float QuantizeScale(float scale) {
+  float steps = std::floor(-std::log(scale) / std::log(2.f) *
+                               kScaleStepsPerPowerOfTwo +
+                           kScaleStepEpsilon);
+  return std::pow(2.f, -steps / kScaleStepsPerPowerOfTwo);
+}
+
+int ScaledDimension(int dimension, float scale) {
+  if (!(scale > 0.f && scale < 1.f))
+    return dimension;
+  return std::max(1, static_cast<int>(std::ceil(
+                         dimension * QuantizeScale(scale))));
+}
+
+skia::ImageOperations::ResizeMethod ResizeMethodForFilterQuality(
+    SkFilterQuality filter_quality) {
+  // Medium quality draws from mipmaps, which are box filtered.
+  if (filter_quality == kMedium_SkFilterQuality)
+    return skia::ImageOperations::RESIZE_BOX;
+  return skia::ImageOperations::RESIZE_LANCZOS3;
+}
+
+skia::RefPtr<SkImage> DecodeAndScaleImage(const ImageDecodeControllerKey& key,
+                                          const SkImage* image) {
+  SkImageInfo info = SkImageInfo::MakeN32(
+      image->width(), image->height(),
+      image->isOpaque() ? kOpaque_SkAlphaType : kPremul_SkAlphaType);
+  SkBitmap bitmap;
+  if (!bitmap.tryAllocPixels(info) ||
+      !image->readPixels(info, bitmap.getPixels(), bitmap.rowBytes(), 0, 0)) {
+    return skia::RefPtr<SkImage>();
+  }
+
+  // Only scaled down decodes are cached.
+  const gfx::Size& target_size = key.target_size();
+  DCHECK(target_size != gfx::Size(image->width(), image->height()));
+  bitmap = skia::ImageOperations::Resize(
+      bitmap, ResizeMethodForFilterQuality(key.filter_quality()),
+      target_size.width(), target_size.height());
+  if (bitmap.isNull())
+    return skia::RefPtr<SkImage>();
+
+  bitmap.setImmutable();
+  return skia::AdoptRef(SkImage::NewFromBitmap(bitmap));
+}
+
 class ImageDecodeTaskImpl : public ImageDecodeTask {
  public:
   ImageDecodeTaskImpl(ImageDecodeController* controller,
                       const SkImage* image,
-                      int layer_id,
+                      const ImageDecodeControllerKey& key,
+                      bool decode_into_cache,
                       uint64_t source_prepare_tiles_id)
       : controller_(controller),
         image_(skia::SharePtr(image)),
-        layer_id_(layer_id),
+        key_(key),
+        decode_into_cache_(decode_into_cache),
         source_prepare_tiles_id_(source_prepare_tiles_id) {}
 
   // Overridden from Task:
@@ -26,7 +87,10 @@ class ImageDecodeTaskImpl : public ImageDecodeTask {
                  "source_prepare_tiles_id", source_prepare_tiles_id_);
     devtools_instrumentation::ScopedImageDecodeTask image_decode_task(
         image_.get());
-    controller_->DecodeImage(image_.get());
+    if (decode_into_cache_)
+      controller_->DecodeImageIntoCache(key_, image_.get());
+    else
+      controller_->DecodeImage(image_.get());
 
     // Release the reference after decoding image to ensure that it is not kept
     // alive unless needed.
@@ -36,8 +100,13 @@ class ImageDecodeTaskImpl : public ImageDecodeTask {
   // Overridden from TileTask:
   void ScheduleOnOriginThread(TileTaskClient* client) override {}
   void CompleteOnOriginThread(TileTaskClient* client) override {
-    controller_->OnImageDecodeTaskCompleted(layer_id_, image_.get(),
-                                            !HasFinishedRunning());
+    if (decode_into_cache_) {
+      controller_->OnCachedImageDecodeTaskCompleted(key_,
+                                                    !HasFinishedRunning());
+    } else {
+      controller_->OnImageDecodeTaskCompleted(key_.image_id(),
+                                              !HasFinishedRunning());
+    }
   }
 
  protected:
@@ -46,7 +115,8 @@ class ImageDecodeTaskImpl : public ImageDecodeTask {
  private:
   ImageDecodeController* controller_;
   skia::RefPtr<const SkImage> image_;
-  int layer_id_;
+  const ImageDecodeControllerKey key_;
+  const bool decode_into_cache_;
   uint64_t source_prepare_tiles_id_;
 
   DISALLOW_COPY_AND_ASSIGN(ImageDecodeTaskImpl);
@@ -54,67 +124,230 @@ class ImageDecodeTaskImpl : public ImageDecodeTask {
 
 }  // namespace
 
-ImageDecodeController::ImageDecodeController() {}
+// static
+ImageDecodeControllerKey ImageDecodeControllerKey::FromDrawImage(
+    const DrawImage& image) {
+  gfx::Size original_size(image.image()->width(), image.image()->height());
+  SkFilterQuality filter_quality = image.filter_quality();
 
-ImageDecodeController::~ImageDecodeController() {}
+  // Only the filter qualities that Skia filters images with when it scales
+  // them down are applied ahead of time. Pixels for the other qualities are
+  // sampled from the original image.
+  if (filter_quality < kMedium_SkFilterQuality) {
+    return ImageDecodeControllerKey(image.image()->uniqueID(), original_size,
+                                    kNone_SkFilterQuality);
+  }
+
+  gfx::Size target_size(
+      ScaledDimension(original_size.width(), std::abs(image.scale().width())),
+      ScaledDimension(original_size.height(),
+                      std::abs(image.scale().height())));
+  if (target_size == original_size)
+    filter_quality = kNone_SkFilterQuality;
+  return ImageDecodeControllerKey(image.image()->uniqueID(), target_size,
+                                  filter_quality);
+}
+
+ImageDecodeControllerKey::ImageDecodeControllerKey(
+    uint32_t image_id,
+    const gfx::Size& target_size,
+    SkFilterQuality filter_quality)
+    : image_id_(image_id),
+      target_size_(target_size),
+      filter_quality_(filter_quality) {}
+
+bool ImageDecodeControllerKey::operator<(
+    const ImageDecodeControllerKey& other) const {
+  if (image_id_ != other.image_id_)
+    return image_id_ < other.image_id_;
+  if (target_size_.width() != other.target_size_.width())
+    return target_size_.width() < other.target_size_.width();
+  if (target_size_.height() != other.target_size_.height())
+    return target_size_.height() < other.target_size_.height();
+  return filter_quality_ < other.filter_quality_;
+}
+
+size_t ImageDecodeControllerKey::target_bytes() const {
+  return static_cast<size_t>(target_size_.width()) * target_size_.height() *
+         sizeof(SkPMColor);
+}
+
+ImageDecodeController::DecodedImage::DecodedImage()
+    : ref_count(0), decode_failed(false) {}
+
+ImageDecodeController::DecodedImage::~DecodedImage() {}
+
+ImageDecodeController::ImageDecodeController()
+    : decoded_images_(DecodedImageCache::NO_AUTO_EVICT),
+      memory_usage_bytes_(0),
+      locked_memory_usage_bytes_(0),
+      memory_limit_bytes_(0) {}
 
-scoped_refptr<ImageDecodeTask> ImageDecodeController::GetTaskForImage(
+ImageDecodeController::~ImageDecodeController() {
+  DCHECK_EQ(0u, locked_memory_usage_bytes_);
+}
+
+bool ImageDecodeController::GetTaskForImageAndRef(
     const DrawImage& image,
-    int layer_id,
-    uint64_t prepare_tiles_id) {
-  uint32_t generation_id = image.image()->uniqueID();
-  scoped_refptr<ImageDecodeTask>& decode_task =
-      image_decode_tasks_[layer_id][generation_id];
-  if (!decode_task)
-    decode_task = CreateTaskForImage(image.image(), layer_id, prepare_tiles_id);
-  return decode_task;
+    uint64_t prepare_tiles_id,
+    scoped_refptr<ImageDecodeTask>* task) {
+  ImageDecodeControllerKey key = ImageDecodeControllerKey::FromDrawImage(image);
+
+  base::AutoLock lock(lock_);
+  DecodedImageCache::iterator it = decoded_images_.end();
+  if (!key.can_use_original_decode()) {
+    it = decoded_images_.Get(key);
+    if (it == decoded_images_.end() &&
+        locked_memory_usage_bytes_ + key.target_bytes() <=
+            memory_limit_bytes_) {
+      it = decoded_images_.Put(key, new DecodedImage);
+      memory_usage_bytes_ += key.target_bytes();
+    }
+  }
+
+  if (it == decoded_images_.end()) {
+    // A copy of the original size decode would only duplicate Skia's, and
+    // scaled images that do not fit are scaled from it at raster. Either way
+    // the image is just prerolled into Skia's discardable memory.
+    scoped_refptr<ImageDecodeTask>& decode_task =
+        uncached_decode_tasks_[key.image_id()];
+    if (!decode_task) {
+      decode_task = make_scoped_refptr(new ImageDecodeTaskImpl(
+          this, image.image(), key, false, prepare_tiles_id));
+    }
+    *task = decode_task;
+    return false;
+  }
+
+  DecodedImage* decoded_image = it->second;
+  if (decoded_image->decode_failed) {
+    *task = nullptr;
+    return false;
+  }
+
+  RefImage(key, decoded_image);
+  if (!decoded_image->image && !decoded_image->decode_task) {
+    // The task holds a reference of its own, so that the image stays in the
+    // cache until it has been decoded even if every raster task is canceled.
+    decoded_image->decode_task = make_scoped_refptr(new ImageDecodeTaskImpl(
+        this, image.image(), key, true, prepare_tiles_id));
+    RefImage(key, decoded_image);
+  }
+  *task = decoded_image->decode_task;
+
+  // Adding the image might have pushed unlocked images over the limit.
+  ReduceCacheUsage();
+  return true;
 }
 
-scoped_refptr<ImageDecodeTask> ImageDecodeController::CreateTaskForImage(
-    const SkImage* image,
-    int layer_id,
-    uint64_t prepare_tiles_id) {
-  return make_scoped_refptr(
-      new ImageDecodeTaskImpl(this, image, layer_id, prepare_tiles_id));
+void ImageDecodeController::UnrefImage(const DrawImage& image) {
+  ImageDecodeControllerKey key = ImageDecodeControllerKey::FromDrawImage(image);
+
+  base::AutoLock lock(lock_);
+  DecodedImageCache::iterator it = decoded_images_.Peek(key);
+  DCHECK(it != decoded_images_.end());
+  UnrefImage(key, it->second);
+  ReduceCacheUsage();
+}
+
+skia::RefPtr<SkImage> ImageDecodeController::GetDecodedImageForDraw(
+    const DrawImage& image) {
+  ImageDecodeControllerKey key = ImageDecodeControllerKey::FromDrawImage(image);
+  if (key.can_use_original_decode())
+    return skia::RefPtr<SkImage>();
+
+  base::AutoLock lock(lock_);
+  DecodedImageCache::iterator it = decoded_images_.Peek(key);
+  if (it == decoded_images_.end())
+    return skia::RefPtr<SkImage>();
+  return it->second->image;
 }
 
 void ImageDecodeController::DecodeImage(const SkImage* image) {
   image->preroll();
 }
 
-void ImageDecodeController::AddLayerUsedCount(int layer_id) {
-  ++used_layer_counts_[layer_id];
-}
+void ImageDecodeController::DecodeImageIntoCache(
+    const ImageDecodeControllerKey& key,
+    const SkImage* image) {
+  TRACE_EVENT2("cc", "ImageDecodeController::DecodeImageIntoCache", "width",
+               key.target_size().width(), "height",
+               key.target_size().height());
 
-void ImageDecodeController::SubtractLayerUsedCount(int layer_id) {
-  if (--used_layer_counts_[layer_id])
-    return;
+  // The decode task holds a reference on the image, so it is not evicted
+  // while the lock is released.
+  skia::RefPtr<SkImage> decoded_image = DecodeAndScaleImage(key, image);
 
-  // Clean up decode tasks once a layer is no longer used.
-  used_layer_counts_.erase(layer_id);
-  image_decode_tasks_.erase(layer_id);
+  base::AutoLock lock(lock_);
+  DecodedImageCache::iterator it = decoded_images_.Peek(key);
+  DCHECK(it != decoded_images_.end());
+  DCHECK(!it->second->image);
+  if (decoded_image)
+    it->second->image = decoded_image;
+  else
+    it->second->decode_failed = true;
 }
 
-void ImageDecodeController::OnImageDecodeTaskCompleted(int layer_id,
-                                                       const SkImage* image,
+void ImageDecodeController::OnImageDecodeTaskCompleted(uint32_t image_id,
                                                        bool was_canceled) {
-  // If the task has successfully finished, then keep the task until the layer
-  // is no longer in use. This ensures that we only decode a image once.
-  // TODO(vmpstr): Remove this when decode lifetime is controlled by cc.
-  if (!was_canceled)
-    return;
-
-  // Otherwise, we have to clean up the task so that a new one can be created if
-  // we need to decode the image again.
-  LayerImageTaskMap::iterator layer_it = image_decode_tasks_.find(layer_id);
-  if (layer_it == image_decode_tasks_.end())
-    return;
-
-  ImageTaskMap& image_tasks = layer_it->second;
-  ImageTaskMap::iterator task_it = image_tasks.find(image->uniqueID());
-  if (task_it == image_tasks.end())
-    return;
-  image_tasks.erase(task_it);
+  base::AutoLock lock(lock_);
+  uncached_decode_tasks_.erase(image_id);
+}
+
+void ImageDecodeController::OnCachedImageDecodeTaskCompleted(
+    const ImageDecodeControllerKey& key,
+    bool was_canceled) {
+  base::AutoLock lock(lock_);
+  DecodedImageCache::iterator it = decoded_images_.Peek(key);
+  DCHECK(it != decoded_images_.end());
+
+  // If the task was canceled, a new one is created the next time a raster
+  // task needs the image.
+  DecodedImage* decoded_image = it->second;
+  DCHECK(decoded_image->decode_task);
+  decoded_image->decode_task = nullptr;
+  UnrefImage(key, decoded_image);
+  ReduceCacheUsage();
+}
+
+void ImageDecodeController::SetMemoryLimit(size_t limit_bytes) {
+  base::AutoLock lock(lock_);
+  memory_limit_bytes_ = limit_bytes;
+  ReduceCacheUsage();
+}
+
+size_t ImageDecodeController::GetMemoryUsageBytesForTesting() const {
+  base::AutoLock lock(lock_);
+  return memory_usage_bytes_;
+}
+
+void ImageDecodeController::RefImage(const ImageDecodeControllerKey& key,
+                                     DecodedImage* decoded_image) {
+  lock_.AssertAcquired();
+  if (!decoded_image->ref_count++)
+    locked_memory_usage_bytes_ += key.target_bytes();
+}
+
+void ImageDecodeController::UnrefImage(const ImageDecodeControllerKey& key,
+                                       DecodedImage* decoded_image) {
+  lock_.AssertAcquired();
+  DCHECK_GT(decoded_image->ref_count, 0);
+  if (!--decoded_image->ref_count)
+    locked_memory_usage_bytes_ -= key.target_bytes();
+}
+
+void ImageDecodeController::ReduceCacheUsage() {
+  lock_.AssertAcquired();
+  DecodedImageCache::reverse_iterator it = decoded_images_.rbegin();
+  while (memory_usage_bytes_ > memory_limit_bytes_ &&
+         it != decoded_images_.rend()) {
+    if (it->second->ref_count) {
+      ++it;
+      continue;
+    }
+    memory_usage_bytes_ -= it->first.target_bytes();
+    it = decoded_images_.Erase(it);
+  }
 }
 
 }  // namespace cc
@@ -6,46 +6,146 @@
 #define CC_TILES_IMAGE_DECODE_CONTROLLER_H_
 
 #include "base/containers/hash_tables.h"
+#include "base/containers/mru_cache.h"
 #include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
 #include "cc/base/cc_export.h"
 #include "cc/playback/discardable_image_map.h"
 #include "cc/raster/tile_task_runner.h"
 #include "skia/ext/refptr.h"
+#include "ui/gfx/geometry/size.h"
 
 namespace cc {
 
-class ImageDecodeController {
+// Identifies a decoded version of an image. Images drawn with medium or high
+// filter quality at a scale below one are decoded at a smaller size, which is
+// the original size times the scale rounded up to one of a few steps per
+// power of two, so that nearby scales share a decode. All other images use
+// the original size decode, and have no filter quality in their key.
+class CC_EXPORT ImageDecodeControllerKey {
+ public:
+  static ImageDecodeControllerKey FromDrawImage(const DrawImage& image);
+
+  bool operator==(const ImageDecodeControllerKey& other) const {
+    return image_id_ == other.image_id_ &&
+           target_size_ == other.target_size_ &&
+           filter_quality_ == other.filter_quality_;
+  }
+  bool operator<(const ImageDecodeControllerKey& other) const;
+
+  uint32_t image_id() const { return image_id_; }
+  const gfx::Size& target_size() const { return target_size_; }
+  SkFilterQuality filter_quality() const { return filter_quality_; }
+
+  // True if the image is drawn from its original size decode, which Skia
+  // already keeps in discardable memory.
+  bool can_use_original_decode() const {
+    return filter_quality_ == kNone_SkFilterQuality;
+  }
+
+  // The number of bytes of the decoded image.
+  size_t target_bytes() const;
+
+ private:
+  ImageDecodeControllerKey(uint32_t image_id,
+                           const gfx::Size& target_size,
+                           SkFilterQuality filter_quality);
+
+  uint32_t image_id_;
+  gfx::Size target_size_;
+  SkFilterQuality filter_quality_;
+};
+
+// Decodes the images that tiles depend on ahead of raster. Images that are
+// drawn scaled down are kept in a cache of its own at their target size, and
+// all others are only prerolled into Skia's discardable memory, which holds
+// the original size decode anyway. Raster tasks lock the cached images they
+// draw by holding a reference on them from the time the task is created until
+// it completes. Images that are not locked stay in the cache until it
+// exceeds the memory limit, which evicts the least recently used ones.
+// Images that would push the locked images over the limit are not cached
+// either, and raster scales them from Skia's original size decode.
+class CC_EXPORT ImageDecodeController {
  public:
   ImageDecodeController();
   ~ImageDecodeController();
 
-  scoped_refptr<ImageDecodeTask> GetTaskForImage(const DrawImage& image,
-                                                 int layer_id,
-                                                 uint64_t prepare_tiles_id);
+  // Locks the decoded version of |image| in the cache and returns true if it
+  // is used, in which case UnrefImage() has to be called once raster no
+  // longer needs it. Sets |task| to the task that decodes the image if it
+  // still has to be decoded, or to null.
+  bool GetTaskForImageAndRef(const DrawImage& image,
+                             uint64_t prepare_tiles_id,
+                             scoped_refptr<ImageDecodeTask>* task);
+  void UnrefImage(const DrawImage& image);
+
+  // Returns the decoded version of |image|, or null if there is none and
+  // |image| should be drawn as it is. The decoded image may be smaller than
+  // |image|, in which case it has already been filtered and only needs to be
+  // scaled by the rest of the draw's scale. Called during raster, so this has
+  // to remain thread safe.
+  skia::RefPtr<SkImage> GetDecodedImageForDraw(const DrawImage& image);
 
-  // Note that this function has to remain thread safe.
+  // Note that these functions have to remain thread safe.
   void DecodeImage(const SkImage* image);
+  void DecodeImageIntoCache(const ImageDecodeControllerKey& key,
+                            const SkImage* image);
 
-  // TODO(vmpstr): This should go away once the controller is decoding images
-  // based on priority and memory.
-  void AddLayerUsedCount(int layer_id);
-  void SubtractLayerUsedCount(int layer_id);
+  void OnImageDecodeTaskCompleted(uint32_t image_id, bool was_canceled);
+  void OnCachedImageDecodeTaskCompleted(const ImageDecodeControllerKey& key,
+                                        bool was_canceled);
 
-  void OnImageDecodeTaskCompleted(int layer_id,
-                                  const SkImage* image,
-                                  bool was_canceled);
+  // Sets the number of bytes that the decoded images may use. Unlocked images
+  // are evicted until they fit, and new images are only decoded into the
+  // cache while the locked ones fit.
+  void SetMemoryLimit(size_t limit_bytes);
+
+  size_t GetMemoryUsageBytesForTesting() const;
 
  private:
-  scoped_refptr<ImageDecodeTask> CreateTaskForImage(const SkImage* image,
-                                                    int layer_id,
-                                                    uint64_t prepare_tiles_id);
+  struct DecodedImage {
+    DecodedImage();
+    ~DecodedImage();
+
+    // Null until the image has been decoded.
+    skia::RefPtr<SkImage> image;
+
+    // The pending task that decodes |image|, if any.
+    scoped_refptr<ImageDecodeTask> decode_task;
+
+    // The number of raster tasks and decode tasks that use the image. The
+    // image is not evicted while this is not zero.
+    int ref_count;
+
+    bool decode_failed;
+  };
+
+  using DecodedImageCache =
+      base::OwningMRUCache<ImageDecodeControllerKey, DecodedImage*>;
+
+  void RefImage(const ImageDecodeControllerKey& key,
+                DecodedImage* decoded_image);
+  void UnrefImage(const ImageDecodeControllerKey& key,
+                  DecodedImage* decoded_image);
+  void ReduceCacheUsage();
+
+  // Protects all of the state below, which the decode and raster tasks
+  // access from worker threads.
+  mutable base::Lock lock_;
+
+  DecodedImageCache decoded_images_;
+
+  // The bytes of all of |decoded_images_|, and of those that are locked.
+  size_t memory_usage_bytes_;
+  size_t locked_memory_usage_bytes_;
+  size_t memory_limit_bytes_;
 
+  // Pending tasks that decode images that do not fit into the cache. These
+  // only warm up Skia's discardable memory cache.
   using ImageTaskMap = base::hash_map<uint32_t, scoped_refptr<ImageDecodeTask>>;
-  using LayerImageTaskMap = base::hash_map<int, ImageTaskMap>;
-  LayerImageTaskMap image_decode_tasks_;
+  ImageTaskMap uncached_decode_tasks_;
 
-  using LayerCountMap = base::hash_map<int, int>;
-  LayerCountMap used_layer_counts_;
+  DISALLOW_COPY_AND_ASSIGN(ImageDecodeController);
 };
 
 }  // namespace cc
@@ -31,6 +31,10 @@ namespace {
 // a tile is of solid color.
 const bool kUseColorEstimator = true;
 
+// Decoded images may use up to this fraction of the memory that the tiles may
+// use, in addition to it.
+const int kDecodedImageMemoryLimitDivisor = 2;
+
 DEFINE_SCOPED_UMA_HISTOGRAM_AREA_TIMER(
     ScopedRasterTaskTimer,
     "Compositing.%s.RasterTask.RasterUs",
@@ -240,6 +244,9 @@ void TileManager::FinishTasksAndCleanUp() {
   FreeResourcesForReleasedTiles();
   CleanUpReleasedTiles();
 
+  // All raster tasks have completed, so no decoded image is locked.
+  image_decode_controller_.SetMemoryLimit(0);
+
   tile_task_runner_ = nullptr;
   resource_pool_ = nullptr;
   more_tiles_need_prepare_check_notifier_.Cancel();
@@ -279,7 +286,6 @@ void TileManager::CleanUpReleasedTiles() {
     DCHECK(tiles_.find(tile->id()) != tiles_.end());
     tiles_.erase(tile->id());
 
-    image_decode_controller_.SubtractLayerUsedCount(tile->layer_id());
     delete tile;
   }
   released_tiles_.swap(tiles_to_retain);
@@ -340,6 +346,11 @@ bool TileManager::PrepareTiles(
 
   signals_.reset();
   global_state_ = state;
+  image_decode_controller_.SetMemoryLimit(
+      global_state_.memory_limit_policy == ALLOW_NOTHING
+          ? 0
+          : global_state_.soft_memory_limit_in_bytes /
+                kDecodedImageMemoryLimitDivisor);
 
   // We need to call CheckForCompletedTasks() once in-between each call
   // to ScheduleTasks() to prevent canceled tasks from being scheduled.
@@ -678,14 +689,21 @@ scoped_refptr<RasterTask> TileManager::CreateRasterTask(
                                                DetermineResourceFormat(tile));
   }
 
-  // Create and queue all image decode tasks that this tile depends on.
+  // Create and queue all image decode tasks that this tile depends on, and
+  // lock the decoded images until the raster task completes.
   ImageDecodeTask::Vector decode_tasks;
   std::vector<DrawImage> images;
+  std::vector<DrawImage> locked_images;
   prioritized_tile.raster_source()->GetDiscardableImagesInRect(
       tile->enclosing_layer_rect(), tile->contents_scale(), &images);
   for (const auto& image : images) {
-    decode_tasks.push_back(image_decode_controller_.GetTaskForImage(
-        image, tile->layer_id(), prepare_tiles_count_));
+    scoped_refptr<ImageDecodeTask> decode_task;
+    if (image_decode_controller_.GetTaskForImageAndRef(
+            image, prepare_tiles_count_, &decode_task)) {
+      locked_images.push_back(image);
+    }
+    if (decode_task)
+      decode_tasks.push_back(decode_task);
   }
 
   return make_scoped_refptr(new RasterTaskImpl(
@@ -696,17 +714,21 @@ scoped_refptr<RasterTask> TileManager::CreateRasterTask(
       tile->invalidated_id(), resource_content_id, tile->source_frame_number(),
       tile->use_picture_analysis(),
       base::Bind(&TileManager::OnRasterTaskCompleted, base::Unretained(this),
-                 tile->id(), resource),
+                 tile->id(), resource, locked_images),
       &decode_tasks));
 }
 
 void TileManager::OnRasterTaskCompleted(
     Tile::Id tile_id,
     Resource* resource,
+    const std::vector<DrawImage>& locked_images,
     const DisplayListRasterSource::SolidColorAnalysis& analysis,
     bool was_canceled) {
   DCHECK(tiles_.find(tile_id) != tiles_.end());
 
+  for (const auto& image : locked_images)
+    image_decode_controller_.UnrefImage(image);
+
   Tile* tile = tiles_[tile_id];
   DCHECK(tile->raster_task_.get());
   orphan_raster_tasks_.push_back(tile->raster_task_);
@@ -766,7 +788,6 @@ ScopedTilePtr TileManager::CreateTile(const Tile::CreateInfo& info,
   DCHECK(tiles_.find(tile->id()) == tiles_.end());
 
   tiles_[tile->id()] = tile.get();
-  image_decode_controller_.AddLayerUsedCount(tile->layer_id());
   return tile;
 }
 
@@ -149,6 +149,12 @@ class CC_EXPORT TileManager : public TileTaskRunnerClient {
     return memory_stats_from_last_assign_;
   }
 
+  // The controller that decodes the images of the tiles. Raster sources draw
+  // from it once they have been given it.
+  ImageDecodeController* image_decode_controller() {
+    return &image_decode_controller_;
+  }
+
   // Public methods for testing.
   void InitializeTilesWithResourcesForTesting(const std::vector<Tile*>& tiles) {
     for (size_t i = 0; i < tiles.size(); ++i) {
@@ -256,6 +262,7 @@ class CC_EXPORT TileManager : public TileTaskRunnerClient {
   void OnRasterTaskCompleted(
       Tile::Id tile,
       Resource* resource,
+      const std::vector<DrawImage>& locked_images,
       const DisplayListRasterSource::SolidColorAnalysis& analysis,
       bool was_canceled);
   void UpdateTileDrawInfo(
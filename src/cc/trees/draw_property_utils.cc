@@ -446,14 +446,33 @@ static void ResetIfHasNanCoordinate(gfx::RectF* rect) {
     *rect = gfx::RectF();
 }
 
-void ComputeClips(ClipTree* clip_tree,
+static bool TransformChanged(const TransformTree& transform_tree, int id) {
+  const TransformNode* node = transform_tree.Node(id);
+  return node && node->data.transform_changed;
+}
+
+bool ComputeClips(ClipTree* clip_tree,
                   const TransformTree& transform_tree,
+                  bool transforms_changed,
                   bool non_root_surfaces_enabled) {
-  if (!clip_tree->needs_update())
-    return;
+  bool needs_full_update = clip_tree->needs_update();
+  if (!needs_full_update && !transforms_changed)
+    return false;
+  // When only transforms have changed, a clip node needs to be recomputed if
+  // the transform node that defines its space or its target changed, or if its
+  // parent clip node was recomputed.
+  if (clip_tree->size() > 0)
+    clip_tree->Node(0)->data.clip_changed = needs_full_update;
   for (int i = 1; i < static_cast<int>(clip_tree->size()); ++i) {
     ClipNode* clip_node = clip_tree->Node(i);
 
+    clip_node->data.clip_changed =
+        needs_full_update || clip_tree->parent(clip_node)->data.clip_changed ||
+        TransformChanged(transform_tree, clip_node->data.transform_id) ||
+        TransformChanged(transform_tree, clip_node->data.target_id);
+    if (!clip_node->data.clip_changed)
+      continue;
+
     if (clip_node->id == 1) {
       ResetIfHasNanCoordinate(&clip_node->data.clip);
       clip_node->data.clip_in_target_space = clip_node->data.clip;
@@ -583,22 +602,68 @@ void ComputeClips(ClipTree* clip_tree,
     ResetIfHasNanCoordinate(&clip_node->data.combined_clip_in_target_space);
   }
   clip_tree->set_needs_update(false);
+  return true;
 }
 
-void ComputeTransforms(TransformTree* transform_tree) {
+bool ComputeTransforms(TransformTree* transform_tree) {
   if (!transform_tree->needs_update())
-    return;
+    return false;
   for (int i = 1; i < static_cast<int>(transform_tree->size()); ++i)
     transform_tree->UpdateTransforms(i);
   transform_tree->set_needs_update(false);
+  return true;
 }
 
-void ComputeOpacities(EffectTree* effect_tree) {
+bool ComputeOpacities(EffectTree* effect_tree) {
   if (!effect_tree->needs_update())
-    return;
+    return false;
   for (int i = 1; i < static_cast<int>(effect_tree->size()); ++i)
     effect_tree->UpdateOpacities(i);
   effect_tree->set_needs_update(false);
+  return true;
+}
+
+// Layers on the main thread are always recomputed. Nearly every change to them
+// rebuilds the property trees anyway.
+static bool LayerNeedsUpdate(Layer* layer,
+                             const PropertyTrees& property_trees,
+                             bool transforms_changed,
+                             bool clips_changed,
+                             bool effects_changed) {
+  return true;
+}
+
+static void SetLayerUpdateNumber(Layer* layer, int update_number) {}
+
+// A layer's visible rect and draw properties only depend on its own
+// properties, on its transform, clip and effect nodes, and on nodes that
+// these are recomputed for when they change: their ancestors and targets.
+static bool LayerNeedsUpdate(LayerImpl* layer,
+                             const PropertyTrees& property_trees,
+                             bool transforms_changed,
+                             bool clips_changed,
+                             bool effects_changed) {
+  // Layers with copy requests are visible in full, so the previous result
+  // can't be reused once the requests are taken.
+  if (property_trees.layers_need_full_update ||
+      layer->property_trees_update_number() !=
+          property_trees.layer_update_number - 1 ||
+      layer->LayerPropertyChanged() || layer->HasCopyRequest())
+    return true;
+
+  const TransformNode* transform_node =
+      property_trees.transform_tree.Node(layer->transform_tree_index());
+  const ClipNode* clip_node =
+      property_trees.clip_tree.Node(layer->clip_tree_index());
+  const EffectNode* effect_node =
+      property_trees.effect_tree.Node(layer->effect_tree_index());
+  return (transforms_changed && transform_node->data.transform_changed) ||
+         (clips_changed && clip_node->data.clip_changed) ||
+         (effects_changed && effect_node->data.effect_changed);
+}
+
+static void SetLayerUpdateNumber(LayerImpl* layer, int update_number) {
+  layer->set_property_trees_update_number(update_number);
 }
 
 template <typename LayerType>
@@ -607,25 +672,37 @@ void ComputeVisibleRectsUsingPropertyTreesInternal(
     PropertyTrees* property_trees,
     bool can_render_to_separate_surface,
     typename LayerType::LayerListType* update_layer_list,
-    std::vector<LayerType*>* visible_layer_list) {
+    std::vector<LayerType*>* visible_layer_list,
+    std::vector<LayerType*>* changed_layer_list) {
   if (property_trees->non_root_surfaces_enabled !=
       can_render_to_separate_surface) {
     property_trees->non_root_surfaces_enabled = can_render_to_separate_surface;
-    property_trees->transform_tree.set_needs_update(true);
-  }
-  if (property_trees->transform_tree.needs_update())
     property_trees->clip_tree.set_needs_update(true);
-  ComputeTransforms(&property_trees->transform_tree);
-  ComputeClips(&property_trees->clip_tree, property_trees->transform_tree,
-               can_render_to_separate_surface);
-  ComputeOpacities(&property_trees->effect_tree);
+    property_trees->layers_need_full_update = true;
+  }
+  bool transforms_changed =
+      ComputeTransforms(&property_trees->transform_tree);
+  bool clips_changed =
+      ComputeClips(&property_trees->clip_tree, property_trees->transform_tree,
+                   transforms_changed, can_render_to_separate_surface);
+  bool effects_changed = ComputeOpacities(&property_trees->effect_tree);
 
   const bool subtree_is_visible_from_ancestor = true;
   FindLayersThatNeedUpdates(root_layer, property_trees->transform_tree,
                             subtree_is_visible_from_ancestor, update_layer_list,
                             visible_layer_list);
+
+  int update_number = ++property_trees->layer_update_number;
+  for (LayerType* layer : *visible_layer_list) {
+    if (LayerNeedsUpdate(layer, *property_trees, transforms_changed,
+                         clips_changed, effects_changed))
+      changed_layer_list->push_back(layer);
+    SetLayerUpdateNumber(layer, update_number);
+  }
+  property_trees->layers_need_full_update = false;
+
   CalculateVisibleRects<LayerType>(
-      *visible_layer_list, property_trees->clip_tree,
+      *changed_layer_list, property_trees->clip_tree,
       property_trees->transform_tree, can_render_to_separate_surface);
 }
 
@@ -661,14 +738,15 @@ void BuildPropertyTreesAndComputeVisibleRects(
     const gfx::Transform& device_transform,
     bool can_render_to_separate_surface,
     PropertyTrees* property_trees,
-    LayerImplList* visible_layer_list) {
+    LayerImplList* visible_layer_list,
+    LayerImplList* changed_layer_list) {
   PropertyTreeBuilder::BuildPropertyTrees(
       root_layer, page_scale_layer, inner_viewport_scroll_layer,
       outer_viewport_scroll_layer, page_scale_factor, device_scale_factor,
       viewport, device_transform, property_trees);
-  ComputeVisibleRectsUsingPropertyTrees(root_layer, property_trees,
-                                        can_render_to_separate_surface,
-                                        visible_layer_list);
+  ComputeVisibleRectsUsingPropertyTrees(
+      root_layer, property_trees, can_render_to_separate_surface,
+      visible_layer_list, changed_layer_list);
 }
 
 void ComputeVisibleRectsUsingPropertyTrees(Layer* root_layer,
@@ -676,19 +754,21 @@ void ComputeVisibleRectsUsingPropertyTrees(Layer* root_layer,
                                            bool can_render_to_separate_surface,
                                            LayerList* update_layer_list) {
   std::vector<Layer*> visible_layer_list;
+  std::vector<Layer*> changed_layer_list;
   ComputeVisibleRectsUsingPropertyTreesInternal(
       root_layer, property_trees, can_render_to_separate_surface,
-      update_layer_list, &visible_layer_list);
+      update_layer_list, &visible_layer_list, &changed_layer_list);
 }
 
 void ComputeVisibleRectsUsingPropertyTrees(LayerImpl* root_layer,
                                            PropertyTrees* property_trees,
                                            bool can_render_to_separate_surface,
-                                           LayerImplList* visible_layer_list) {
+                                           LayerImplList* visible_layer_list,
+                                           LayerImplList* changed_layer_list) {
   LayerImplList update_layer_list;
   ComputeVisibleRectsUsingPropertyTreesInternal(
       root_layer, property_trees, can_render_to_separate_surface,
-      &update_layer_list, visible_layer_list);
+      &update_layer_list, visible_layer_list, changed_layer_list);
 }
 
 template <typename LayerType>
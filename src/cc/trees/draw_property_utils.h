@@ -26,17 +26,25 @@ class TransformTree;
 class PropertyTrees;
 
 // Computes combined clips for every node in |clip_tree|. This function requires
-// that |transform_tree| has been updated via |ComputeTransforms|.
-void CC_EXPORT ComputeClips(ClipTree* clip_tree,
+// that |transform_tree| has been updated via |ComputeTransforms|. If the clip
+// tree itself doesn't need an update, only the clips that depend on transforms
+// changed by that update are recomputed, and only if |transforms_changed|.
+// Returns false if no clip was recomputed.
+bool CC_EXPORT ComputeClips(ClipTree* clip_tree,
                             const TransformTree& transform_tree,
+                            bool transforms_changed,
                             bool non_root_surfaces_enabled);
 
-// Computes combined (screen space) transforms for every node in the transform
-// tree. This must be done prior to calling |ComputeClips|.
-void CC_EXPORT ComputeTransforms(TransformTree* transform_tree);
+// Computes combined (screen space) transforms for the nodes in the transform
+// tree whose local transform, or the transform of an ancestor or target, has
+// changed since the last update. This must be done prior to calling
+// |ComputeClips|. Returns false if the tree did not need an update.
+bool CC_EXPORT ComputeTransforms(TransformTree* transform_tree);
 
-// Computes screen space opacity for every node in the opacity tree.
-void CC_EXPORT ComputeOpacities(EffectTree* effect_tree);
+// Computes screen space opacity for the nodes in the opacity tree whose
+// opacity, or an ancestor's, has changed since the last update. Returns false
+// if the tree did not need an update.
+bool CC_EXPORT ComputeOpacities(EffectTree* effect_tree);
 
 // Computes the visible content rect for every layer under |root_layer|. The
 // visible content rect is the clipped content space rect that will be used for
@@ -65,7 +73,8 @@ void CC_EXPORT BuildPropertyTreesAndComputeVisibleRects(
     const gfx::Transform& device_transform,
     bool can_render_to_separate_surface,
     PropertyTrees* property_trees,
-    LayerImplList* visible_layer_list);
+    LayerImplList* visible_layer_list,
+    LayerImplList* changed_layer_list);
 
 void CC_EXPORT
 ComputeVisibleRectsUsingPropertyTrees(Layer* root_layer,
@@ -73,11 +82,15 @@ ComputeVisibleRectsUsingPropertyTrees(Layer* root_layer,
                                       bool can_render_to_separate_surface,
                                       LayerList* update_layer_list);
 
+// Layers are only added to |changed_layer_list|, and only get their visible
+// rects recomputed, if those rects and their draw properties can't be reused
+// from the previous update.
 void CC_EXPORT
 ComputeVisibleRectsUsingPropertyTrees(LayerImpl* root_layer,
                                       PropertyTrees* property_trees,
                                       bool can_render_to_separate_surface,
-                                      LayerImplList* visible_layer_list);
+                                      LayerImplList* visible_layer_list,
+                                      LayerImplList* changed_layer_list);
 
 void CC_EXPORT ComputeLayerDrawPropertiesUsingPropertyTrees(
     const LayerImpl* layer,
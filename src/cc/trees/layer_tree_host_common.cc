@@ -2739,6 +2739,7 @@ void CalculateDrawPropertiesAndVerify(
       (property_tree_option == BUILD_PROPERTY_TREES_IF_NEEDED);
 
   LayerImplList visible_layer_list;
+  LayerImplList changed_layer_list;
   if (inputs->verify_property_trees || inputs->use_property_trees) {
     switch (property_tree_option) {
       case BUILD_PROPERTY_TREES_IF_NEEDED: {
@@ -2758,7 +2759,7 @@ void CalculateDrawPropertiesAndVerify(
             inputs->device_scale_factor,
             gfx::Rect(inputs->device_viewport_size), inputs->device_transform,
             inputs->can_render_to_separate_surface, inputs->property_trees,
-            &visible_layer_list);
+            &visible_layer_list, &changed_layer_list);
 
         if (should_measure_property_tree_performance) {
           TRACE_EVENT_END0(
@@ -2790,7 +2791,8 @@ void CalculateDrawPropertiesAndVerify(
             inputs->device_transform);
         ComputeVisibleRectsUsingPropertyTrees(
             inputs->root_layer, inputs->property_trees,
-            inputs->can_render_to_separate_surface, &visible_layer_list);
+            inputs->can_render_to_separate_surface, &visible_layer_list,
+            &changed_layer_list);
         break;
       }
     }
@@ -2804,10 +2806,14 @@ void CalculateDrawPropertiesAndVerify(
   std::vector<AccumulatedSurfaceState> accumulated_surface_state;
   CalculateRenderTarget(inputs);
   if (inputs->use_property_trees) {
-    for (LayerImpl* layer : visible_layer_list) {
+    // The other visible layers keep the draw properties computed by the
+    // previous update.
+    for (LayerImpl* layer : changed_layer_list) {
       ComputeLayerDrawPropertiesUsingPropertyTrees(
           layer, inputs->property_trees, inputs->layers_always_allowed_lcd_text,
           inputs->can_use_lcd_text, &layer->draw_properties());
+    }
+    for (LayerImpl* layer : visible_layer_list) {
       if (layer->mask_layer())
         ComputeMaskLayerDrawProperties(layer, layer->mask_layer());
       LayerImpl* replica_mask_layer = layer->replica_layer()
@@ -1646,7 +1646,7 @@ void LayerTreeHostImpl::DrawLayers(FrameData* frame) {
 
     scoped_ptr<SoftwareRenderer> temp_software_renderer =
         SoftwareRenderer::Create(this, &settings_.renderer_settings,
-                                 output_surface_, NULL);
+                                 output_surface_, NULL, NULL);
     temp_software_renderer->DrawFrame(
         &frame->render_passes, active_tree_->device_scale_factor(),
         DeviceViewport(), DeviceClip(), disable_picture_quad_image_filtering);
@@ -2102,9 +2102,12 @@ void LayerTreeHostImpl::CreateAndSetRenderer() {
         resource_provider_.get(), texture_mailbox_deleter_.get(),
         settings_.renderer_settings.highp_threshold_min);
   } else if (output_surface_->software_device()) {
-    renderer_ =
-        SoftwareRenderer::Create(this, &settings_.renderer_settings,
-                                 output_surface_, resource_provider_.get());
+    // The synchronous task graph runner is only run by raster, so it cannot
+    // draw bands while the renderer waits for them.
+    renderer_ = SoftwareRenderer::Create(
+        this, &settings_.renderer_settings, output_surface_,
+        resource_provider_.get(),
+        is_synchronous_single_threaded_ ? nullptr : task_graph_runner_);
   }
   DCHECK(renderer_);
 
@@ -129,6 +129,8 @@ class CC_EXPORT LayerTreeImpl {
   void SetPropertyTrees(const PropertyTrees& property_trees) {
     property_trees_ = property_trees;
     property_trees_.transform_tree.set_source_to_parent_updates_allowed(false);
+    // The layers of this tree have not been updated with these trees yet.
+    property_trees_.layers_need_full_update = true;
   }
   PropertyTrees* property_trees() { return &property_trees_; }
 
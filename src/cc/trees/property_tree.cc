@@ -59,6 +59,7 @@ TransformNodeData::TransformNodeData()
       content_target_id(-1),
       source_node_id(-1),
       needs_local_transform_update(true),
+      transform_changed(false),
       is_invertible(true),
       ancestors_are_invertible(true),
       is_animated(false),
@@ -110,11 +111,14 @@ ClipNodeData::ClipNodeData()
       target_is_clipped(false),
       layers_are_clipped(false),
       layers_are_clipped_when_surfaces_disabled(false),
-      resets_clip(false) {}
+      resets_clip(false),
+      clip_changed(false) {}
 
 EffectNodeData::EffectNodeData()
     : opacity(1.f),
       screen_space_opacity(1.f),
+      opacity_changed(false),
+      effect_changed(false),
       has_render_surface(false),
       transform_id(0),
       clip_id(0) {}
@@ -190,8 +194,27 @@ void TransformTree::UpdateTransforms(int id) {
   TransformNode* node = Node(id);
   TransformNode* parent_node = parent(node);
   TransformNode* target_node = Node(node->data.target_id);
-  if (node->data.needs_local_transform_update ||
-      NeedsSourceToParentUpdate(node))
+  TransformNode* content_target_node = Node(node->data.content_target_id);
+  bool needs_local_update = node->data.needs_local_transform_update ||
+                            NeedsSourceToParentUpdate(node);
+  // Everything computed below depends only on this node's local transform and
+  // on the transforms of its parent, its target and its content target, so a
+  // node for which none of these changed can be skipped. The targets are
+  // usually ancestors, but the node of a fixed-position layer is parented to
+  // its container, which can be an ancestor of the layer's target. Targets
+  // other than the node itself precede it in the tree, so they have already
+  // been updated.
+  node->data.transform_changed =
+      needs_local_update ||
+      (parent_node && parent_node->data.transform_changed) ||
+      (target_node && target_node->id < id &&
+       target_node->data.transform_changed) ||
+      (content_target_node && content_target_node->id < id &&
+       content_target_node->data.transform_changed);
+  if (!node->data.transform_changed)
+    return;
+
+  if (needs_local_update)
     UpdateLocalTransform(node);
   else
     UndoSnapping(node);
@@ -575,9 +598,19 @@ void TransformTree::SetDeviceTransformScaleFactor(
       MathUtil::ComputeTransform2dScaleComponents(transform, 1.f);
 
   // Not handling the rare case of different x and y device scale.
-  device_transform_scale_factor_ =
+  float device_transform_scale_factor =
       std::max(device_transform_scale_components.x(),
                device_transform_scale_components.y());
+  if (device_transform_scale_factor_ == device_transform_scale_factor)
+    return;
+
+  device_transform_scale_factor_ = device_transform_scale_factor;
+  if (size() < 2)
+    return;
+
+  // Every sublayer scale depends on this factor, so update the whole tree.
+  Node(1)->data.needs_local_transform_update = true;
+  set_needs_update(true);
 }
 
 void TransformTree::SetInnerViewportBoundsDelta(gfx::Vector2dF bounds_delta) {
@@ -626,9 +659,15 @@ bool TransformTree::HasNodesAffectedByOuterViewportBoundsDelta() const {
 
 void EffectTree::UpdateOpacities(int id) {
   EffectNode* node = Node(id);
-  node->data.screen_space_opacity = node->data.opacity;
-
   EffectNode* parent_node = parent(node);
+  node->data.effect_changed =
+      node->data.opacity_changed ||
+      (parent_node && parent_node->data.effect_changed);
+  if (!node->data.effect_changed)
+    return;
+
+  node->data.opacity_changed = false;
+  node->data.screen_space_opacity = node->data.opacity;
   if (parent_node)
     node->data.screen_space_opacity *= parent_node->data.screen_space_opacity;
 }
@@ -663,6 +702,8 @@ gfx::RectF ClipTree::ViewportClip() {
 PropertyTrees::PropertyTrees()
     : needs_rebuild(true),
       non_root_surfaces_enabled(true),
-      sequence_number(0) {}
+      sequence_number(0),
+      layers_need_full_update(true),
+      layer_update_number(0) {}
 
 }  // namespace cc
@@ -70,6 +70,11 @@ struct CC_EXPORT TransformNodeData {
   // TODO(vollick): will be moved when accelerated effects are implemented.
   bool needs_local_transform_update : 1;
 
+  // True if this node's transforms were recomputed by the last update of the
+  // transform tree. Descendants, nodes that target this node, and clips
+  // defined in this node's space only need to be recomputed when this is set.
+  bool transform_changed : 1;
+
   bool is_invertible : 1;
   bool ancestors_are_invertible : 1;
 
@@ -198,6 +203,10 @@ struct CC_EXPORT ClipNodeData {
 
   // Nodes that correspond to unclipped surfaces disregard ancestor clips.
   bool resets_clip : 1;
+
+  // True if the clips in target space were recomputed by the last update of
+  // the clip tree.
+  bool clip_changed : 1;
 };
 
 typedef TreeNode<ClipNodeData> ClipNode;
@@ -208,6 +217,13 @@ struct CC_EXPORT EffectNodeData {
   float opacity;
   float screen_space_opacity;
 
+  // True if |opacity| has changed since the last update of the effect tree.
+  bool opacity_changed;
+
+  // True if |screen_space_opacity| was recomputed by the last update of the
+  // effect tree. Descendants only need to be recomputed when this is set.
+  bool effect_changed;
+
   bool has_render_surface;
   int transform_id;
   int clip_id;
@@ -298,7 +314,10 @@ class CC_EXPORT TransformTree final : public PropertyTree<TransformNode> {
   // aligned with respect to one another.
   bool Are2DAxisAligned(int source_id, int dest_id) const;
 
-  // Updates the parent, target, and screen space transforms and snapping.
+  // Updates the parent, target, and screen space transforms and snapping, if
+  // the node's local transform or the transform of its parent, target or
+  // content target has changed. Nodes must be updated in order, so that these
+  // have already been updated.
   void UpdateTransforms(int id);
 
   // A TransformNode's source_to_parent value is used to account for the fact
@@ -404,6 +423,9 @@ class CC_EXPORT ClipTree final : public PropertyTree<ClipNode> {
 
 class CC_EXPORT EffectTree final : public PropertyTree<EffectNode> {
  public:
+  // Updates the screen space opacity, if the node's opacity or the screen
+  // space opacity of its parent has changed. Nodes must be updated in order,
+  // so that a node's parent has already been updated.
   void UpdateOpacities(int id);
 };
 
@@ -417,6 +439,17 @@ class CC_EXPORT PropertyTrees final {
   bool needs_rebuild;
   bool non_root_surfaces_enabled;
   int sequence_number;
+
+  // True if the visible rects and draw properties of every layer must be
+  // recomputed by the next update, because the trees were rebuilt or
+  // replaced. Otherwise only the layers whose nodes or own properties changed
+  // are recomputed.
+  bool layers_need_full_update;
+
+  // Incremented by every update of the layers' visible rects. Layers record
+  // the number of the last update that saw them, so that layers which were not
+  // visible in the previous update are recomputed.
+  int layer_update_number;
 };
 
 }  // namespace cc
@@ -578,6 +578,7 @@ void BuildPropertyTreesTopLevelInternal(
       data_for_recursion.clip_tree->Insert(root_clip, kRootPropertyTreeNodeId);
   BuildPropertyTreesInternal(root_layer, data_for_recursion);
   property_trees->needs_rebuild = false;
+  property_trees->layers_need_full_update = true;
 
   // The transform tree is kept up-to-date as it is built, but the
   // combined_clips stored in the clip tree aren't computed during tree
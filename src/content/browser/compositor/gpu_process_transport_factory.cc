@@ -11,6 +11,7 @@
 #include "base/location.h"
 #include "base/metrics/histogram.h"
 #include "base/single_thread_task_runner.h"
+#include "base/strings/stringprintf.h"
 #include "base/thread_task_runner_handle.h"
 #include "base/threading/simple_thread.h"
 #include "base/threading/thread.h"
@@ -79,9 +80,9 @@ namespace {
 
 class RasterThread : public base::SimpleThread {
  public:
-  RasterThread(cc::TaskGraphRunner* task_graph_runner)
-      : base::SimpleThread("CompositorTileWorker1"),
-        task_graph_runner_(task_graph_runner) {}
+  RasterThread(cc::TaskGraphRunner* task_graph_runner,
+               const std::string& name)
+      : base::SimpleThread(name), task_graph_runner_(task_graph_runner) {}
 
   // Overridden from base::SimpleThread:
   void Run() override { task_graph_runner_->Run(); }
@@ -113,7 +114,8 @@ GpuProcessTransportFactory::GpuProcessTransportFactory()
   if (UseSurfacesEnabled())
     surface_manager_ = make_scoped_ptr(new cc::SurfaceManager);
 
-  raster_thread_.reset(new RasterThread(task_graph_runner_.get()));
+  raster_thread_.reset(
+      new RasterThread(task_graph_runner_.get(), "CompositorTileWorker1"));
   raster_thread_->Start();
 #if defined(OS_WIN)
   software_backing_.reset(new OutputDeviceBacking);
@@ -129,6 +131,12 @@ GpuProcessTransportFactory::~GpuProcessTransportFactory() {
   task_graph_runner_->Shutdown();
   if (raster_thread_)
     raster_thread_->Join();
+
+  if (software_band_task_graph_runner_) {
+    software_band_task_graph_runner_->Shutdown();
+    for (base::SimpleThread* thread : software_band_threads_)
+      thread->Join();
+  }
 }
 
 scoped_ptr<WebGraphicsContext3DCommandBufferImpl>
@@ -370,7 +378,10 @@ void GpuProcessTransportFactory::EstablishedGpuChannel(
       new cc::OnscreenDisplayClient(
           surface.Pass(), manager, HostSharedBitmapManager::current(),
           BrowserGpuMemoryBufferManager::current(),
-          compositor->GetRendererSettings(), compositor->task_runner()));
+          compositor->GetRendererSettings(),
+          GetSoftwareBandTaskGraphRunner(
+              compositor->GetRendererSettings().software_renderer_band_count),
+          compositor->task_runner()));
 
   scoped_ptr<cc::SurfaceDisplayOutputSurface> output_surface(
       new cc::SurfaceDisplayOutputSurface(
@@ -473,6 +484,28 @@ GpuProcessTransportFactory::CreateSurfaceIdAllocator() {
   return allocator;
 }
 
+cc::TaskGraphRunner*
+GpuProcessTransportFactory::GetSoftwareBandTaskGraphRunner(int band_count) {
+  if (band_count < 2)
+    return nullptr;
+
+  // The thread that draws the frame draws one band while the workers draw the
+  // others. The bands don't share the tile worker, which would run them one
+  // after another and make the drawing thread wait for raster tasks.
+  if (!software_band_task_graph_runner_) {
+    software_band_task_graph_runner_.reset(new cc::TaskGraphRunner);
+    for (int i = 1; i < band_count; ++i) {
+      software_band_threads_.push_back(new RasterThread(
+          software_band_task_graph_runner_.get(),
+          base::StringPrintf("CompositorSoftwareBandWorker%d", i)));
+      software_band_threads_.back()->Start();
+    }
+  }
+  DCHECK_EQ(static_cast<size_t>(band_count - 1),
+            software_band_threads_.size());
+  return software_band_task_graph_runner_.get();
+}
+
 void GpuProcessTransportFactory::ResizeDisplay(ui::Compositor* compositor,
                                                const gfx::Size& size) {
   PerCompositorDataMap::iterator it = per_compositor_data_.find(compositor);
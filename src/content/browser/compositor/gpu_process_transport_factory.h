@@ -10,6 +10,7 @@
 #include "base/id_map.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/memory/weak_ptr.h"
 #include "base/observer_list.h"
 #include "content/browser/compositor/image_transport_factory.h"
@@ -95,6 +96,10 @@ class GpuProcessTransportFactory
   void OnLostMainThreadSharedContextInsideCallback();
   void OnLostMainThreadSharedContext();
 
+  // Returns the runner whose workers draw the bands of software composited
+  // frames, with |band_count| - 1 workers, or null if |band_count| is below 2.
+  cc::TaskGraphRunner* GetSoftwareBandTaskGraphRunner(int band_count);
+
   typedef std::map<ui::Compositor*, PerCompositorData*> PerCompositorDataMap;
   PerCompositorDataMap per_compositor_data_;
   scoped_refptr<ContextProviderCommandBuffer> shared_main_thread_contexts_;
@@ -104,6 +109,8 @@ class GpuProcessTransportFactory
   uint32_t next_surface_id_namespace_;
   scoped_ptr<cc::TaskGraphRunner> task_graph_runner_;
   scoped_ptr<base::SimpleThread> raster_thread_;
+  scoped_ptr<cc::TaskGraphRunner> software_band_task_graph_runner_;
+  ScopedVector<base::SimpleThread> software_band_threads_;
   scoped_refptr<ContextProviderCommandBuffer> shared_worker_context_provider_;
 
 #if defined(OS_WIN)
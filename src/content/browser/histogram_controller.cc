@@ -7,6 +7,7 @@
 #include "base/bind.h"
 #include "base/metrics/histogram.h"
 #include "base/process/process_handle.h"
+#include "content/browser/histogram_message_filter.h"
 #include "content/browser/histogram_subscriber.h"
 #include "content/common/child_process_messages.h"
 #include "content/public/browser/browser_child_process_host_iterator.h"
@@ -71,6 +72,10 @@ void HistogramController::GetHistogramDataFromChildProcesses(
     int sequence_number) {
   DCHECK_CURRENTLY_ON(BrowserThread::IO);
 
+  // Histograms that child processes keep in shared memory are not part of
+  // the data they send back.
+  HistogramMessageFilter::MergeSharedHistograms();
+
   int pending_processes = 0;
   for (BrowserChildProcessHostIterator iter; !iter.Done(); ++iter) {
     const ChildProcessData& data = iter.GetData();
@@ -4,9 +4,14 @@
 
 #include "content/browser/histogram_message_filter.h"
 
+#include <set>
+
 #include "base/command_line.h"
+#include "base/lazy_instance.h"
 #include "base/metrics/histogram.h"
+#include "base/metrics/shared_histogram_allocator.h"
 #include "base/metrics/statistics_recorder.h"
+#include "base/process/process_handle.h"
 #include "content/browser/histogram_controller.h"
 #include "content/browser/tcmalloc_internals_request_job.h"
 #include "content/common/child_process_messages.h"
@@ -14,9 +19,66 @@
 
 namespace content {
 
+namespace {
+
+// The size of the shared memory that each child process keeps its histograms
+// in, which is enough for about a thousand histograms of 50 buckets.
+const uint32 kSharedHistogramMemorySize = 512 * 1024;
+
+// The filters that handed shared memory to their child process.
+base::LazyInstance<std::set<HistogramMessageFilter*>>::Leaky
+    g_filters_with_shared_histograms = LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
 HistogramMessageFilter::HistogramMessageFilter()
     : BrowserMessageFilter(ChildProcessMsgStart) {}
 
+void HistogramMessageFilter::OnChannelConnected(int32 peer_pid) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  // A child that runs in the browser process, e.g. in single process mode,
+  // records into the histograms of the browser already.
+  if (peer_pid == base::GetCurrentProcId())
+    return;
+
+  scoped_ptr<base::SharedHistogramAllocator> allocator =
+      base::SharedHistogramAllocator::Create(kSharedHistogramMemorySize);
+  base::SharedMemoryHandle memory_handle;
+  if (!allocator ||
+      !allocator->shared_memory()->ShareToProcess(PeerHandle(),
+                                                  &memory_handle)) {
+    return;
+  }
+  if (!Send(new ChildProcessMsg_SetHistogramMemory(
+          memory_handle, kSharedHistogramMemorySize))) {
+    return;
+  }
+  shared_histogram_allocator_ = allocator.Pass();
+  g_filters_with_shared_histograms.Get().insert(this);
+}
+
+void HistogramMessageFilter::OnChannelClosing() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  if (!shared_histogram_allocator_)
+    return;
+
+  // Keeps what the child recorded since the last merge, even if it crashed.
+  shared_histogram_allocator_->MergeDeltas();
+  g_filters_with_shared_histograms.Get().erase(this);
+  shared_histogram_allocator_.reset();
+}
+
+// static
+void HistogramMessageFilter::MergeSharedHistograms() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  const std::set<HistogramMessageFilter*>& filters =
+      g_filters_with_shared_histograms.Get();
+  for (std::set<HistogramMessageFilter*>::const_iterator it = filters.begin();
+       it != filters.end(); ++it) {
+    (*it)->shared_histogram_allocator_->MergeDeltas();
+  }
+}
+
 bool HistogramMessageFilter::OnMessageReceived(const IPC::Message& message) {
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(HistogramMessageFilter, message)
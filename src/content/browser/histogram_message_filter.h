@@ -8,9 +8,14 @@
 #include <string>
 #include <vector>
 
+#include "base/memory/scoped_ptr.h"
 #include "content/public/browser/browser_message_filter.h"
 #include "content/public/common/process_type.h"
 
+namespace base {
+class SharedHistogramAllocator;
+}
+
 namespace content {
 
 // This class sends and receives histogram messages in the browser process.
@@ -19,8 +24,15 @@ class HistogramMessageFilter : public BrowserMessageFilter {
   HistogramMessageFilter();
 
   // BrowserMessageFilter implementation.
+  void OnChannelConnected(int32 peer_pid) override;
+  void OnChannelClosing() override;
   bool OnMessageReceived(const IPC::Message& message) override;
 
+  // Adds the samples that child processes recorded in shared memory since the
+  // last call to the histograms of the browser. Must be called on the IO
+  // thread.
+  static void MergeSharedHistograms();
+
  private:
   ~HistogramMessageFilter() override;
 
@@ -30,6 +42,10 @@ class HistogramMessageFilter : public BrowserMessageFilter {
   void OnGetBrowserHistogram(const std::string& name,
                              std::string* histogram_json);
 
+  // The shared memory that the child process keeps its histograms in, once
+  // it has been handed to the child. Only used on the IO thread.
+  scoped_ptr<base::SharedHistogramAllocator> shared_histogram_allocator_;
+
   DISALLOW_COPY_AND_ASSIGN(HistogramMessageFilter);
 };
 
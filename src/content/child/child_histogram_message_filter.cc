@@ -9,6 +9,7 @@
 #include "base/bind.h"
 #include "base/location.h"
 #include "base/metrics/histogram_delta_serialization.h"
+#include "base/metrics/shared_histogram_allocator.h"
 #include "base/single_thread_task_runner.h"
 #include "content/child/child_process.h"
 #include "content/common/child_process_messages.h"
@@ -37,6 +38,8 @@ bool ChildHistogramMessageFilter::OnMessageReceived(
   IPC_BEGIN_MESSAGE_MAP(ChildHistogramMessageFilter, message)
     IPC_MESSAGE_HANDLER(ChildProcessMsg_GetChildHistogramData,
                         OnGetChildHistogramData)
+    IPC_MESSAGE_HANDLER(ChildProcessMsg_SetHistogramMemory,
+                        OnSetHistogramMemory)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
   return handled;
@@ -52,6 +55,23 @@ void ChildHistogramMessageFilter::OnGetChildHistogramData(int sequence_number) {
   UploadAllHistograms(sequence_number);
 }
 
+void ChildHistogramMessageFilter::OnSetHistogramMemory(
+    const base::SharedMemoryHandle& memory_handle,
+    uint32 memory_size) {
+  if (base::SharedHistogramAllocator::GetForCurrentProcess()) {
+    base::SharedMemory::CloseHandle(memory_handle);
+    return;
+  }
+
+  // Histograms created from now on keep their samples in the memory, where
+  // the browser reads them; the existing ones are still sent over IPC.
+  scoped_ptr<base::SharedHistogramAllocator> allocator =
+      base::SharedHistogramAllocator::CreateFromHandle(memory_handle,
+                                                       memory_size);
+  if (allocator)
+    base::SharedHistogramAllocator::SetForCurrentProcess(allocator.Pass());
+}
+
 void ChildHistogramMessageFilter::UploadAllHistograms(int sequence_number) {
   if (!histogram_delta_serialization_) {
     histogram_delta_serialization_.reset(
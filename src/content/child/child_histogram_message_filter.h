@@ -10,6 +10,7 @@
 
 #include "base/basictypes.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/shared_memory.h"
 #include "ipc/message_filter.h"
 
 namespace base {
@@ -37,6 +38,8 @@ class ChildHistogramMessageFilter : public IPC::MessageFilter {
 
   // Message handlers.
   virtual void OnGetChildHistogramData(int sequence_number);
+  void OnSetHistogramMemory(const base::SharedMemoryHandle& memory_handle,
+                            uint32 memory_size);
 
   // Extract snapshot data and then send it off the the Browser process.
   // Send only a delta to what we have already sent.
@@ -116,6 +116,13 @@ IPC_MESSAGE_CONTROL1(ChildProcessMsg_ProfilingPhaseCompleted,
 IPC_MESSAGE_CONTROL1(ChildProcessMsg_GetChildHistogramData,
                      int /* sequence_number */)
 
+// Sent to child processes to give them shared memory to keep the samples of
+// their histograms in. The browser reads those directly from the memory, so
+// they are no longer sent back with ChildProcessHostMsg_ChildHistogramData.
+IPC_MESSAGE_CONTROL2(ChildProcessMsg_SetHistogramMemory,
+                     base::SharedMemoryHandle /* histogram_memory */,
+                     uint32 /* histogram_memory_size */)
+
 // Sent to child processes to tell them to enter or leave background mode.
 IPC_MESSAGE_CONTROL1(ChildProcessMsg_SetProcessBackgrounded,
                      bool /* background */)
@@ -46,6 +46,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <queue>
 #include <set>
 
 #include "base/basictypes.h"
@@ -160,18 +161,6 @@ bool CookieSorter(CanonicalCookie* cc1, CanonicalCookie* cc2) {
   return cc1->Path().length() > cc2->Path().length();
 }
 
-bool LRACookieSorter(const CookieMonster::CookieMap::iterator& it1,
-                     const CookieMonster::CookieMap::iterator& it2) {
-  // Cookies accessed less recently should be deleted first.
-  if (it1->second->LastAccessDate() != it2->second->LastAccessDate())
-    return it1->second->LastAccessDate() < it2->second->LastAccessDate();
-
-  // In rare cases we might have two cookies with identical last access times.
-  // To preserve the stability of the sort, in these cases prefer to delete
-  // older cookies over newer ones.  CreationDate() is guaranteed to be unique.
-  return it1->second->CreationDate() < it2->second->CreationDate();
-}
-
 // Compare cookies using name, domain and path, so that "equivalent" cookies
 // (per RFC 2965) are equal to each other.
 bool PartialDiffCookieSorter(const CanonicalCookie& a,
@@ -222,41 +211,6 @@ struct CookieSignature {
   std::string path;
 };
 
-// For a CookieItVector iterator range [|it_begin|, |it_end|),
-// sorts the first |num_sort| + 1 elements by LastAccessDate().
-// The + 1 element exists so for any interval of length <= |num_sort| starting
-// from |cookies_its_begin|, a LastAccessDate() bound can be found.
-void SortLeastRecentlyAccessed(CookieMonster::CookieItVector::iterator it_begin,
-                               CookieMonster::CookieItVector::iterator it_end,
-                               size_t num_sort) {
-  DCHECK_LT(static_cast<int>(num_sort), it_end - it_begin);
-  std::partial_sort(it_begin, it_begin + num_sort + 1, it_end, LRACookieSorter);
-}
-
-// Predicate to support PartitionCookieByPriority().
-struct CookiePriorityEqualsTo
-    : std::unary_function<const CookieMonster::CookieMap::iterator, bool> {
-  explicit CookiePriorityEqualsTo(CookiePriority priority)
-      : priority_(priority) {}
-
-  bool operator()(const CookieMonster::CookieMap::iterator it) const {
-    return it->second->Priority() == priority_;
-  }
-
-  const CookiePriority priority_;
-};
-
-// For a CookieItVector iterator range [|it_begin|, |it_end|),
-// moves all cookies with a given |priority| to the beginning of the list.
-// Returns: An iterator in [it_begin, it_end) to the first element with
-// priority != |priority|, or |it_end| if all have priority == |priority|.
-CookieMonster::CookieItVector::iterator PartitionCookieByPriority(
-    CookieMonster::CookieItVector::iterator it_begin,
-    CookieMonster::CookieItVector::iterator it_end,
-    CookiePriority priority) {
-  return std::partition(it_begin, it_end, CookiePriorityEqualsTo(priority));
-}
-
 bool LowerBoundAccessDateComparator(const CookieMonster::CookieMap::iterator it,
                                     const Time& access_date) {
   return it->second->LastAccessDate() < access_date;
@@ -341,6 +295,24 @@ bool CheckCookiePrefix(CanonicalCookie* cc, const CookieOptions& options) {
 
 }  // namespace
 
+bool CookieMonster::LRACookieComparator::operator()(
+    const CookieMap::iterator& it1,
+    const CookieMap::iterator& it2) const {
+  // Cookies accessed less recently should be deleted first.
+  if (it1->second->LastAccessDate() != it2->second->LastAccessDate())
+    return it1->second->LastAccessDate() < it2->second->LastAccessDate();
+
+  // In rare cases we might have two cookies with identical last access times.
+  // To preserve the stability of the ordering, in these cases prefer to delete
+  // older cookies over newer ones.  CreationDate() is meant to be unique, but
+  // cookies imported through ImportCookies() or SetAllCookiesAsync() bring
+  // their own creation dates, so fall back to identity to keep the ordering
+  // strict.
+  if (it1->second->CreationDate() != it2->second->CreationDate())
+    return it1->second->CreationDate() < it2->second->CreationDate();
+  return it1->second < it2->second;
+}
+
 CookieMonster::CookieMonster(PersistentCookieStore* store,
                              CookieMonsterDelegate* delegate)
     : initialized_(false),
@@ -1774,7 +1746,7 @@ void CookieMonster::FindCookiesForKey(const std::string& key,
     // Add this cookie to the set of matching cookies. Update the access
     // time if we've been requested to do so.
     if (update_access_time) {
-      InternalUpdateCookieAccessTime(cc, current);
+      InternalUpdateCookieAccessTime(curit, current);
     }
     cookies->push_back(cc);
   }
@@ -1827,6 +1799,7 @@ CookieMonster::CookieMap::iterator CookieMonster::InternalInsertCookie(
     store_->AddCookie(*cc);
   CookieMap::iterator inserted =
       cookies_.insert(CookieMap::value_type(key, cc));
+  lru_shards_[key].insert(inserted);
   if (delegate_.get()) {
     delegate_->OnCookieChanged(*cc, false,
                                CookieMonsterDelegate::CHANGE_COOKIE_EXPLICIT);
@@ -1952,10 +1925,12 @@ bool CookieMonster::SetCanonicalCookies(const CookieList& list) {
   return true;
 }
 
-void CookieMonster::InternalUpdateCookieAccessTime(CanonicalCookie* cc,
+void CookieMonster::InternalUpdateCookieAccessTime(CookieMap::iterator it,
                                                    const Time& current) {
   lock_.AssertAcquired();
 
+  CanonicalCookie* cc = it->second;
+
   // Based off the Mozilla code.  When a cookie has been accessed recently,
   // don't bother updating its access time again.  This reduces the number of
   // updates we do during pageload, which in turn reduces the chance our storage
@@ -1963,7 +1938,14 @@ void CookieMonster::InternalUpdateCookieAccessTime(CanonicalCookie* cc,
   if ((current - cc->LastAccessDate()) < last_access_threshold_)
     return;
 
+  // The access date is part of the LRU shard ordering, so move the cookie
+  // within its shard around the update.
+  CookieLRUSet& shard = lru_shards_[it->first];
+  size_t num_erased = shard.erase(it);
+  DCHECK_EQ(1u, num_erased);
   cc->SetLastAccessDate(current);
+  shard.insert(it);
+
   if ((cc->IsPersistent() || persist_session_cookies_) && store_.get())
     store_->UpdateCookieAccessTime(*cc);
 }
@@ -2000,6 +1982,14 @@ void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
       delegate_->OnCookieChanged(*cc, true, mapping.cause);
   }
   RunCallbacks(*cc, true);
+
+  CookieLRUShardMap::iterator shard = lru_shards_.find(it->first);
+  DCHECK(shard != lru_shards_.end());
+  size_t num_erased = shard->second.erase(it);
+  DCHECK_EQ(1u, num_erased);
+  if (shard->second.empty())
+    lru_shards_.erase(shard);
+
   cookies_.erase(it);
   delete cc;
 }
@@ -2009,6 +1999,11 @@ void CookieMonster::InternalDeleteCookie(CookieMap::iterator it,
 int CookieMonster::GarbageCollect(const Time& current, const std::string& key) {
   lock_.AssertAcquired();
 
+  // A store that keeps expired cookies is used as a plain data structure and
+  // is never pruned.
+  if (keep_expired_cookies_)
+    return 0;
+
   int num_deleted = 0;
   Time safe_date(Time::Now() - TimeDelta::FromDays(kSafeFromGlobalPurgeDays));
 
@@ -2016,66 +2011,11 @@ int CookieMonster::GarbageCollect(const Time& current, const std::string& key) {
   if (cookies_.count(key) > kDomainMaxCookies) {
     VLOG(kVlogGarbageCollection) << "GarbageCollect() key: " << key;
 
-    CookieItVector cookie_its;
     num_deleted +=
-        GarbageCollectExpired(current, cookies_.equal_range(key), &cookie_its);
-    if (cookie_its.size() > kDomainMaxCookies) {
+        GarbageCollectExpired(current, cookies_.equal_range(key), NULL);
+    if (cookies_.count(key) > kDomainMaxCookies) {
       VLOG(kVlogGarbageCollection) << "Deep Garbage Collect domain.";
-      size_t purge_goal =
-          cookie_its.size() - (kDomainMaxCookies - kDomainPurgeCookies);
-      DCHECK(purge_goal > kDomainPurgeCookies);
-
-      // Boundary iterators into |cookie_its| for different priorities.
-      CookieItVector::iterator it_bdd[4];
-      // Intialize |it_bdd| while sorting |cookie_its| by priorities.
-      // Schematic: [MLLHMHHLMM] => [LLL|MMMM|HHH], with 4 boundaries.
-      it_bdd[0] = cookie_its.begin();
-      it_bdd[3] = cookie_its.end();
-      it_bdd[1] =
-          PartitionCookieByPriority(it_bdd[0], it_bdd[3], COOKIE_PRIORITY_LOW);
-      it_bdd[2] = PartitionCookieByPriority(it_bdd[1], it_bdd[3],
-                                            COOKIE_PRIORITY_MEDIUM);
-      size_t quota[3] = {kDomainCookiesQuotaLow,
-                         kDomainCookiesQuotaMedium,
-                         kDomainCookiesQuotaHigh};
-
-      // Purge domain cookies in 3 rounds.
-      // Round 1: consider low-priority cookies only: evict least-recently
-      //   accessed, while protecting quota[0] of these from deletion.
-      // Round 2: consider {low, medium}-priority cookies, evict least-recently
-      //   accessed, while protecting quota[0] + quota[1].
-      // Round 3: consider all cookies, evict least-recently accessed.
-      size_t accumulated_quota = 0;
-      CookieItVector::iterator it_purge_begin = it_bdd[0];
-      for (int i = 0; i < 3 && purge_goal > 0; ++i) {
-        accumulated_quota += quota[i];
-
-        size_t num_considered = it_bdd[i + 1] - it_purge_begin;
-        if (num_considered <= accumulated_quota)
-          continue;
-
-        // Number of cookies that will be purged in this round.
-        size_t round_goal =
-            std::min(purge_goal, num_considered - accumulated_quota);
-        purge_goal -= round_goal;
-
-        SortLeastRecentlyAccessed(it_purge_begin, it_bdd[i + 1], round_goal);
-        // Cookies accessed on or after |safe_date| would have been safe from
-        // global purge, and we want to keep track of this.
-        CookieItVector::iterator it_purge_end = it_purge_begin + round_goal;
-        CookieItVector::iterator it_purge_middle =
-            LowerBoundAccessDate(it_purge_begin, it_purge_end, safe_date);
-        // Delete cookies accessed before |safe_date|.
-        num_deleted += GarbageCollectDeleteRange(
-            current, DELETE_COOKIE_EVICTED_DOMAIN_PRE_SAFE, it_purge_begin,
-            it_purge_middle);
-        // Delete cookies accessed on or after |safe_date|.
-        num_deleted += GarbageCollectDeleteRange(
-            current, DELETE_COOKIE_EVICTED_DOMAIN_POST_SAFE, it_purge_middle,
-            it_purge_end);
-        it_purge_begin = it_purge_end;
-      }
-      DCHECK_EQ(0U, purge_goal);
+      num_deleted += GarbageCollectDomainByPriority(current, safe_date, key);
     }
   }
 
@@ -2083,34 +2023,140 @@ int CookieMonster::GarbageCollect(const Time& current, const std::string& key) {
   // cookies accessed in kSafeFromGlobalPurgeDays, otherwise evict.
   if (cookies_.size() > kMaxCookies && earliest_access_time_ < safe_date) {
     VLOG(kVlogGarbageCollection) << "GarbageCollect() everything";
-    CookieItVector cookie_its;
     num_deleted += GarbageCollectExpired(
-        current, CookieMapItPair(cookies_.begin(), cookies_.end()),
-        &cookie_its);
-    if (cookie_its.size() > kMaxCookies) {
+        current, CookieMapItPair(cookies_.begin(), cookies_.end()), NULL);
+    if (cookies_.size() > kMaxCookies) {
       VLOG(kVlogGarbageCollection) << "Deep Garbage Collect everything.";
-      size_t purge_goal = cookie_its.size() - (kMaxCookies - kPurgeCookies);
+      size_t purge_goal = cookies_.size() - (kMaxCookies - kPurgeCookies);
       DCHECK(purge_goal > kPurgeCookies);
-      // Sorts up to *and including* |cookie_its[purge_goal]|, so
-      // |earliest_access_time| will be properly assigned even if
-      // |global_purge_it| == |cookie_its.begin() + purge_goal|.
-      SortLeastRecentlyAccessed(cookie_its.begin(), cookie_its.end(),
-                                purge_goal);
-      // Find boundary to cookies older than safe_date.
-      CookieItVector::iterator global_purge_it = LowerBoundAccessDate(
-          cookie_its.begin(), cookie_its.begin() + purge_goal, safe_date);
-      // Only delete the old cookies.
+      // Only delete the old cookies; the walk stops at the first cookie
+      // accessed on or after |safe_date|.
+      CookieItVector cookie_its;
+      Time oldest_kept_access_date =
+          FindLeastRecentlyAccessedBefore(purge_goal, safe_date, &cookie_its);
       num_deleted +=
           GarbageCollectDeleteRange(current, DELETE_COOKIE_EVICTED_GLOBAL,
-                                    cookie_its.begin(), global_purge_it);
+                                    cookie_its.begin(), cookie_its.end());
       // Set access day to the oldest cookie that wasn't deleted.
-      earliest_access_time_ = (*global_purge_it)->second->LastAccessDate();
+      DCHECK(!oldest_kept_access_date.is_null());
+      earliest_access_time_ = oldest_kept_access_date;
     }
   }
 
   return num_deleted;
 }
 
+int CookieMonster::GarbageCollectDomainByPriority(const Time& current,
+                                                  const Time& safe_date,
+                                                  const std::string& key) {
+  lock_.AssertAcquired();
+
+  CookieLRUShardMap::iterator shard_it = lru_shards_.find(key);
+  DCHECK(shard_it != lru_shards_.end());
+  const CookieLRUSet& shard = shard_it->second;
+  DCHECK_GT(shard.size(), kDomainMaxCookies);
+
+  int num_deleted = 0;
+  size_t purge_goal = shard.size() - (kDomainMaxCookies - kDomainPurgeCookies);
+  DCHECK(purge_goal > kDomainPurgeCookies);
+
+  // Number of cookies of each priority.
+  size_t num_with_priority[3] = {0, 0, 0};
+  for (CookieLRUSet::const_iterator it = shard.begin(); it != shard.end();
+       ++it) {
+    ++num_with_priority[(*it)->second->Priority()];
+  }
+  size_t quota[3] = {kDomainCookiesQuotaLow,
+                     kDomainCookiesQuotaMedium,
+                     kDomainCookiesQuotaHigh};
+
+  // Purge domain cookies in 3 rounds.
+  // Round 1: consider low-priority cookies only: evict least-recently
+  //   accessed, while protecting quota[0] of these from deletion.
+  // Round 2: consider {low, medium}-priority cookies, evict least-recently
+  //   accessed, while protecting quota[0] + quota[1].
+  // Round 3: consider all cookies, evict least-recently accessed.
+  // The shard is already in least-recently-accessed order, so each round is
+  // a single walk from its front.
+  size_t accumulated_quota = 0;
+  size_t num_considered = 0;
+  for (int i = 0; i < 3 && purge_goal > 0; ++i) {
+    accumulated_quota += quota[i];
+    num_considered += num_with_priority[i];
+    if (num_considered <= accumulated_quota)
+      continue;
+
+    // Number of cookies that will be purged in this round.
+    size_t round_goal =
+        std::min(purge_goal, num_considered - accumulated_quota);
+    purge_goal -= round_goal;
+    num_considered -= round_goal;
+
+    CookieItVector cookie_its;
+    cookie_its.reserve(round_goal);
+    for (CookieLRUSet::const_iterator it = shard.begin();
+         cookie_its.size() < round_goal; ++it) {
+      DCHECK(it != shard.end());
+      if ((*it)->second->Priority() > i)
+        continue;
+      cookie_its.push_back(*it);
+    }
+
+    // Cookies accessed on or after |safe_date| would have been safe from
+    // global purge, and we want to keep track of this.
+    CookieItVector::iterator it_purge_middle =
+        LowerBoundAccessDate(cookie_its.begin(), cookie_its.end(), safe_date);
+    // Delete cookies accessed before |safe_date|.
+    num_deleted += GarbageCollectDeleteRange(
+        current, DELETE_COOKIE_EVICTED_DOMAIN_PRE_SAFE, cookie_its.begin(),
+        it_purge_middle);
+    // Delete cookies accessed on or after |safe_date|.
+    num_deleted += GarbageCollectDeleteRange(
+        current, DELETE_COOKIE_EVICTED_DOMAIN_POST_SAFE, it_purge_middle,
+        cookie_its.end());
+  }
+  DCHECK_EQ(0U, purge_goal);
+
+  return num_deleted;
+}
+
+Time CookieMonster::FindLeastRecentlyAccessedBefore(
+    size_t max_cookies,
+    const Time& access_date,
+    CookieItVector* cookie_its) {
+  lock_.AssertAcquired();
+
+  // K-way merge of the shards: the heap holds the next unvisited cookie of
+  // every non-empty shard, least recently accessed on top.
+  typedef std::pair<CookieLRUSet::const_iterator, CookieLRUSet::const_iterator>
+      ShardCursor;
+  struct CursorComparator {
+    bool operator()(const ShardCursor& a, const ShardCursor& b) const {
+      // std::priority_queue is a max-heap; invert to pop the oldest first.
+      return LRACookieComparator()(*b.first, *a.first);
+    }
+  };
+  std::priority_queue<ShardCursor, std::vector<ShardCursor>, CursorComparator>
+      heap;
+  for (CookieLRUShardMap::const_iterator it = lru_shards_.begin();
+       it != lru_shards_.end(); ++it) {
+    DCHECK(!it->second.empty());
+    heap.push(ShardCursor(it->second.begin(), it->second.end()));
+  }
+
+  while (!heap.empty()) {
+    ShardCursor cursor = heap.top();
+    const Time& cursor_access_date = (*cursor.first)->second->LastAccessDate();
+    if (cookie_its->size() >= max_cookies || cursor_access_date >= access_date)
+      return cursor_access_date;
+    heap.pop();
+    cookie_its->push_back(*cursor.first);
+    if (++cursor.first != cursor.second)
+      heap.push(cursor);
+  }
+  return Time();
+}
+
 int CookieMonster::GarbageCollectExpired(const Time& current,
                                          const CookieMapItPair& itpair,
                                          CookieItVector* cookie_its) {
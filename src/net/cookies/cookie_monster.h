@@ -451,6 +451,21 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // Record statistics every kRecordStatisticsIntervalSeconds of uptime.
   static const int kRecordStatisticsIntervalSeconds = 10 * 60;
 
+  // Orders iterators into |cookies_| from least to most recently accessed.
+  // Ties are broken by creation date, which is unique within the store.
+  struct LRACookieComparator {
+    bool operator()(const CookieMap::iterator& it1,
+                    const CookieMap::iterator& it2) const;
+  };
+
+  // The access-ordered index over |cookies_| is sharded by CookieMap key
+  // (eTLD+1), so that garbage collection can visit the cookies of one domain,
+  // or of the whole store, in least-recently-accessed order without sorting.
+  // Entries are keyed on LastAccessDate(), so a cookie must be removed from its
+  // shard before that date is changed and re-inserted afterwards.
+  typedef std::set<CookieMap::iterator, LRACookieComparator> CookieLRUSet;
+  typedef std::map<std::string, CookieLRUSet> CookieLRUShardMap;
+
   ~CookieMonster() override;
 
   // The following are synchronous calls to which the asynchronous methods
@@ -595,7 +610,7 @@ class NET_EXPORT CookieMonster : public CookieStore {
   // Helper function calling SetCanonicalCookie() for all cookies in |list|.
   bool SetCanonicalCookies(const CookieList& list);
 
-  void InternalUpdateCookieAccessTime(CanonicalCookie* cc,
+  void InternalUpdateCookieAccessTime(CookieMap::iterator it,
                                       const base::Time& current_time);
 
   // |deletion_cause| argument is used for collecting statistics and choosing
@@ -630,6 +645,24 @@ class NET_EXPORT CookieMonster : public CookieStore {
                                 CookieItVector::iterator cookie_its_begin,
                                 CookieItVector::iterator cookie_its_end);
 
+  // Helper for GarbageCollect(). Purges the least recently accessed cookies of
+  // the domain |key| down to the domain limits, minding cookie priorities.
+  // Expired cookies must already have been removed.
+  //
+  // Returns the number of cookies deleted.
+  int GarbageCollectDomainByPriority(const base::Time& current,
+                                     const base::Time& safe_date,
+                                     const std::string& key);
+
+  // Helper for GarbageCollect(). Merges the per-key LRU shards to visit all
+  // cookies in least-recently-accessed order, appending to |cookie_its| at most
+  // |max_cookies| cookies that were last accessed before |access_date|.
+  // Returns the last access date of the first cookie that was not appended, or
+  // a null Time if every cookie in the store was appended.
+  base::Time FindLeastRecentlyAccessedBefore(size_t max_cookies,
+                                             const base::Time& access_date,
+                                             CookieItVector* cookie_its);
+
   // Find the key (for lookup in cookies_) based on the given domain.
   // See comment on keys before the CookieMap typedef.
   std::string GetKey(const std::string& domain) const;
@@ -685,6 +718,11 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   CookieMap cookies_;
 
+  // Access-ordered index over |cookies_|, one shard per CookieMap key. Kept in
+  // sync by InternalInsertCookie(), InternalDeleteCookie() and
+  // InternalUpdateCookieAccessTime().
+  CookieLRUShardMap lru_shards_;
+
   // Indicates whether the cookie store has been initialized.
   bool initialized_;
 
@@ -26,8 +26,19 @@
 // size so that we have a chance to see an element again and move it to another
 // list.
 
+// On top of that, kFrequencyAdmission adds a TinyLFU style admission filter.
+// Every time an entry is created or opened its hash is recorded on a small
+// count-min sketch (FrequencySketch), which remembers recent popularity even
+// for entries that are not stored anymore. When trimming would evict a reused
+// entry (LOW_USE or HIGH_USE) while there are new entries waiting on NO_USE,
+// the oldest new entry has to be seen more often than the reused one to stay
+// in the cache; otherwise it goes first. This way a burst of entries that are
+// used only once (say, a large download) cannot flush the working set.
+
 #include "net/disk_cache/blockfile/eviction.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/compiler_specific.h"
 #include "base/location.h"
@@ -92,6 +103,10 @@ void Eviction::Init(BackendImpl* backend) {
   max_size_ = LowWaterAdjust(backend_->max_size_);
   index_size_ = backend->mask_ + 1;
   new_eviction_ = backend->new_eviction_;
+  frequency_admission_ =
+      new_eviction_ && (backend->user_flags_ & kFrequencyAdmission);
+  if (frequency_admission_)
+    sketch_.Init(std::max(index_size_, header_->num_entries));
   first_trim_ = true;
   trimming_ = false;
   delay_trim_ = false;
@@ -347,6 +362,7 @@ void Eviction::TrimCacheV2(bool empty) {
 
   Rankings::ScopedRankingsBlock node(rankings_);
   int deleted_entries = 0;
+  int rejected_entries = 0;
   int target_size = empty ? 0 : max_size_;
 
   for (; list < kListsToSearch; list++) {
@@ -355,15 +371,24 @@ void Eviction::TrimCacheV2(bool empty) {
       // The iterator could be invalidated within EvictEntry().
       if (!next[list]->HasData())
         break;
-      node.reset(next[list].release());
-      next[list].reset(rankings_->GetPrev(node.get(),
-                                          static_cast<Rankings::List>(list)));
+      int evict_list = list;
+      if (frequency_admission_ && !empty && list != Rankings::NO_USE &&
+          ShouldEvictNewEntry(next[Rankings::NO_USE].get(),
+                              next[list].get())) {
+        evict_list = Rankings::NO_USE;
+        rejected_entries++;
+      }
+      node.reset(next[evict_list].release());
+      next[evict_list].reset(rankings_->GetPrev(
+          node.get(), static_cast<Rankings::List>(evict_list)));
       if (node->Data()->dirty != backend_->GetCurrentEntryId() || empty) {
         // This entry is not being used by anybody.
         // Do NOT use node as an iterator after this point.
         rankings_->TrackRankingsBlock(node.get(), false);
-        if (EvictEntry(node.get(), empty, static_cast<Rankings::List>(list)))
+        if (EvictEntry(node.get(), empty,
+                       static_cast<Rankings::List>(evict_list))) {
           deleted_entries++;
+        }
 
         if (!empty && test_mode_)
           break;
@@ -394,6 +419,8 @@ void Eviction::TrimCacheV2(bool empty) {
     CACHE_UMA(AGE_MS, "TotalTrimTimeV2", 0, start);
   }
   CACHE_UMA(COUNTS, "TrimItemsV2", 0, deleted_entries);
+  if (frequency_admission_ && !empty)
+    CACHE_UMA(COUNTS, "TrimRejectedNewItems", 0, rejected_entries);
 
   Trace("*** Trim Cache end ***");
   trimming_ = false;
@@ -408,6 +435,9 @@ void Eviction::OnOpenEntryV2(EntryImpl* entry) {
   EntryStore* info = entry->entry()->Data();
   DCHECK_EQ(ENTRY_NORMAL, info->state);
 
+  if (frequency_admission_)
+    sketch_.Increment(info->hash);
+
   if (info->reuse_count < kint32max) {
     info->reuse_count++;
     entry->entry()->set_modified();
@@ -427,6 +457,9 @@ void Eviction::OnOpenEntryV2(EntryImpl* entry) {
 
 void Eviction::OnCreateEntryV2(EntryImpl* entry) {
   EntryStore* info = entry->entry()->Data();
+  if (frequency_admission_)
+    sketch_.Increment(info->hash);
+
   switch (info->state) {
     case ENTRY_NORMAL: {
       DCHECK(!info->reuse_count);
@@ -600,4 +633,37 @@ void Eviction::ReportListStats() {
               Time::FromInternalValue(last4.get()->Data()->last_used));
 }
 
+bool Eviction::ShouldEvictNewEntry(CacheRankingsBlock* candidate,
+                                   CacheRankingsBlock* victim) {
+  // The candidate must be usable as an iterator and not be in use.
+  if (!candidate || !candidate->HasData() ||
+      candidate->Data()->dirty == backend_->GetCurrentEntryId()) {
+    return false;
+  }
+
+  uint32 candidate_hash, victim_hash;
+  if (!GetEntryHash(candidate, &candidate_hash) ||
+      !GetEntryHash(victim, &victim_hash)) {
+    return false;
+  }
+
+  // Ties favor the entry that was already reused.
+  return sketch_.Frequency(candidate_hash) <= sketch_.Frequency(victim_hash);
+}
+
+bool Eviction::GetEntryHash(CacheRankingsBlock* node, uint32* hash) {
+  Addr address(node->Data()->contents);
+  if (!address.SanityCheckForEntryV2())
+    return false;
+
+  // Only the hash of the key is needed, so there is no reason to go through
+  // the whole entry creation (and validation) path here.
+  CacheEntryBlock entry(backend_->File(address), address);
+  if (!entry.Load())
+    return false;
+
+  *hash = entry.Data()->hash;
+  return true;
+}
+
 }  // namespace disk_cache
@@ -7,6 +7,7 @@
 
 #include "base/basictypes.h"
 #include "base/memory/weak_ptr.h"
+#include "net/disk_cache/blockfile/frequency_sketch.h"
 #include "net/disk_cache/blockfile/rankings.h"
 
 namespace disk_cache {
@@ -69,6 +70,13 @@ class Eviction {
   int SelectListByLength(Rankings::ScopedRankingsBlock* next);
   void ReportListStats();
 
+  // Frequency based admission (kFrequencyAdmission). Returns true if
+  // |candidate|, the oldest entry of the NO_USE list, should be evicted
+  // instead of |victim|, taken from a list of reused entries.
+  bool ShouldEvictNewEntry(CacheRankingsBlock* candidate,
+                           CacheRankingsBlock* victim);
+  bool GetEntryHash(CacheRankingsBlock* node, uint32* hash);
+
   BackendImpl* backend_;
   Rankings* rankings_;
   IndexHeader* header_;
@@ -76,11 +84,13 @@ class Eviction {
   int trim_delays_;
   int index_size_;
   bool new_eviction_;
+  bool frequency_admission_;
   bool first_trim_;
   bool trimming_;
   bool delay_trim_;
   bool init_;
   bool test_mode_;
+  FrequencySketch sketch_;
   base::WeakPtrFactory<Eviction> ptr_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(Eviction);
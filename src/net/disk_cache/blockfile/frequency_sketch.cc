@@ -0,0 +1,97 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/blockfile/frequency_sketch.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace {
+
+const int kNumRows = 4;
+const int kCountersPerWord = 16;
+const int kMinCountersPerRow = 64;
+const int kSampleFactor = 10;
+
+// Odd constants used to derive one index per row from the entry hash.
+const uint32 kRowSeeds[kNumRows] = {
+  0x9e3779b1, 0x85ebca77, 0xc2b2ae3d, 0x27d4eb2f
+};
+
+}  // namespace
+
+namespace disk_cache {
+
+FrequencySketch::FrequencySketch()
+    : row_mask_(0), num_accesses_(0), sample_size_(0) {
+}
+
+FrequencySketch::~FrequencySketch() {
+}
+
+void FrequencySketch::Init(int max_entries) {
+  uint32 counters_per_row = kMinCountersPerRow;
+  while (counters_per_row < static_cast<uint32>(max_entries) &&
+         counters_per_row < (1u << 24)) {
+    counters_per_row <<= 1;
+  }
+
+  row_mask_ = counters_per_row - 1;
+  table_.assign(kNumRows * counters_per_row / kCountersPerWord, 0);
+  num_accesses_ = 0;
+  sample_size_ = kSampleFactor * std::max(max_entries, kMinCountersPerRow);
+}
+
+void FrequencySketch::Increment(uint32 hash) {
+  if (table_.empty())
+    return;
+
+  bool added = false;
+  for (int row = 0; row < kNumRows; row++) {
+    uint32 index = CounterIndex(hash, row);
+    if (GetCounter(index) < kMaxFrequency) {
+      IncrementCounter(index);
+      added = true;
+    }
+  }
+
+  if (added && ++num_accesses_ >= sample_size_)
+    Age();
+}
+
+int FrequencySketch::Frequency(uint32 hash) const {
+  if (table_.empty())
+    return 0;
+
+  int frequency = kMaxFrequency;
+  for (int row = 0; row < kNumRows; row++)
+    frequency = std::min(frequency, GetCounter(CounterIndex(hash, row)));
+  return frequency;
+}
+
+uint32 FrequencySketch::CounterIndex(uint32 hash, int row) const {
+  uint32 value = (hash ^ (hash >> 16)) * kRowSeeds[row];
+  value ^= value >> 15;
+  return row * (row_mask_ + 1) + (value & row_mask_);
+}
+
+int FrequencySketch::GetCounter(uint32 index) const {
+  int shift = (index % kCountersPerWord) * 4;
+  return static_cast<int>((table_[index / kCountersPerWord] >> shift) & 0xf);
+}
+
+void FrequencySketch::IncrementCounter(uint32 index) {
+  DCHECK_LT(GetCounter(index), kMaxFrequency);
+  int shift = (index % kCountersPerWord) * 4;
+  table_[index / kCountersPerWord] += UINT64_C(1) << shift;
+}
+
+void FrequencySketch::Age() {
+  for (size_t i = 0; i < table_.size(); i++)
+    table_[i] = (table_[i] >> 1) & UINT64_C(0x7777777777777777);
+  num_accesses_ /= 2;
+}
+
+}  // namespace disk_cache
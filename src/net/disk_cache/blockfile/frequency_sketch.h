@@ -0,0 +1,59 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_BLOCKFILE_FREQUENCY_SKETCH_H_
+#define NET_DISK_CACHE_BLOCKFILE_FREQUENCY_SKETCH_H_
+
+#include <vector>
+
+#include "base/basictypes.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+// This class keeps an approximate count of how many times each entry hash was
+// seen lately, using a count-min sketch of 4-bit counters (four rows, each
+// indexed by a different mix of the hash). The estimate for a hash is the
+// smallest of its four counters, so it can be too high but never too low.
+//
+// Once the number of recorded accesses reaches ten times the expected number
+// of entries, every counter is halved so that old popularity fades away.
+class NET_EXPORT_PRIVATE FrequencySketch {
+ public:
+  FrequencySketch();
+  ~FrequencySketch();
+
+  // Sizes the sketch for a cache that holds about |max_entries| entries. Any
+  // previous counts are discarded.
+  void Init(int max_entries);
+
+  // Records an access to |hash|.
+  void Increment(uint32 hash);
+
+  // Returns the estimated number of recent accesses to |hash|, up to
+  // kMaxFrequency.
+  int Frequency(uint32 hash) const;
+
+  static const int kMaxFrequency = 15;
+
+ private:
+  // Returns the position of the counter for |hash| on the given |row|.
+  uint32 CounterIndex(uint32 hash, int row) const;
+  int GetCounter(uint32 index) const;
+  void IncrementCounter(uint32 index);
+
+  // Halves all counters.
+  void Age();
+
+  std::vector<uint64> table_;  // 16 counters per word.
+  uint32 row_mask_;  // Counters per row, minus one.
+  int num_accesses_;  // Accesses recorded since the last aging.
+  int sample_size_;  // Value of num_accesses_ that triggers aging.
+
+  DISALLOW_COPY_AND_ASSIGN(FrequencySketch);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_BLOCKFILE_FREQUENCY_SKETCH_H_
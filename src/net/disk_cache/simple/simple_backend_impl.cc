@@ -33,6 +33,7 @@
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
 #include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_mapped_index_file.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "net/disk_cache/simple/simple_version_upgrade.h"
@@ -82,6 +83,13 @@ base::LazyInstance<LeakySequencedWorkerPool>::Leaky g_sequenced_worker_pool =
 
 bool g_fd_limit_histogram_has_been_populated = false;
 
+// Returns true if the index should be kept in the memory-mapped format, see
+// SimpleMappedIndexFile, instead of being rewritten on every flush.
+bool UseMappedIndex() {
+  return base::FieldTrialList::FindFullName("SimpleCacheMappedIndex") ==
+         "Enabled";
+}
+
 void MaybeHistogramFdLimit(net::CacheType cache_type) {
   if (g_fd_limit_histogram_has_been_populated)
     return;
@@ -250,12 +258,16 @@ SimpleBackendImpl::~SimpleBackendImpl() {
 int SimpleBackendImpl::Init(const CompletionCallback& completion_callback) {
   worker_pool_ = g_sequenced_worker_pool.Get().GetTaskRunner();
 
-  index_.reset(new SimpleIndex(
-      base::ThreadTaskRunnerHandle::Get(),
-      this,
-      cache_type_,
-      make_scoped_ptr(new SimpleIndexFile(
-          cache_thread_, worker_pool_.get(), cache_type_, path_))));
+  scoped_ptr<SimpleIndexFile> index_file;
+  if (UseMappedIndex()) {
+    index_file.reset(new SimpleMappedIndexFile(
+        cache_thread_, worker_pool_.get(), cache_type_, path_));
+  } else {
+    index_file.reset(new SimpleIndexFile(
+        cache_thread_, worker_pool_.get(), cache_type_, path_));
+  }
+  index_.reset(new SimpleIndex(base::ThreadTaskRunnerHandle::Get(), this,
+                               cache_type_, index_file.Pass()));
   index_->ExecuteWhenReady(
       base::Bind(&RecordIndexLoad, cache_type_, base::TimeTicks::Now()));
 
@@ -152,6 +152,8 @@ SimpleIndex::SimpleIndex(
       eviction_in_progress_(false),
       initialized_(false),
       index_file_(index_file.Pass()),
+      incremental_writes_(index_file_->SupportsIncrementalWrites()),
+      full_write_required_(true),
       io_thread_(io_thread),
       // Creating the callback once so it is reused every time
       // write_to_disk_timer_.Start() is called.
@@ -253,6 +255,7 @@ void SimpleIndex::Insert(uint64 entry_hash) {
       entry_hash, EntryMetadata(base::Time::Now(), 0), &entries_set_);
   if (!initialized_)
     removed_entries_.erase(entry_hash);
+  MarkEntryChanged(entry_hash);
   PostponeWritingToDisk();
 }
 
@@ -266,6 +269,7 @@ void SimpleIndex::Remove(uint64 entry_hash) {
 
   if (!initialized_)
     removed_entries_.insert(entry_hash);
+  MarkEntryChanged(entry_hash);
   PostponeWritingToDisk();
 }
 
@@ -284,6 +288,7 @@ bool SimpleIndex::UseIfExists(uint64 entry_hash) {
     // If not initialized, always return true, forcing it to go to the disk.
     return !initialized_;
   it->second.SetLastUsedTime(base::Time::Now());
+  MarkEntryChanged(entry_hash);
   PostponeWritingToDisk();
   return true;
 }
@@ -344,6 +349,7 @@ bool SimpleIndex::UpdateEntrySize(uint64 entry_hash, int64 entry_size) {
     return false;
 
   UpdateEntryIteratorSize(&it, entry_size);
+  MarkEntryChanged(entry_hash);
   PostponeWritingToDisk();
   StartEvictionIfNeeded();
   return true;
@@ -382,6 +388,11 @@ void SimpleIndex::PostponeWritingToDisk() {
       FROM_HERE, base::TimeDelta::FromMilliseconds(delay), write_to_disk_cb_);
 }
 
+void SimpleIndex::MarkEntryChanged(uint64 entry_hash) {
+  if (incremental_writes_)
+    changed_entries_.insert(entry_hash);
+}
+
 void SimpleIndex::UpdateEntryIteratorSize(EntrySet::iterator* it,
                                           int64 entry_size) {
   // Update the total cache size with the new entry size.
@@ -424,6 +435,9 @@ void SimpleIndex::MergeInitializingSet(
   entries_set_.swap(*index_file_entries);
   cache_size_ = merged_cache_size;
   initialized_ = true;
+  // An index that was rebuilt from the entry files has to be written in full
+  // before changes can be applied to it.
+  full_write_required_ = load_result->flush_required;
 
   // The actual IO is asynchronous, so calling WriteToDisk() shouldn't slow the
   // merge down much.
@@ -478,6 +492,30 @@ void SimpleIndex::WriteToDisk() {
   }
   last_write_to_disk_ = start;
 
+  if (incremental_writes_ && !full_write_required_) {
+    EntrySet changed_entries;
+    HashList removed_entries;
+    for (base::hash_set<uint64>::const_iterator it = changed_entries_.begin();
+         it != changed_entries_.end(); ++it) {
+      EntrySet::const_iterator found = entries_set_.find(*it);
+      if (found == entries_set_.end())
+        removed_entries.push_back(*it);
+      else
+        InsertInEntrySet(found->first, found->second, &changed_entries);
+    }
+    changed_entries_.clear();
+    SIMPLE_CACHE_UMA(CUSTOM_COUNTS,
+                     "IndexNumChangedEntriesOnWrite", cache_type_,
+                     changed_entries.size() + removed_entries.size(),
+                     0, 100000, 50);
+    index_file_->WriteChangesToDisk(changed_entries, removed_entries,
+                                    cache_size_, start, app_on_background_,
+                                    base::Closure());
+    return;
+  }
+
+  changed_entries_.clear();
+  full_write_required_ = false;
   index_file_->WriteToDisk(entries_set_, cache_size_,
                            start, app_on_background_, base::Closure());
 }
@@ -151,6 +151,10 @@ class NET_EXPORT_PRIVATE SimpleIndex
 
   void UpdateEntryIteratorSize(EntrySet::iterator* it, int64 entry_size);
 
+  // Records that the metadata of |entry_hash| changed, or that it was removed,
+  // for the next incremental write.
+  void MarkEntryChanged(uint64 entry_hash);
+
   // Must run on IO Thread.
   void MergeInitializingSet(scoped_ptr<SimpleIndexLoadResult> load_result);
 
@@ -180,6 +184,14 @@ class NET_EXPORT_PRIVATE SimpleIndex
 
   scoped_ptr<SimpleIndexFile> index_file_;
 
+  // True if |index_file_| supports incremental writes, in which case
+  // |changed_entries_| holds the hashes of the entries inserted, updated or
+  // removed since the last write, and only those are written unless
+  // |full_write_required_| is set.
+  const bool incremental_writes_;
+  base::hash_set<uint64> changed_entries_;
+  bool full_write_required_;
+
   scoped_refptr<base::SingleThreadTaskRunner> io_thread_;
 
   // All nonstatic SimpleEntryImpl methods should always be called on the IO
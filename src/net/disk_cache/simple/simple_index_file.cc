@@ -293,6 +293,20 @@ void SimpleIndexFile::WriteToDisk(const SimpleIndex::EntrySet& entry_set,
     cache_thread_->PostTaskAndReply(FROM_HERE, task, callback);
 }
 
+bool SimpleIndexFile::SupportsIncrementalWrites() const {
+  return false;
+}
+
+void SimpleIndexFile::WriteChangesToDisk(
+    const SimpleIndex::EntrySet& changed_entries,
+    const SimpleIndex::HashList& removed_entries,
+    uint64 cache_size,
+    const base::TimeTicks& start,
+    bool app_on_background,
+    const base::Closure& callback) {
+  NOTREACHED();
+}
+
 // static
 void SimpleIndexFile::SyncLoadIndexEntries(
     net::CacheType cache_type,
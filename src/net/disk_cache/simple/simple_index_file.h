@@ -93,6 +93,32 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                            bool app_on_background,
                            const base::Closure& callback);
 
+  // Returns true if the index file can be updated with only the entries that
+  // changed since the previous write; see WriteChangesToDisk().
+  virtual bool SupportsIncrementalWrites() const;
+
+  // Writes |changed_entries| and removes |removed_entries|, leaving the rest
+  // of the index file as it is. Only called when SupportsIncrementalWrites()
+  // returns true, after the entries were loaded or written with WriteToDisk().
+  virtual void WriteChangesToDisk(const SimpleIndex::EntrySet& changed_entries,
+                                  const SimpleIndex::HashList& removed_entries,
+                                  uint64 cache_size,
+                                  const base::TimeTicks& start,
+                                  bool app_on_background,
+                                  const base::Closure& callback);
+
+ protected:
+  const scoped_refptr<base::SingleThreadTaskRunner>& cache_thread() const {
+    return cache_thread_;
+  }
+  const base::FilePath& index_file() const { return index_file_; }
+
+  // Scan the index directory for entries, returning an EntrySet of all entries
+  // found.
+  static void SyncRestoreFromDisk(const base::FilePath& cache_directory,
+                                  const base::FilePath& index_file_path,
+                                  SimpleIndexLoadResult* out_result);
+
  private:
   friend class WrappedSimpleIndexFile;
 
@@ -155,12 +181,6 @@ class NET_EXPORT_PRIVATE SimpleIndexFile {
                               const base::TimeTicks& start_time,
                               bool app_on_background);
 
-  // Scan the index directory for entries, returning an EntrySet of all entries
-  // found.
-  static void SyncRestoreFromDisk(const base::FilePath& cache_directory,
-                                  const base::FilePath& index_file_path,
-                                  SimpleIndexLoadResult* out_result);
-
   // Determines if an index file is stale relative to the time of last
   // modification of the cache directory. Obsolete, used only for a histogram to
   // compare with the new method.
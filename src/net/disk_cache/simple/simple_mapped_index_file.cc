@@ -0,0 +1,717 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_mapped_index_file.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/single_thread_task_runner.h"
+#include "base/time/time.h"
+#include "net/disk_cache/blockfile/mapped_file.h"
+#include "net/disk_cache/simple/simple_histogram_macros.h"
+#include "net/disk_cache/simple/simple_util.h"
+#include "third_party/zlib/zlib.h"
+
+namespace disk_cache {
+
+namespace {
+
+const uint64 kMappedIndexMagicNumber = UINT64_C(0x78656469706d6973);
+const uint32 kMappedIndexVersion = 1;
+const uint32 kLogBatchMagicNumber = 0x676f6c69;
+
+const char kMappedIndexFileName[] = "the-mapped-index";
+const char kTempMappedIndexFileName[] = "temp-mapped-index";
+const char kMappedIndexLogFileName[] = "the-mapped-index-log";
+
+// The size of the header and of each bucket.
+const size_t kPageSize = 4096;
+
+const uint32 kMinBuckets = 16;
+
+// The log is truncated after this many batches have been applied.
+const int kMaxLogBatches = 32;
+
+enum TableState {
+  TABLE_STATE_CLEAN = 0,
+  // A batch from the log was being applied to the buckets.
+  TABLE_STATE_DIRTY = 1,
+};
+
+struct TableHeader {
+  uint64 magic_number;
+  uint32 version;
+  uint32 num_buckets;
+  uint64 entry_count;
+  uint64 cache_size;
+  int64 cache_last_modified;
+  uint32 state;
+  uint32 crc;  // Of the fields above.
+};
+static_assert(sizeof(TableHeader) <= kPageSize, "header does not fit a page");
+
+struct BucketHeader {
+  uint32 entry_count;
+  uint32 unused[3];
+};
+
+// The records of a bucket are kept contiguous, in no particular order.
+struct EntryRecord {
+  uint64 hash;
+  // Seconds since the Unix epoch, or 0 for a null time.
+  uint32 last_used_time;
+  // In the log, -1 marks a removed entry.
+  int32 entry_size;
+};
+static_assert(sizeof(EntryRecord) == 16, "incorrect entry record size");
+
+const size_t kRecordsPerBucket =
+    (kPageSize - sizeof(BucketHeader)) / sizeof(EntryRecord);
+
+// Rebuilt tables get enough buckets for them to be at most half full, so that
+// the cache can grow for a long time before a bucket fills up.
+const size_t kTargetRecordsPerBucket = kRecordsPerBucket / 2;
+
+// Each batch in the log is a LogBatchHeader followed by |record_count|
+// EntryRecords.
+struct LogBatchHeader {
+  uint32 magic_number;
+  uint32 record_count;
+  uint64 cache_size;
+  int64 cache_last_modified;
+  uint32 crc;  // Of the header, with |crc| set to 0, and the records.
+  uint32 unused;
+};
+
+uint32 UpdateCRC(uint32 crc, const void* data, size_t size) {
+  return crc32(crc, reinterpret_cast<const Bytef*>(data), size);
+}
+
+uint32 CalculateHeaderCRC(const TableHeader& header) {
+  return UpdateCRC(crc32(0, Z_NULL, 0), &header,
+                   offsetof(TableHeader, crc));
+}
+
+uint32 CalculateBatchCRC(const LogBatchHeader& batch,
+                         const EntryRecord* records) {
+  LogBatchHeader batch_without_crc = batch;
+  batch_without_crc.crc = 0;
+  uint32 crc = UpdateCRC(crc32(0, Z_NULL, 0), &batch_without_crc,
+                         sizeof(batch_without_crc));
+  return UpdateCRC(crc, records, batch.record_count * sizeof(EntryRecord));
+}
+
+size_t TableSizeForBuckets(uint32 num_buckets) {
+  return kPageSize * (static_cast<size_t>(num_buckets) + 1);
+}
+
+uint32 BucketCountForEntries(size_t entry_count) {
+  uint32 num_buckets = kMinBuckets;
+  while (num_buckets * kTargetRecordsPerBucket < entry_count)
+    num_buckets *= 2;
+  return num_buckets;
+}
+
+uint32 BucketForHash(uint64 hash, uint32 num_buckets) {
+  return static_cast<uint32>(hash & (num_buckets - 1));
+}
+
+bool IsHeaderValid(const TableHeader& header) {
+  return header.magic_number == kMappedIndexMagicNumber &&
+         header.version == kMappedIndexVersion &&
+         header.num_buckets >= kMinBuckets &&
+         (header.num_buckets & (header.num_buckets - 1)) == 0 &&
+         header.state <= TABLE_STATE_DIRTY &&
+         header.crc == CalculateHeaderCRC(header);
+}
+
+BucketHeader* GetBucket(void* table, uint32 index) {
+  return reinterpret_cast<BucketHeader*>(static_cast<char*>(table) +
+                                         kPageSize * (index + 1));
+}
+
+EntryRecord* GetRecords(BucketHeader* bucket) {
+  return reinterpret_cast<EntryRecord*>(bucket + 1);
+}
+
+EntryRecord MakeRecord(uint64 hash, const EntryMetadata& metadata) {
+  EntryRecord record;
+  record.hash = hash;
+  const base::Time last_used_time = metadata.GetLastUsedTime();
+  record.last_used_time =
+      last_used_time.is_null()
+          ? 0
+          : static_cast<uint32>(
+                (last_used_time - base::Time::UnixEpoch()).InSeconds());
+  record.entry_size = static_cast<int32>(metadata.GetEntrySize());
+  return record;
+}
+
+EntryRecord MakeRemovalRecord(uint64 hash) {
+  EntryRecord record;
+  record.hash = hash;
+  record.last_used_time = 0;
+  record.entry_size = -1;
+  return record;
+}
+
+EntryMetadata RecordToMetadata(const EntryRecord& record) {
+  base::Time last_used_time;
+  if (record.last_used_time != 0) {
+    last_used_time = base::Time::UnixEpoch() +
+                     base::TimeDelta::FromSeconds(record.last_used_time);
+  }
+  return EntryMetadata(last_used_time, record.entry_size);
+}
+
+void ApplyRecordToEntrySet(const EntryRecord& record,
+                           SimpleIndex::EntrySet* entries) {
+  if (record.entry_size < 0) {
+    entries->erase(record.hash);
+    return;
+  }
+  (*entries)[record.hash] = RecordToMetadata(record);
+}
+
+}  // namespace
+
+// Owns the mapped table and its log. Only used on the cache thread.
+class SimpleMappedIndexFile::Table
+    : public base::RefCountedThreadSafe<SimpleMappedIndexFile::Table> {
+ public:
+  Table(net::CacheType cache_type,
+        const base::FilePath& cache_directory,
+        const base::FilePath& pickled_index_file);
+
+  void Load(base::Time cache_last_modified, SimpleIndexLoadResult* out_result);
+  void WriteAll(scoped_ptr<SimpleIndex::EntrySet> entries,
+                uint64 cache_size,
+                const base::TimeTicks& start);
+  void WriteChanges(scoped_ptr<SimpleIndex::EntrySet> changed_entries,
+                    scoped_ptr<SimpleIndex::HashList> removed_entries,
+                    uint64 cache_size,
+                    const base::TimeTicks& start);
+  void Close();
+
+ private:
+  friend class base::RefCountedThreadSafe<Table>;
+
+  ~Table();
+
+  // Maps the table and opens the log. Returns false if the table does not
+  // exist or its header is invalid.
+  bool Open();
+
+  TableHeader* header() {
+    return static_cast<TableHeader*>(mapped_file_->buffer());
+  }
+
+  // Copies the entries of the mapped table into |entries|. Returns false if
+  // a bucket is inconsistent.
+  bool ReadEntries(SimpleIndex::EntrySet* entries);
+
+  // Writes |record| into its bucket of the mapped table. Returns false if the
+  // bucket is full.
+  bool ApplyRecord(const EntryRecord& record);
+
+  // Replaces the table with one holding |entries|, and truncates the log.
+  bool Rebuild(const SimpleIndex::EntrySet& entries,
+               uint64 cache_size,
+               base::Time cache_last_modified);
+
+  bool AppendToLog(const std::vector<EntryRecord>& records,
+                   uint64 cache_size,
+                   base::Time cache_last_modified);
+
+  // Applies every complete batch of the log to |entries|, and sets
+  // |*cache_last_modified| to the time recorded by the last one.
+  void ReplayLog(SimpleIndex::EntrySet* entries,
+                 base::Time* cache_last_modified);
+
+  void TruncateLog();
+
+  const net::CacheType cache_type_;
+  const base::FilePath cache_directory_;
+  const base::FilePath index_file_;
+  const base::FilePath temp_index_file_;
+  const base::FilePath log_file_;
+  const base::FilePath pickled_index_file_;
+
+  scoped_refptr<MappedFile> mapped_file_;
+  base::File log_;
+  int64 log_size_;
+  int log_batches_;
+
+  DISALLOW_COPY_AND_ASSIGN(Table);
+};
+
+SimpleMappedIndexFile::Table::Table(
+    net::CacheType cache_type,
+    const base::FilePath& cache_directory,
+    const base::FilePath& pickled_index_file)
+    : cache_type_(cache_type),
+      cache_directory_(cache_directory),
+      index_file_(pickled_index_file.DirName().AppendASCII(
+          kMappedIndexFileName)),
+      temp_index_file_(pickled_index_file.DirName().AppendASCII(
+          kTempMappedIndexFileName)),
+      log_file_(pickled_index_file.DirName().AppendASCII(
+          kMappedIndexLogFileName)),
+      pickled_index_file_(pickled_index_file),
+      log_size_(0),
+      log_batches_(0) {
+}
+
+SimpleMappedIndexFile::Table::~Table() {
+  Close();
+}
+
+void SimpleMappedIndexFile::Table::Load(base::Time cache_last_modified,
+                                        SimpleIndexLoadResult* out_result) {
+  const base::TimeTicks start = base::TimeTicks::Now();
+  out_result->Reset();
+  Close();
+
+  if (Open()) {
+    base::Time last_cache_seen_by_index =
+        base::Time::FromInternalValue(header()->cache_last_modified);
+    if (ReadEntries(&out_result->entries)) {
+      if (header()->state == TABLE_STATE_DIRTY) {
+        // The previous session died while applying a batch. Every batch since
+        // the log was last truncated is in the log, and applying one twice is
+        // harmless. The table itself stays dirty until it is rewritten.
+        ReplayLog(&out_result->entries, &last_cache_seen_by_index);
+        out_result->flush_required = true;
+      }
+      if (cache_last_modified <= last_cache_seen_by_index) {
+        out_result->did_load = true;
+        SIMPLE_CACHE_UMA(TIMES, "MappedIndexLoadTime", cache_type_,
+                         base::TimeTicks::Now() - start);
+        SIMPLE_CACHE_UMA(BOOLEAN, "MappedIndexLoadReplayedLog", cache_type_,
+                         out_result->flush_required);
+        return;
+      }
+    } else {
+      LOG(WARNING) << "Corrupt bucket in mapped Simple Cache index.";
+    }
+    out_result->Reset();
+    Close();
+  }
+
+  // Reconstruct the index by scanning the disk for entries. This deletes the
+  // table, which is written again in full once the index is merged.
+  const base::TimeTicks restore_start = base::TimeTicks::Now();
+  SimpleIndexFile::SyncRestoreFromDisk(cache_directory_, index_file_,
+                                       out_result);
+  simple_util::SimpleCacheDeleteFile(log_file_);
+  SIMPLE_CACHE_UMA(MEDIUM_TIMES, "MappedIndexRestoreTime", cache_type_,
+                   base::TimeTicks::Now() - restore_start);
+}
+
+void SimpleMappedIndexFile::Table::WriteAll(
+    scoped_ptr<SimpleIndex::EntrySet> entries,
+    uint64 cache_size,
+    const base::TimeTicks& start) {
+  base::Time cache_dir_mtime;
+  if (!simple_util::GetMTime(cache_directory_, &cache_dir_mtime)) {
+    LOG(ERROR) << "Could obtain information about cache age";
+    return;
+  }
+  if (!Rebuild(*entries, cache_size, cache_dir_mtime)) {
+    LOG(ERROR) << "Failed to write the mapped index file";
+    return;
+  }
+  SIMPLE_CACHE_UMA(TIMES, "MappedIndexWriteToDiskTime.Full", cache_type_,
+                   base::TimeTicks::Now() - start);
+}
+
+void SimpleMappedIndexFile::Table::WriteChanges(
+    scoped_ptr<SimpleIndex::EntrySet> changed_entries,
+    scoped_ptr<SimpleIndex::HashList> removed_entries,
+    uint64 cache_size,
+    const base::TimeTicks& start) {
+  // If the last full write failed there is nothing to apply the changes to,
+  // and the next load rebuilds the index from the entry files.
+  if (!mapped_file_.get())
+    return;
+
+  base::Time cache_dir_mtime;
+  if (!simple_util::GetMTime(cache_directory_, &cache_dir_mtime)) {
+    LOG(ERROR) << "Could obtain information about cache age";
+    return;
+  }
+
+  std::vector<EntryRecord> records;
+  records.reserve(changed_entries->size() + removed_entries->size());
+  for (SimpleIndex::EntrySet::const_iterator it = changed_entries->begin();
+       it != changed_entries->end(); ++it) {
+    records.push_back(MakeRecord(it->first, it->second));
+  }
+  for (size_t i = 0; i < removed_entries->size(); ++i)
+    records.push_back(MakeRemovalRecord((*removed_entries)[i]));
+
+  if (!AppendToLog(records, cache_size, cache_dir_mtime)) {
+    // Without the batch in the log, a crash while applying it could leave the
+    // table silently wrong, so drop the table instead.
+    LOG(ERROR) << "Failed to append to the mapped index log";
+    Close();
+    simple_util::SimpleCacheDeleteFile(index_file_);
+    return;
+  }
+
+  header()->state = TABLE_STATE_DIRTY;
+  header()->crc = CalculateHeaderCRC(*header());
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    if (ApplyRecord(records[i]))
+      continue;
+
+    // The bucket is full. Rebuild the table with more buckets from its
+    // contents and the rest of the batch.
+    SimpleIndex::EntrySet entries;
+    ReadEntries(&entries);
+    for (size_t j = i; j < records.size(); ++j)
+      ApplyRecordToEntrySet(records[j], &entries);
+    if (!Rebuild(entries, cache_size, cache_dir_mtime))
+      LOG(ERROR) << "Failed to grow the mapped index file";
+    SIMPLE_CACHE_UMA(TIMES, "MappedIndexWriteToDiskTime.Full", cache_type_,
+                     base::TimeTicks::Now() - start);
+    return;
+  }
+
+  header()->cache_size = cache_size;
+  header()->cache_last_modified = cache_dir_mtime.ToInternalValue();
+  header()->state = TABLE_STATE_CLEAN;
+  header()->crc = CalculateHeaderCRC(*header());
+
+  if (++log_batches_ >= kMaxLogBatches) {
+    mapped_file_->Flush();
+    TruncateLog();
+  }
+
+  SIMPLE_CACHE_UMA(TIMES, "MappedIndexWriteToDiskTime.Changes", cache_type_,
+                   base::TimeTicks::Now() - start);
+}
+
+void SimpleMappedIndexFile::Table::Close() {
+  if (mapped_file_.get()) {
+    mapped_file_->Flush();
+    mapped_file_ = NULL;
+  }
+  log_.Close();
+  log_size_ = 0;
+  log_batches_ = 0;
+}
+
+bool SimpleMappedIndexFile::Table::Open() {
+  DCHECK(!mapped_file_.get());
+  if (!base::PathExists(index_file_))
+    return false;
+
+  scoped_refptr<MappedFile> mapped_file(new MappedFile());
+  if (!mapped_file->Init(index_file_, 0))
+    return false;
+  const size_t length = mapped_file->GetLength();
+  if (length < kPageSize)
+    return false;
+  const TableHeader* table_header =
+      static_cast<const TableHeader*>(mapped_file->buffer());
+  if (!IsHeaderValid(*table_header) ||
+      length != TableSizeForBuckets(table_header->num_buckets)) {
+    LOG(WARNING) << "Invalid header on mapped Simple Cache index.";
+    return false;
+  }
+
+  log_.Initialize(log_file_, base::File::FLAG_OPEN_ALWAYS |
+                                 base::File::FLAG_READ |
+                                 base::File::FLAG_WRITE |
+                                 base::File::FLAG_SHARE_DELETE);
+  if (!log_.IsValid())
+    return false;
+  log_size_ = log_.GetLength();
+  if (log_size_ < 0) {
+    log_.Close();
+    return false;
+  }
+
+  mapped_file_.swap(mapped_file);
+  return true;
+}
+
+bool SimpleMappedIndexFile::Table::ReadEntries(
+    SimpleIndex::EntrySet* entries) {
+  const uint32 num_buckets = header()->num_buckets;
+#if !defined(OS_WIN)
+  entries->resize(static_cast<size_t>(std::min<uint64>(
+      header()->entry_count, num_buckets * kRecordsPerBucket)));
+#endif
+  uint64 entry_count = 0;
+  for (uint32 i = 0; i < num_buckets; ++i) {
+    BucketHeader* bucket = GetBucket(mapped_file_->buffer(), i);
+    if (bucket->entry_count > kRecordsPerBucket)
+      return false;
+    const EntryRecord* records = GetRecords(bucket);
+    for (uint32 j = 0; j < bucket->entry_count; ++j) {
+      if (BucketForHash(records[j].hash, num_buckets) != i ||
+          records[j].entry_size < 0) {
+        return false;
+      }
+      SimpleIndex::InsertInEntrySet(records[j].hash,
+                                    RecordToMetadata(records[j]), entries);
+    }
+    entry_count += bucket->entry_count;
+  }
+  // A dirty table may have been interrupted between updating a bucket and
+  // the header.
+  return header()->state == TABLE_STATE_DIRTY ||
+         entry_count == header()->entry_count;
+}
+
+bool SimpleMappedIndexFile::Table::ApplyRecord(const EntryRecord& record) {
+  BucketHeader* bucket = GetBucket(
+      mapped_file_->buffer(), BucketForHash(record.hash, header()->num_buckets));
+  EntryRecord* records = GetRecords(bucket);
+  for (uint32 i = 0; i < bucket->entry_count; ++i) {
+    if (records[i].hash != record.hash)
+      continue;
+    if (record.entry_size < 0) {
+      records[i] = records[bucket->entry_count - 1];
+      --bucket->entry_count;
+      --header()->entry_count;
+    } else {
+      records[i] = record;
+    }
+    return true;
+  }
+
+  if (record.entry_size < 0)
+    return true;
+  if (bucket->entry_count == kRecordsPerBucket)
+    return false;
+  records[bucket->entry_count] = record;
+  ++bucket->entry_count;
+  ++header()->entry_count;
+  return true;
+}
+
+bool SimpleMappedIndexFile::Table::Rebuild(
+    const SimpleIndex::EntrySet& entries,
+    uint64 cache_size,
+    base::Time cache_last_modified) {
+  Close();
+
+  base::FilePath index_file_directory = temp_index_file_.DirName();
+  if (!base::DirectoryExists(index_file_directory) &&
+      !base::CreateDirectory(index_file_directory)) {
+    LOG(ERROR) << "Could not create a directory to hold the index file";
+    return false;
+  }
+
+  // Buckets only overflow if the hashes are badly skewed; retry with twice
+  // as many when one does.
+  uint32 num_buckets = BucketCountForEntries(entries.size());
+  std::vector<char> table;
+  bool filled = false;
+  while (!filled) {
+    table.assign(TableSizeForBuckets(num_buckets), 0);
+    filled = true;
+    for (SimpleIndex::EntrySet::const_iterator it = entries.begin();
+         it != entries.end(); ++it) {
+      BucketHeader* bucket =
+          GetBucket(&table[0], BucketForHash(it->first, num_buckets));
+      if (bucket->entry_count == kRecordsPerBucket) {
+        filled = false;
+        num_buckets *= 2;
+        break;
+      }
+      GetRecords(bucket)[bucket->entry_count++] =
+          MakeRecord(it->first, it->second);
+    }
+  }
+
+  TableHeader* table_header = reinterpret_cast<TableHeader*>(&table[0]);
+  table_header->magic_number = kMappedIndexMagicNumber;
+  table_header->version = kMappedIndexVersion;
+  table_header->num_buckets = num_buckets;
+  table_header->entry_count = entries.size();
+  table_header->cache_size = cache_size;
+  table_header->cache_last_modified = cache_last_modified.ToInternalValue();
+  table_header->state = TABLE_STATE_CLEAN;
+  table_header->crc = CalculateHeaderCRC(*table_header);
+
+  {
+    base::File file(temp_index_file_, base::File::FLAG_CREATE_ALWAYS |
+                                          base::File::FLAG_WRITE |
+                                          base::File::FLAG_SHARE_DELETE);
+    if (!file.IsValid())
+      return false;
+    const int size = static_cast<int>(table.size());
+    if (file.Write(0, &table[0], size) != size) {
+      file.Close();
+      simple_util::SimpleCacheDeleteFile(temp_index_file_);
+      return false;
+    }
+  }
+
+  // The log belongs to the table being replaced.
+  simple_util::SimpleCacheDeleteFile(log_file_);
+  if (!base::ReplaceFile(temp_index_file_, index_file_, NULL))
+    return false;
+
+  // The pickled index would only go stale next to this one.
+  if (base::PathExists(pickled_index_file_))
+    simple_util::SimpleCacheDeleteFile(pickled_index_file_);
+
+  return Open();
+}
+
+bool SimpleMappedIndexFile::Table::AppendToLog(
+    const std::vector<EntryRecord>& records,
+    uint64 cache_size,
+    base::Time cache_last_modified) {
+  LogBatchHeader batch;
+  memset(&batch, 0, sizeof(batch));
+  batch.magic_number = kLogBatchMagicNumber;
+  batch.record_count = static_cast<uint32>(records.size());
+  batch.cache_size = cache_size;
+  batch.cache_last_modified = cache_last_modified.ToInternalValue();
+  batch.crc = CalculateBatchCRC(batch, records.empty() ? NULL : &records[0]);
+
+  const size_t records_size = records.size() * sizeof(EntryRecord);
+  std::vector<char> buffer(sizeof(batch) + records_size);
+  memcpy(&buffer[0], &batch, sizeof(batch));
+  if (records_size)
+    memcpy(&buffer[sizeof(batch)], &records[0], records_size);
+
+  const int size = static_cast<int>(buffer.size());
+  if (log_.Write(log_size_, &buffer[0], size) != size)
+    return false;
+  log_size_ += size;
+  return true;
+}
+
+void SimpleMappedIndexFile::Table::ReplayLog(SimpleIndex::EntrySet* entries,
+                                             base::Time* cache_last_modified) {
+  if (log_size_ <= 0)
+    return;
+  std::vector<char> log(static_cast<size_t>(log_size_));
+  if (log_.Read(0, &log[0], log_size_) != log_size_)
+    return;
+
+  int batches_replayed = 0;
+  size_t offset = 0;
+  while (log.size() - offset >= sizeof(LogBatchHeader)) {
+    LogBatchHeader batch;
+    memcpy(&batch, &log[offset], sizeof(batch));
+    offset += sizeof(batch);
+    if (batch.magic_number != kLogBatchMagicNumber ||
+        batch.record_count > (log.size() - offset) / sizeof(EntryRecord)) {
+      break;
+    }
+
+    // A batch that was cut short by a crash fails its CRC and ends the log.
+    std::vector<EntryRecord> records(batch.record_count);
+    if (batch.record_count) {
+      memcpy(&records[0], &log[offset],
+             batch.record_count * sizeof(EntryRecord));
+    }
+    if (CalculateBatchCRC(batch, records.empty() ? NULL : &records[0]) !=
+        batch.crc) {
+      break;
+    }
+    offset += batch.record_count * sizeof(EntryRecord);
+
+    for (size_t i = 0; i < records.size(); ++i)
+      ApplyRecordToEntrySet(records[i], entries);
+    *cache_last_modified =
+        base::Time::FromInternalValue(batch.cache_last_modified);
+    ++batches_replayed;
+  }
+  SIMPLE_CACHE_UMA(COUNTS, "MappedIndexLogBatchesReplayed", cache_type_,
+                   batches_replayed);
+}
+
+void SimpleMappedIndexFile::Table::TruncateLog() {
+  if (log_.SetLength(0))
+    log_size_ = 0;
+  log_batches_ = 0;
+}
+
+SimpleMappedIndexFile::SimpleMappedIndexFile(
+    const scoped_refptr<base::SingleThreadTaskRunner>& cache_thread,
+    const scoped_refptr<base::TaskRunner>& worker_pool,
+    net::CacheType cache_type,
+    const base::FilePath& cache_directory)
+    : SimpleIndexFile(cache_thread, worker_pool, cache_type, cache_directory),
+      table_(new Table(cache_type, cache_directory, index_file())) {
+}
+
+SimpleMappedIndexFile::~SimpleMappedIndexFile() {
+  // Close the files on the cache thread once pending writes are done. The
+  // task holds the last reference to |table_|.
+  cache_thread()->PostTask(FROM_HERE, base::Bind(&Table::Close, table_));
+}
+
+void SimpleMappedIndexFile::LoadIndexEntries(
+    base::Time cache_last_modified,
+    const base::Closure& callback,
+    SimpleIndexLoadResult* out_result) {
+  cache_thread()->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&Table::Load, table_, cache_last_modified, out_result),
+      callback);
+}
+
+void SimpleMappedIndexFile::WriteToDisk(const SimpleIndex::EntrySet& entry_set,
+                                        uint64 cache_size,
+                                        const base::TimeTicks& start,
+                                        bool app_on_background,
+                                        const base::Closure& callback) {
+  scoped_ptr<SimpleIndex::EntrySet> entries(
+      new SimpleIndex::EntrySet(entry_set));
+  PostToCacheThread(base::Bind(&Table::WriteAll, table_,
+                               base::Passed(&entries), cache_size, start),
+                    callback);
+}
+
+bool SimpleMappedIndexFile::SupportsIncrementalWrites() const {
+  return true;
+}
+
+void SimpleMappedIndexFile::WriteChangesToDisk(
+    const SimpleIndex::EntrySet& changed_entries,
+    const SimpleIndex::HashList& removed_entries,
+    uint64 cache_size,
+    const base::TimeTicks& start,
+    bool app_on_background,
+    const base::Closure& callback) {
+  scoped_ptr<SimpleIndex::EntrySet> changed(
+      new SimpleIndex::EntrySet(changed_entries));
+  scoped_ptr<SimpleIndex::HashList> removed(
+      new SimpleIndex::HashList(removed_entries));
+  PostToCacheThread(base::Bind(&Table::WriteChanges, table_,
+                               base::Passed(&changed), base::Passed(&removed),
+                               cache_size, start),
+                    callback);
+}
+
+void SimpleMappedIndexFile::PostToCacheThread(const base::Closure& task,
+                                              const base::Closure& callback) {
+  if (callback.is_null())
+    cache_thread()->PostTask(FROM_HERE, task);
+  else
+    cache_thread()->PostTaskAndReply(FROM_HERE, task, callback);
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,81 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_MAPPED_INDEX_FILE_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_MAPPED_INDEX_FILE_H_
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "net/base/cache_type.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/simple/simple_index.h"
+#include "net/disk_cache/simple/simple_index_file.h"
+
+namespace base {
+class SingleThreadTaskRunner;
+class TaskRunner;
+}
+
+namespace disk_cache {
+
+// An index file that is kept up to date in place instead of being rewritten
+// on every flush.
+//
+// The file is a hash table of fixed-size entry records. It begins with a
+// header page, followed by a power-of-two number of page-sized buckets, and
+// an entry lives in the bucket selected by the low bits of its hash. The file
+// is memory-mapped on the cache thread. Each flush from SimpleIndex passes
+// only the entries that changed, which are appended to a small log file and
+// then written into their buckets. If the process dies while a batch is
+// being applied, the header is left marked dirty, and the next load replays
+// the log over the buckets and asks for the index to be written in full.
+// The log is truncated every few batches, once the mapped pages have been
+// flushed.
+//
+// A bucket that runs out of room, or a full WriteToDisk(), rebuilds the whole
+// file from a temporary copy, as SimpleIndexFile does on every write.
+//
+// All file operations, including the initial load, run on the cache thread so
+// that the mapping is only ever touched from one thread.
+class NET_EXPORT_PRIVATE SimpleMappedIndexFile : public SimpleIndexFile {
+ public:
+  SimpleMappedIndexFile(
+      const scoped_refptr<base::SingleThreadTaskRunner>& cache_thread,
+      const scoped_refptr<base::TaskRunner>& worker_pool,
+      net::CacheType cache_type,
+      const base::FilePath& cache_directory);
+  ~SimpleMappedIndexFile() override;
+
+  // SimpleIndexFile:
+  void LoadIndexEntries(base::Time cache_last_modified,
+                        const base::Closure& callback,
+                        SimpleIndexLoadResult* out_result) override;
+  void WriteToDisk(const SimpleIndex::EntrySet& entry_set,
+                   uint64 cache_size,
+                   const base::TimeTicks& start,
+                   bool app_on_background,
+                   const base::Closure& callback) override;
+  bool SupportsIncrementalWrites() const override;
+  void WriteChangesToDisk(const SimpleIndex::EntrySet& changed_entries,
+                          const SimpleIndex::HashList& removed_entries,
+                          uint64 cache_size,
+                          const base::TimeTicks& start,
+                          bool app_on_background,
+                          const base::Closure& callback) override;
+
+ private:
+  class Table;
+
+  void PostToCacheThread(const base::Closure& task,
+                         const base::Closure& callback);
+
+  // Only used on the cache thread; the last reference is released there.
+  scoped_refptr<Table> table_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleMappedIndexFile);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_MAPPED_INDEX_FILE_H_
@@ -4,14 +4,29 @@
 
 #include "net/dns/host_cache.h"
 
+#include <algorithm>
+
 #include "base/logging.h"
 #include "base/metrics/field_trial.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+#include "net/base/ip_address_number.h"
+#include "net/base/ip_endpoint.h"
 #include "net/base/net_errors.h"
 
 namespace net {
 
+namespace {
+
+const char kHostnameKey[] = "hostname";
+const char kAddressFamilyKey[] = "address_family";
+const char kFlagsKey[] = "flags";
+const char kExpirationKey[] = "expiration";
+const char kAddressesKey[] = "addresses";
+
+}  // namespace
+
 //-----------------------------------------------------------------------------
 
 HostCache::Entry::Entry(int error, const AddressList& addrlist,
@@ -49,6 +64,21 @@ const HostCache::Entry* HostCache::Lookup(const Key& key,
   return entries_.Get(key, now);
 }
 
+const HostCache::Entry* HostCache::LookupStale(const Key& key,
+                                               base::TimeTicks now,
+                                               base::TimeDelta* staleness) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(staleness);
+  if (caching_is_disabled())
+    return NULL;
+
+  base::TimeTicks expiration;
+  const Entry* entry = entries_.GetStale(key, &expiration);
+  if (entry)
+    *staleness = std::max(base::TimeDelta(), now - expiration);
+  return entry;
+}
+
 void HostCache::Set(const Key& key,
                     const Entry& entry,
                     base::TimeTicks now,
@@ -81,6 +111,90 @@ const HostCache::EntryMap& HostCache::entries() const {
   return entries_;
 }
 
+void HostCache::GetAsListValue(base::ListValue* entry_list) const {
+  DCHECK(CalledOnValidThread());
+  DCHECK(entry_list);
+
+  const base::TimeTicks now_ticks = base::TimeTicks::Now();
+  const base::Time now = base::Time::Now();
+
+  for (EntryMap::Iterator it(entries_); it.HasNext(); it.Advance()) {
+    const Key& key = it.key();
+    const Entry& entry = it.value();
+    // Negative results are cheap to redo and likely to be transient.
+    if (entry.error != OK || entry.addrlist.empty())
+      continue;
+
+    scoped_ptr<base::DictionaryValue> entry_dict(new base::DictionaryValue());
+    entry_dict->SetString(kHostnameKey, key.hostname);
+    entry_dict->SetInteger(kAddressFamilyKey,
+                           static_cast<int>(key.address_family));
+    entry_dict->SetInteger(kFlagsKey, key.host_resolver_flags);
+    entry_dict->SetDouble(kExpirationKey,
+                          (now + (it.expiration() - now_ticks)).ToDoubleT());
+
+    scoped_ptr<base::ListValue> addresses(new base::ListValue());
+    for (const IPEndPoint& address : entry.addrlist)
+      addresses->AppendString(address.ToStringWithoutPort());
+    entry_dict->Set(kAddressesKey, addresses.Pass());
+
+    entry_list->Append(entry_dict.Pass());
+  }
+}
+
+bool HostCache::RestoreFromListValue(const base::ListValue& entry_list,
+                                     base::TimeTicks now) {
+  DCHECK(CalledOnValidThread());
+
+  const base::Time wall_now = base::Time::Now();
+
+  for (size_t i = 0; i < entry_list.GetSize(); ++i) {
+    if (size() >= max_entries())
+      break;
+
+    const base::DictionaryValue* entry_dict = NULL;
+    std::string hostname;
+    int address_family;
+    int flags;
+    double expiration;
+    const base::ListValue* addresses = NULL;
+    if (!entry_list.GetDictionary(i, &entry_dict) ||
+        !entry_dict->GetString(kHostnameKey, &hostname) ||
+        !entry_dict->GetInteger(kAddressFamilyKey, &address_family) ||
+        address_family < ADDRESS_FAMILY_UNSPECIFIED ||
+        address_family > ADDRESS_FAMILY_LAST ||
+        !entry_dict->GetInteger(kFlagsKey, &flags) ||
+        !entry_dict->GetDouble(kExpirationKey, &expiration) ||
+        !entry_dict->GetList(kAddressesKey, &addresses)) {
+      return false;
+    }
+
+    AddressList address_list;
+    for (size_t j = 0; j < addresses->GetSize(); ++j) {
+      std::string address_string;
+      IPAddressNumber address;
+      if (!addresses->GetString(j, &address_string) ||
+          !ParseIPLiteralToNumber(address_string, &address)) {
+        return false;
+      }
+      address_list.push_back(IPEndPoint(address, 0));
+    }
+    if (address_list.empty())
+      continue;
+
+    Key key(hostname, static_cast<AddressFamily>(address_family), flags);
+    base::TimeTicks unused_expiration;
+    if (entries_.GetStale(key, &unused_expiration))
+      continue;
+
+    // Keep how long ago the entry expired, but never let it be fresh.
+    base::TimeDelta staleness = std::max(
+        base::TimeDelta(), wall_now - base::Time::FromDoubleT(expiration));
+    entries_.Put(key, Entry(OK, address_list), now, now - staleness);
+  }
+  return true;
+}
+
 // static
 scoped_ptr<HostCache> HostCache::CreateDefaultCache() {
   // Cache capacity is determined by the field trial.
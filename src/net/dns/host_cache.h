@@ -17,6 +17,10 @@
 #include "net/base/expiring_cache.h"
 #include "net/base/net_export.h"
 
+namespace base {
+class ListValue;
+}
+
 namespace net {
 
 // Cache used by HostResolver to map hostnames to their resolved result.
@@ -82,6 +86,13 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // |now|. If there is no such entry, returns NULL.
   const Entry* Lookup(const Key& key, base::TimeTicks now);
 
+  // Returns a pointer to the entry for |key| even if it has expired by |now|,
+  // without evicting it. Sets |*staleness| to how long ago the entry expired,
+  // or to zero if it is still valid. If there is no such entry, returns NULL.
+  const Entry* LookupStale(const Key& key,
+                           base::TimeTicks now,
+                           base::TimeDelta* staleness);
+
   // Overwrites or creates an entry for |key|.
   // |entry| is the value to set, |now| is the current time
   // |ttl| is the "time to live".
@@ -96,6 +107,20 @@ class NET_EXPORT HostCache : NON_EXPORTED_BASE(public base::NonThreadSafe) {
   // Returns the number of entries in the cache.
   size_t size() const;
 
+  // Appends a serialized copy of every successful entry to |entry_list|.
+  // Expirations are stored as wall-clock times so that the snapshot stays
+  // meaningful across restarts.
+  void GetAsListValue(base::ListValue* entry_list) const;
+
+  // Adds the entries serialized by GetAsListValue() in |entry_list| to the
+  // cache. Restored entries are always stale: they are expired at |now| (or
+  // earlier, if their original expiration has passed), so only LookupStale()
+  // returns them. Entries already in the cache are not overwritten, and
+  // restoring stops once the cache is full. Returns false if |entry_list| was
+  // malformed; entries parsed up to that point are kept.
+  bool RestoreFromListValue(const base::ListValue& entry_list,
+                            base::TimeTicks now);
+
   // Following are used by net_internals UI.
   size_t max_entries() const;
 
@@ -0,0 +1,98 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/dns/host_cache_persister.h"
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/location.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/sequenced_task_runner.h"
+#include "base/task_runner_util.h"
+#include "base/values.h"
+#include "net/dns/host_cache.h"
+
+namespace net {
+
+namespace {
+
+// How often a snapshot of the cache is written while the persister is alive.
+const int kSnapshotIntervalMinutes = 5;
+
+std::string LoadSnapshot(const base::FilePath& path) {
+  std::string result;
+  if (!base::ReadFileToString(path, &result))
+    return std::string();
+  return result;
+}
+
+}  // namespace
+
+HostCachePersister::HostCachePersister(
+    HostCache* cache,
+    const base::FilePath& path,
+    const scoped_refptr<base::SequencedTaskRunner>& background_runner)
+    : cache_(cache),
+      writer_(path, background_runner),
+      weak_ptr_factory_(this) {
+  DCHECK(cache_);
+
+  base::PostTaskAndReplyWithResult(
+      background_runner.get(), FROM_HERE,
+      base::Bind(&LoadSnapshot, writer_.path()),
+      base::Bind(&HostCachePersister::CompleteLoad,
+                 weak_ptr_factory_.GetWeakPtr()));
+
+  snapshot_timer_.Start(FROM_HERE,
+                        base::TimeDelta::FromMinutes(kSnapshotIntervalMinutes),
+                        this, &HostCachePersister::OnSnapshotTimer);
+}
+
+HostCachePersister::~HostCachePersister() {
+  DCHECK(CalledOnValidThread());
+
+  writer_.ScheduleWrite(this);
+  writer_.DoScheduledWrite();
+}
+
+bool HostCachePersister::SerializeData(std::string* data) {
+  DCHECK(CalledOnValidThread());
+
+  base::ListValue entries;
+  cache_->GetAsListValue(&entries);
+  UMA_HISTOGRAM_COUNTS_1000("DNS.CacheSnapshotEntriesWritten",
+                            entries.GetSize());
+  return base::JSONWriter::Write(entries, data);
+}
+
+void HostCachePersister::CompleteLoad(const std::string& serialized) {
+  DCHECK(CalledOnValidThread());
+
+  if (serialized.empty())
+    return;
+
+  scoped_ptr<base::Value> value = base::JSONReader::Read(serialized);
+  base::ListValue* entries = NULL;
+  if (!value || !value->GetAsList(&entries)) {
+    UMA_HISTOGRAM_BOOLEAN("DNS.CacheSnapshotRestored", false);
+    return;
+  }
+
+  const size_t size_before = cache_->size();
+  bool restored = cache_->RestoreFromListValue(*entries,
+                                               base::TimeTicks::Now());
+  UMA_HISTOGRAM_BOOLEAN("DNS.CacheSnapshotRestored", restored);
+  UMA_HISTOGRAM_COUNTS_1000("DNS.CacheSnapshotEntriesRestored",
+                            cache_->size() - size_before);
+}
+
+void HostCachePersister::OnSnapshotTimer() {
+  DCHECK(CalledOnValidThread());
+  writer_.ScheduleWrite(this);
+}
+
+}  // namespace net
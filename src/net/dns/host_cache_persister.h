@@ -0,0 +1,80 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// HostCachePersister keeps a snapshot of a HostCache on disk so that a new
+// session does not start with an empty cache.
+//
+// At construction, a Task is posted to |background_runner| that reads the
+// snapshot. Once it is read, its entries are added to the HostCache as stale
+// entries (see HostCache::RestoreFromListValue()), which a HostResolverImpl
+// with stale-while-refresh enabled serves while refreshing them.
+//
+// A new snapshot is written periodically, and once more when the persister is
+// destroyed, using an ImportantFileWriter so that a crash during the write
+// cannot leave a truncated file behind.
+
+#ifndef NET_DNS_HOST_CACHE_PERSISTER_H_
+#define NET_DNS_HOST_CACHE_PERSISTER_H_
+
+#include <string>
+
+#include "base/files/important_file_writer.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/threading/non_thread_safe.h"
+#include "base/timer/timer.h"
+#include "net/base/net_export.h"
+
+namespace base {
+class FilePath;
+class SequencedTaskRunner;
+}
+
+namespace net {
+
+class HostCache;
+
+// Reads and writes the on-disk snapshot of |cache|. Must be created, used and
+// destroyed on the thread that owns |cache|, and must be destroyed before
+// |cache|.
+class NET_EXPORT HostCachePersister
+    : public base::ImportantFileWriter::DataSerializer,
+      NON_EXPORTED_BASE(public base::NonThreadSafe) {
+ public:
+  // |path| is the file holding the snapshot. All file IO happens on
+  // |background_runner|.
+  HostCachePersister(
+      HostCache* cache,
+      const base::FilePath& path,
+      const scoped_refptr<base::SequencedTaskRunner>& background_runner);
+  ~HostCachePersister() override;
+
+  // ImportantFileWriter::DataSerializer:
+  //
+  // Serializes the successful entries of |cache_| as a JSON list; see
+  // HostCache::GetAsListValue() for the format of each entry.
+  bool SerializeData(std::string* data) override;
+
+ private:
+  // Restores the snapshot read from disk into |cache_|.
+  void CompleteLoad(const std::string& serialized);
+
+  // Called by |snapshot_timer_|.
+  void OnSnapshotTimer();
+
+  HostCache* cache_;
+
+  // Helper for safely writing the data.
+  base::ImportantFileWriter writer_;
+
+  base::RepeatingTimer snapshot_timer_;
+
+  base::WeakPtrFactory<HostCachePersister> weak_ptr_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(HostCachePersister);
+};
+
+}  // namespace net
+
+#endif  // NET_DNS_HOST_CACHE_PERSISTER_H_
@@ -1249,6 +1249,7 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
         key_(key),
         priority_tracker_(priority),
         had_non_speculative_request_(false),
+        is_stale_refresh_(false),
         had_dns_config_(false),
         num_occupied_job_slots_(0),
         dns_task_error_(OK),
@@ -1359,7 +1360,8 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
                                  req->source_net_log().source(),
                                  priority()));
 
-    if (num_active_requests() > 0) {
+    if (num_active_requests() > 0 || is_stale_refresh_) {
+      // A stale refresh runs to completion without requests.
       UpdatePriority();
     } else {
       // If we were called from a Request's callback within CompleteRequests,
@@ -1401,7 +1403,10 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
   // Attempts to serve the job from HOSTS. Returns true if succeeded and
   // this Job was destroyed.
   bool ServeFromHosts() {
-    DCHECK_GT(num_active_requests(), 0u);
+    // A stale refresh may have no request to serve, or only cancelled ones;
+    // let it run.
+    if (num_active_requests() == 0)
+      return false;
     AddressList addr_list;
     if (resolver_->ServeFromHosts(key(),
                                   requests_.front()->info(),
@@ -1417,6 +1422,10 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
   const Key& key() const { return key_; }
 
+  // Marks this Job as refreshing a stale cache entry, so it keeps running and
+  // caches its result even when no Request is attached.
+  void set_is_stale_refresh() { is_stale_refresh_ = true; }
+
   bool is_queued() const {
     return !handle_.is_null();
   }
@@ -1705,7 +1714,12 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
       handle_.Reset();
     }
 
+    bool did_complete = (entry.error != ERR_NETWORK_CHANGED) &&
+                        (entry.error != ERR_HOST_RESOLVER_QUEUE_TOO_LARGE);
+
     if (num_active_requests() == 0) {
+      if (is_stale_refresh_ && did_complete)
+        resolver_->CacheResult(key_, entry, ttl);
       net_log_.AddEvent(NetLog::TYPE_CANCELLED);
       net_log_.EndEventWithNetErrorCode(NetLog::TYPE_HOST_RESOLVER_IMPL_JOB,
                                         OK);
@@ -1724,8 +1738,6 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
                             resolver_->received_dns_config_);
     }
 
-    bool did_complete = (entry.error != ERR_NETWORK_CHANGED) &&
-                        (entry.error != ERR_HOST_RESOLVER_QUEUE_TOO_LARGE);
     if (did_complete)
       resolver_->CacheResult(key_, entry, ttl);
 
@@ -1786,6 +1798,9 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
   bool had_non_speculative_request_;
 
+  // True if this Job was started to refresh a stale cache entry.
+  bool is_stale_refresh_;
+
   // Distinguishes measurements taken while DnsClient was fully configured.
   bool had_dns_config_;
 
@@ -1841,6 +1856,7 @@ HostResolverImpl::HostResolverImpl(const Options& options, NetLog* net_log)
       resolved_known_ipv6_hostname_(false),
       additional_resolver_flags_(0),
       fallback_to_proctask_(true),
+      serve_stale_(false),
       weak_ptr_factory_(this),
       probe_weak_ptr_factory_(this) {
   if (options.enable_caching)
@@ -1919,10 +1935,14 @@ int HostResolverImpl::Resolve(const RequestInfo& info,
   // outstanding jobs map.
   Key key = GetEffectiveKeyForRequest(info, ip_number_ptr, source_net_log);
 
-  int rv = ResolveHelper(key, info, ip_number_ptr, addresses, source_net_log);
+  bool served_stale = false;
+  int rv = ResolveHelper(key, info, ip_number_ptr, addresses, &served_stale,
+                         source_net_log);
   if (rv != ERR_DNS_CACHE_MISS) {
     LogFinishRequest(source_net_log, info, rv);
     RecordTotalTime(HaveDnsConfig(), info.is_speculative(), base::TimeDelta());
+    if (served_stale)
+      RefreshStaleEntry(key, source_net_log);
     return rv;
   }
 
@@ -1967,6 +1987,7 @@ int HostResolverImpl::ResolveHelper(const Key& key,
                                     const RequestInfo& info,
                                     const IPAddressNumber* ip_number,
                                     AddressList* addresses,
+                                    bool* served_stale,
                                     const BoundNetLog& source_net_log) {
   // The result of |getaddrinfo| for empty hosts is inconsistent across systems.
   // On Windows it gives the default interface's address, whereas on Linux it
@@ -1977,7 +1998,7 @@ int HostResolverImpl::ResolveHelper(const Key& key,
   int net_error = ERR_UNEXPECTED;
   if (ResolveAsIP(key, info, ip_number, &net_error, addresses))
     return net_error;
-  if (ServeFromCache(key, info, &net_error, addresses)) {
+  if (ServeFromCache(key, info, &net_error, addresses, served_stale)) {
     source_net_log.AddEvent(NetLog::TYPE_HOST_RESOLVER_IMPL_CACHE_HIT);
     return net_error;
   }
@@ -2010,7 +2031,11 @@ int HostResolverImpl::ResolveFromCache(const RequestInfo& info,
 
   Key key = GetEffectiveKeyForRequest(info, ip_number_ptr, source_net_log);
 
-  int rv = ResolveHelper(key, info, ip_number_ptr, addresses, source_net_log);
+  // There is no job to refresh a stale result from here; the next Resolve()
+  // for |key| will start one.
+  bool served_stale = false;
+  int rv = ResolveHelper(key, info, ip_number_ptr, addresses, &served_stale,
+                         source_net_log);
   LogFinishRequest(source_net_log, info, rv);
   return rv;
 }
@@ -2035,6 +2060,13 @@ void HostResolverImpl::SetDnsClientEnabled(bool enabled) {
 #endif
 }
 
+void HostResolverImpl::EnableStaleWhileRefresh(base::TimeDelta max_staleness) {
+  DCHECK(CalledOnValidThread());
+  DCHECK(max_staleness >= base::TimeDelta());
+  serve_stale_ = true;
+  max_staleness_ = max_staleness;
+}
+
 HostCache* HostResolverImpl::GetHostCache() {
   return cache_.get();
 }
@@ -2085,14 +2117,29 @@ bool HostResolverImpl::ResolveAsIP(const Key& key,
 bool HostResolverImpl::ServeFromCache(const Key& key,
                                       const RequestInfo& info,
                                       int* net_error,
-                                      AddressList* addresses) {
+                                      AddressList* addresses,
+                                      bool* is_stale) {
   DCHECK(addresses);
   DCHECK(net_error);
+  DCHECK(is_stale);
   if (!info.allow_cached_response() || !cache_.get())
     return false;
 
-  const HostCache::Entry* cache_entry = cache_->Lookup(
-      key, base::TimeTicks::Now());
+  const HostCache::Entry* cache_entry = NULL;
+  if (serve_stale_) {
+    base::TimeDelta staleness;
+    cache_entry = cache_->LookupStale(key, base::TimeTicks::Now(), &staleness);
+    if (cache_entry && staleness > base::TimeDelta()) {
+      // Expired negative entries are not worth serving.
+      if (cache_entry->error != OK || staleness > max_staleness_)
+        return false;
+      UMA_HISTOGRAM_CUSTOM_TIMES("DNS.StaleCacheHitAge", staleness,
+          base::TimeDelta::FromSeconds(1), base::TimeDelta::FromDays(1), 100);
+      *is_stale = true;
+    }
+  } else {
+    cache_entry = cache_->Lookup(key, base::TimeTicks::Now());
+  }
   if (!cache_entry)
     return false;
 
@@ -2189,6 +2236,27 @@ void HostResolverImpl::CacheResult(const Key& key,
     cache_->Set(key, entry, base::TimeTicks::Now(), ttl);
 }
 
+void HostResolverImpl::RefreshStaleEntry(const Key& key,
+                                         const BoundNetLog& source_net_log) {
+  if (jobs_.find(key) != jobs_.end())
+    return;
+
+  Job* job = new Job(weak_ptr_factory_.GetWeakPtr(), key, MINIMUM_PRIORITY,
+                     source_net_log);
+  job->set_is_stale_refresh();
+  job->Schedule(false);
+
+  // Do not let a refresh push a real request out of a full queue.
+  if (dispatcher_->num_queued_jobs() > max_queued_jobs_) {
+    Job* evicted = static_cast<Job*>(dispatcher_->EvictOldestLowest());
+    DCHECK(evicted);
+    evicted->OnEvicted();  // Deletes |evicted|.
+    if (evicted == job)
+      return;
+  }
+  jobs_.insert(std::make_pair(key, job));
+}
+
 void HostResolverImpl::RemoveJob(Job* job) {
   DCHECK(job);
   JobMap::iterator it = jobs_.find(job->key());
@@ -123,6 +123,12 @@ class NET_EXPORT HostResolverImpl
   // NetworkChangeNotifier.
   void SetDnsClient(scoped_ptr<DnsClient> dns_client);
 
+  // Enables serving successful cache entries that expired at most
+  // |max_staleness| ago, such as those restored by a HostCachePersister.
+  // Resolve() completes synchronously with the stale addresses and starts a
+  // lowest priority job that refreshes the entry in the background.
+  void EnableStaleWhileRefresh(base::TimeDelta max_staleness);
+
   // HostResolver methods:
   int Resolve(const RequestInfo& info,
               RequestPriority priority,
@@ -161,11 +167,13 @@ class NET_EXPORT HostResolverImpl
   // literal, cache and HOSTS lookup (if enabled), returns OK if successful,
   // ERR_NAME_NOT_RESOLVED if either hostname is invalid or IP literal is
   // incompatible, ERR_DNS_CACHE_MISS if entry was not found in cache and
-  // HOSTS and is not localhost.
+  // HOSTS and is not localhost. Sets |*served_stale| to true if the result
+  // came from an expired cache entry.
   int ResolveHelper(const Key& key,
                     const RequestInfo& info,
                     const IPAddressNumber* ip_address,
                     AddressList* addresses,
+                    bool* served_stale,
                     const BoundNetLog& request_net_log);
 
   // Tries to resolve |key| as an IP, returns true and sets |net_error| if
@@ -178,11 +186,14 @@ class NET_EXPORT HostResolverImpl
 
   // If |key| is not found in cache returns false, otherwise returns
   // true, sets |net_error| to the cached error code and fills |addresses|
-  // if it is a positive entry.
+  // if it is a positive entry. If stale-while-refresh is enabled, a positive
+  // entry that expired less than |max_staleness_| ago is also served, and
+  // |*is_stale| is set to true.
   bool ServeFromCache(const Key& key,
                       const RequestInfo& info,
                       int* net_error,
-                      AddressList* addresses);
+                      AddressList* addresses,
+                      bool* is_stale);
 
   // If we have a DnsClient with a valid DnsConfig, and |key| is found in the
   // HOSTS file, returns true and fills |addresses|. Otherwise returns false.
@@ -216,6 +227,10 @@ class NET_EXPORT HostResolverImpl
                    const HostCache::Entry& entry,
                    base::TimeDelta ttl);
 
+  // Starts a job with no requests attached that re-resolves |key| and updates
+  // the cache, unless a job for |key| is already in |jobs_|.
+  void RefreshStaleEntry(const Key& key, const BoundNetLog& source_net_log);
+
   // Removes |job| from |jobs_|, only if it exists.
   void RemoveJob(Job* job);
 
@@ -299,6 +314,11 @@ class NET_EXPORT HostResolverImpl
   // Allow fallback to ProcTask if DnsTask fails.
   bool fallback_to_proctask_;
 
+  // If true, expired cache entries younger than |max_staleness_| are served
+  // while they are refreshed. See EnableStaleWhileRefresh().
+  bool serve_stale_;
+  base::TimeDelta max_staleness_;
+
   base::WeakPtrFactory<HostResolverImpl> weak_ptr_factory_;
 
   base::WeakPtrFactory<HostResolverImpl> probe_weak_ptr_factory_;
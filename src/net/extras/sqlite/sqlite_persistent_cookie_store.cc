@@ -19,6 +19,7 @@
 #include "base/metrics/histogram_macros.h"
 #include "base/profiler/scoped_tracker.h"
 #include "base/sequenced_task_runner.h"
+#include "base/stl_util.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
@@ -44,6 +45,41 @@ namespace {
 // CPU or I/O with these low priority requests immediately after start up.
 const int kLoadDelayMilliseconds = 0;
 
+// With write coalescing enabled, the number of commits between two passive
+// WAL checkpoints.
+const int kCommitsPerCheckpoint = 8;
+
+// Rows written per multi-row INSERT and DELETE statement. An INSERT binds 14
+// variables per row, which keeps it below SQLite's default limit of 999.
+const size_t kRowsPerInsertStatement = 64;
+const size_t kRowsPerDeleteStatement = 256;
+
+// Returns an INSERT into the cookies table with |rows| rows of values.
+std::string MakeMultiRowInsertSQL(size_t rows) {
+  std::string sql(
+      "INSERT INTO cookies (creation_utc, host_key, name, value, "
+      "encrypted_value, path, expires_utc, secure, httponly, firstpartyonly, "
+      "last_access_utc, has_expires, persistent, priority) VALUES ");
+  for (size_t i = 0; i < rows; ++i) {
+    if (i)
+      sql.push_back(',');
+    sql.append("(?,?,?,?,?,?,?,?,?,?,?,?,?,?)");
+  }
+  return sql;
+}
+
+// Returns a DELETE of |rows| cookies selected by creation time.
+std::string MakeMultiRowDeleteSQL(size_t rows) {
+  std::string sql("DELETE FROM cookies WHERE creation_utc IN (");
+  for (size_t i = 0; i < rows; ++i) {
+    if (i)
+      sql.push_back(',');
+    sql.push_back('?');
+  }
+  sql.push_back(')');
+  return sql;
+}
+
 }  // namespace
 
 namespace net {
@@ -70,6 +106,14 @@ namespace net {
 // AddCookie, UpdateCookieAccessTime, and DeleteCookie. These are flushed to
 // disk on the BG runner every 30 seconds, 512 operations, or call to Flush(),
 // whichever occurs first.
+//
+// If write coalescing is enabled, Commit() folds all operations queued for the
+// same cookie (keyed by creation time, the table's primary key) into at most
+// one DELETE followed by one ADD or access time UPDATE, and writes the
+// surviving DELETEs and ADDs with multi-row statements. The database is then
+// kept in WAL mode with automatic checkpoints disabled; instead a passive
+// checkpoint is posted to the BG runner every few commits, so that commits
+// only append to the WAL.
 class SQLitePersistentCookieStore::Backend
     : public base::RefCountedThreadSafe<SQLitePersistentCookieStore::Backend> {
  public:
@@ -84,6 +128,9 @@ class SQLitePersistentCookieStore::Backend
         initialized_(false),
         corruption_detected_(false),
         restore_old_session_cookies_(restore_old_session_cookies),
+        coalesce_writes_(false),
+        wal_enabled_(false),
+        commits_since_checkpoint_(0),
         num_cookies_read_(0),
         client_task_runner_(client_task_runner),
         background_task_runner_(background_task_runner),
@@ -122,6 +169,10 @@ class SQLitePersistentCookieStore::Backend
   // Post background delete of all cookies that match |cookies|.
   void DeleteAllInList(const std::list<CookieOrigin>& cookies);
 
+  // Switches Commit() to coalesced, multi-row writes and the database to WAL
+  // mode. Must be called before any task is posted to the background runner.
+  void EnableWriteCoalescing();
+
  private:
   friend class base::RefCountedThreadSafe<SQLitePersistentCookieStore::Backend>;
 
@@ -158,6 +209,8 @@ class SQLitePersistentCookieStore::Backend
     CanonicalCookie cc_;
   };
 
+  typedef std::list<PendingOperation*> PendingOperationsList;
+
  private:
   // Creates or loads the SQLite database on background runner.
   void LoadAndNotifyInBackground(const LoadedCallback& loaded_callback,
@@ -209,6 +262,19 @@ class SQLitePersistentCookieStore::Backend
                       const CanonicalCookie& cc);
   // Commit our pending operations to the database.
   void Commit();
+  // Writes |ops| one statement per operation. Takes ownership of the
+  // operations in |ops|.
+  void CommitOperations(PendingOperationsList* ops);
+  // Writes |ops| after folding together the operations on each cookie. Takes
+  // ownership of the operations in |ops|.
+  void CommitCoalescedOperations(PendingOperationsList* ops);
+  // Binds the 14 columns of an insert of |cc| starting at |first_column|.
+  // Returns false if the value of |cc| could not be encrypted.
+  bool BindCookieForInsert(sql::Statement* statement,
+                           int first_column,
+                           const CanonicalCookie& cc);
+  // Runs a passive WAL checkpoint on the background runner.
+  void CheckpointInBackground();
   // Close() executed on the background runner.
   void InternalBackgroundClose(const base::Closure& callback);
 
@@ -233,7 +299,6 @@ class SQLitePersistentCookieStore::Backend
   scoped_ptr<sql::Connection> db_;
   sql::MetaTable meta_table_;
 
-  typedef std::list<PendingOperation*> PendingOperationsList;
   PendingOperationsList pending_;
   PendingOperationsList::size_type num_pending_;
   // Guard |cookies_|, |pending_|, |num_pending_|.
@@ -258,6 +323,16 @@ class SQLitePersistentCookieStore::Backend
   // If false, we should filter out session cookies when reading the DB.
   bool restore_old_session_cookies_;
 
+  // If true, Commit() coalesces operations and the DB is opened in WAL mode.
+  // Set before the first background task and only read on the BG runner
+  // afterwards.
+  bool coalesce_writes_;
+
+  // Whether the DB was successfully switched to WAL mode. Only accessed on the
+  // background runner, as is |commits_since_checkpoint_|.
+  bool wal_enabled_;
+  int commits_since_checkpoint_;
+
   // The cumulative time spent loading the cookies on the background runner.
   // Incremented and reported from the background runner.
   base::TimeDelta cookie_load_duration_;
@@ -611,6 +686,18 @@ bool SQLitePersistentCookieStore::Backend::InitializeDatabase() {
     return false;
   }
 
+  if (coalesce_writes_) {
+    // Commits only append to the WAL; checkpoints are scheduled by Commit()
+    // rather than run inline by SQLite. Staying in the connection's default
+    // journal mode is fine if WAL is unavailable.
+    sql::Statement journal_mode(
+        db_->GetUniqueStatement("PRAGMA journal_mode=WAL"));
+    wal_enabled_ = journal_mode.Step() && journal_mode.ColumnString(0) == "wal";
+    if (wal_enabled_)
+      ignore_result(db_->Execute("PRAGMA wal_autocheckpoint=0"));
+    UMA_HISTOGRAM_BOOLEAN("Cookie.WALEnabled", wal_enabled_);
+  }
+
   if (!EnsureDatabaseVersion() || !InitTable(db_.get())) {
     NOTREACHED() << "Unable to open cookie DB.";
     if (corruption_detected_)
@@ -1061,6 +1148,26 @@ void SQLitePersistentCookieStore::Backend::Commit() {
   if (!db_.get() || ops.empty())
     return;
 
+  const base::Time start = base::Time::Now();
+  if (coalesce_writes_)
+    CommitCoalescedOperations(&ops);
+  else
+    CommitOperations(&ops);
+  UMA_HISTOGRAM_CUSTOM_TIMES("Cookie.TimeCommit", base::Time::Now() - start,
+                             base::TimeDelta::FromMilliseconds(1),
+                             base::TimeDelta::FromMinutes(1), 50);
+
+  if (wal_enabled_ && ++commits_since_checkpoint_ >= kCommitsPerCheckpoint) {
+    commits_since_checkpoint_ = 0;
+    // Posted rather than run inline so that a pending Flush() callback is not
+    // delayed by the checkpoint.
+    PostBackgroundTask(FROM_HERE,
+                       base::Bind(&Backend::CheckpointInBackground, this));
+  }
+}
+
+void SQLitePersistentCookieStore::Backend::CommitOperations(
+    PendingOperationsList* ops) {
   sql::Statement add_smt(db_->GetCachedStatement(
       SQL_FROM_HERE,
       "INSERT INTO cookies (creation_utc, host_key, name, value, "
@@ -1085,38 +1192,15 @@ void SQLitePersistentCookieStore::Backend::Commit() {
   if (!transaction.Begin())
     return;
 
-  for (PendingOperationsList::iterator it = ops.begin(); it != ops.end();
+  for (PendingOperationsList::iterator it = ops->begin(); it != ops->end();
        ++it) {
     // Free the cookies as we commit them to the database.
     scoped_ptr<PendingOperation> po(*it);
     switch (po->op()) {
       case PendingOperation::COOKIE_ADD:
         add_smt.Reset(true);
-        add_smt.BindInt64(0, po->cc().CreationDate().ToInternalValue());
-        add_smt.BindString(1, po->cc().Domain());
-        add_smt.BindString(2, po->cc().Name());
-        if (crypto_ && crypto_->ShouldEncrypt()) {
-          std::string encrypted_value;
-          if (!crypto_->EncryptString(po->cc().Value(), &encrypted_value))
-            continue;
-          add_smt.BindCString(3, "");  // value
-          // BindBlob() immediately makes an internal copy of the data.
-          add_smt.BindBlob(4, encrypted_value.data(),
-                           static_cast<int>(encrypted_value.length()));
-        } else {
-          add_smt.BindString(3, po->cc().Value());
-          add_smt.BindBlob(4, "", 0);  // encrypted_value
-        }
-        add_smt.BindString(5, po->cc().Path());
-        add_smt.BindInt64(6, po->cc().ExpiryDate().ToInternalValue());
-        add_smt.BindInt(7, po->cc().IsSecure());
-        add_smt.BindInt(8, po->cc().IsHttpOnly());
-        add_smt.BindInt(9, po->cc().IsFirstPartyOnly());
-        add_smt.BindInt64(10, po->cc().LastAccessDate().ToInternalValue());
-        add_smt.BindInt(11, po->cc().IsPersistent());
-        add_smt.BindInt(12, po->cc().IsPersistent());
-        add_smt.BindInt(13,
-                        CookiePriorityToDBCookiePriority(po->cc().Priority()));
+        if (!BindCookieForInsert(&add_smt, 0, po->cc()))
+          continue;
         if (!add_smt.Run())
           NOTREACHED() << "Could not add a cookie to the DB.";
         break;
@@ -1148,6 +1232,233 @@ void SQLitePersistentCookieStore::Backend::Commit() {
                             succeeded ? 0 : 1, 2);
 }
 
+void SQLitePersistentCookieStore::Backend::CommitCoalescedOperations(
+    PendingOperationsList* ops) {
+  // The net effect of the operations queued for one cookie is at most a
+  // DELETE of the stored row followed by either an ADD or an access time
+  // UPDATE, carrying the most recent copy of the cookie.
+  struct CoalescedOperation {
+    CoalescedOperation()
+        : delete_first(false),
+          op(PendingOperation::COOKIE_ADD),
+          cc(nullptr) {}
+
+    bool delete_first;
+    PendingOperation::OperationType op;
+    const CanonicalCookie* cc;
+  };
+
+  // Keyed by creation time so the rows are written in primary key order.
+  std::map<int64, CoalescedOperation> coalesced;
+  for (const PendingOperation* po : *ops) {
+    CoalescedOperation& entry =
+        coalesced[po->cc().CreationDate().ToInternalValue()];
+    switch (po->op()) {
+      case PendingOperation::COOKIE_ADD:
+        entry.op = PendingOperation::COOKIE_ADD;
+        entry.cc = &po->cc();
+        break;
+
+      case PendingOperation::COOKIE_UPDATEACCESS:
+        // An update of a deleted cookie is a no-op, and an update of a cookie
+        // added in this window just adds the newer copy.
+        if (!entry.cc && entry.delete_first)
+          break;
+        if (!entry.cc)
+          entry.op = PendingOperation::COOKIE_UPDATEACCESS;
+        entry.cc = &po->cc();
+        break;
+
+      case PendingOperation::COOKIE_DELETE:
+        entry.delete_first = true;
+        entry.cc = nullptr;
+        break;
+
+      default:
+        NOTREACHED();
+        break;
+    }
+  }
+
+  std::vector<int64> deletes;
+  std::vector<const CanonicalCookie*> adds;
+  std::vector<const CanonicalCookie*> updates;
+  for (const auto& entry : coalesced) {
+    if (entry.second.delete_first)
+      deletes.push_back(entry.first);
+    if (!entry.second.cc)
+      continue;
+    if (entry.second.op == PendingOperation::COOKIE_ADD)
+      adds.push_back(entry.second.cc);
+    else
+      updates.push_back(entry.second.cc);
+  }
+
+  UMA_HISTOGRAM_COUNTS(
+      "Cookie.CommitCoalescedOperations",
+      ops->size() - deletes.size() - adds.size() - updates.size());
+
+  // |ops| owns the cookies referenced from |adds| and |updates|.
+  STLElementDeleter<PendingOperationsList> ops_deleter(ops);
+
+  sql::Transaction transaction(db_.get());
+  if (!transaction.Begin())
+    return;
+
+  // The deletes go first so that a cookie deleted and re-added within the
+  // window is not rejected by the primary key.
+  size_t index = 0;
+  if (deletes.size() >= kRowsPerDeleteStatement) {
+    const std::string sql = MakeMultiRowDeleteSQL(kRowsPerDeleteStatement);
+    sql::Statement del_smt(
+        db_->GetCachedStatement(SQL_FROM_HERE, sql.c_str()));
+    if (!del_smt.is_valid())
+      return;
+    for (; deletes.size() - index >= kRowsPerDeleteStatement;
+         index += kRowsPerDeleteStatement) {
+      del_smt.Reset(true);
+      for (size_t row = 0; row < kRowsPerDeleteStatement; ++row)
+        del_smt.BindInt64(row, deletes[index + row]);
+      if (!del_smt.Run())
+        NOTREACHED() << "Could not delete cookies from the DB.";
+    }
+  }
+  if (index < deletes.size()) {
+    sql::Statement del_smt(db_->GetCachedStatement(
+        SQL_FROM_HERE, "DELETE FROM cookies WHERE creation_utc=?"));
+    if (!del_smt.is_valid())
+      return;
+    for (; index < deletes.size(); ++index) {
+      del_smt.Reset(true);
+      del_smt.BindInt64(0, deletes[index]);
+      if (!del_smt.Run())
+        NOTREACHED() << "Could not delete a cookie from the DB.";
+    }
+  }
+
+  sql::Statement add_smt(db_->GetCachedStatement(
+      SQL_FROM_HERE,
+      "INSERT INTO cookies (creation_utc, host_key, name, value, "
+      "encrypted_value, path, expires_utc, secure, httponly, firstpartyonly, "
+      "last_access_utc, has_expires, persistent, priority) "
+      "VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?,?)"));
+  if (!add_smt.is_valid())
+    return;
+
+  // Whole chunks of cookies are inserted with a single statement. A chunk
+  // that cannot be written that way, e.g. because one of its values failed to
+  // encrypt, is retried row by row so that only the offending cookies are
+  // lost, as with the uncoalesced commit.
+  index = 0;
+  if (adds.size() >= kRowsPerInsertStatement) {
+    const std::string sql = MakeMultiRowInsertSQL(kRowsPerInsertStatement);
+    sql::Statement multi_add_smt(
+        db_->GetCachedStatement(SQL_FROM_HERE, sql.c_str()));
+    if (!multi_add_smt.is_valid())
+      return;
+    for (; adds.size() - index >= kRowsPerInsertStatement;
+         index += kRowsPerInsertStatement) {
+      multi_add_smt.Reset(true);
+      bool bound = true;
+      for (size_t row = 0; bound && row < kRowsPerInsertStatement; ++row) {
+        bound = BindCookieForInsert(&multi_add_smt, row * 14,
+                                    *adds[index + row]);
+      }
+      if (bound && multi_add_smt.Run())
+        continue;
+      for (size_t row = 0; row < kRowsPerInsertStatement; ++row) {
+        add_smt.Reset(true);
+        if (!BindCookieForInsert(&add_smt, 0, *adds[index + row]))
+          continue;
+        if (!add_smt.Run())
+          NOTREACHED() << "Could not add a cookie to the DB.";
+      }
+    }
+  }
+  for (; index < adds.size(); ++index) {
+    add_smt.Reset(true);
+    if (!BindCookieForInsert(&add_smt, 0, *adds[index]))
+      continue;
+    if (!add_smt.Run())
+      NOTREACHED() << "Could not add a cookie to the DB.";
+  }
+
+  if (!updates.empty()) {
+    sql::Statement update_access_smt(db_->GetCachedStatement(
+        SQL_FROM_HERE,
+        "UPDATE cookies SET last_access_utc=? WHERE creation_utc=?"));
+    if (!update_access_smt.is_valid())
+      return;
+    for (const CanonicalCookie* cc : updates) {
+      update_access_smt.Reset(true);
+      update_access_smt.BindInt64(0, cc->LastAccessDate().ToInternalValue());
+      update_access_smt.BindInt64(1, cc->CreationDate().ToInternalValue());
+      if (!update_access_smt.Run())
+        NOTREACHED() << "Could not update cookie last access time in the DB.";
+    }
+  }
+
+  bool succeeded = transaction.Commit();
+  UMA_HISTOGRAM_ENUMERATION("Cookie.BackingStoreUpdateResults",
+                            succeeded ? 0 : 1, 2);
+}
+
+bool SQLitePersistentCookieStore::Backend::BindCookieForInsert(
+    sql::Statement* statement,
+    int first_column,
+    const CanonicalCookie& cc) {
+  const int col = first_column;
+  statement->BindInt64(col, cc.CreationDate().ToInternalValue());
+  statement->BindString(col + 1, cc.Domain());
+  statement->BindString(col + 2, cc.Name());
+  if (crypto_ && crypto_->ShouldEncrypt()) {
+    std::string encrypted_value;
+    if (!crypto_->EncryptString(cc.Value(), &encrypted_value))
+      return false;
+    statement->BindCString(col + 3, "");  // value
+    // BindBlob() immediately makes an internal copy of the data.
+    statement->BindBlob(col + 4, encrypted_value.data(),
+                        static_cast<int>(encrypted_value.length()));
+  } else {
+    statement->BindString(col + 3, cc.Value());
+    statement->BindBlob(col + 4, "", 0);  // encrypted_value
+  }
+  statement->BindString(col + 5, cc.Path());
+  statement->BindInt64(col + 6, cc.ExpiryDate().ToInternalValue());
+  statement->BindInt(col + 7, cc.IsSecure());
+  statement->BindInt(col + 8, cc.IsHttpOnly());
+  statement->BindInt(col + 9, cc.IsFirstPartyOnly());
+  statement->BindInt64(col + 10, cc.LastAccessDate().ToInternalValue());
+  statement->BindInt(col + 11, cc.IsPersistent());
+  statement->BindInt(col + 12, cc.IsPersistent());
+  statement->BindInt(col + 13, CookiePriorityToDBCookiePriority(cc.Priority()));
+  return true;
+}
+
+void SQLitePersistentCookieStore::Backend::CheckpointInBackground() {
+  DCHECK(background_task_runner_->RunsTasksOnCurrentThread());
+
+  // Maybe we are already Close()'ed.
+  if (!db_.get())
+    return;
+
+  // A passive checkpoint never waits on readers or writers; whatever it cannot
+  // copy back is picked up by the next one, or by SQLite when the connection
+  // is closed.
+  const base::Time start = base::Time::Now();
+  if (!db_->Execute("PRAGMA wal_checkpoint(PASSIVE)"))
+    return;
+  UMA_HISTOGRAM_CUSTOM_TIMES("Cookie.TimeWALCheckpoint",
+                             base::Time::Now() - start,
+                             base::TimeDelta::FromMilliseconds(1),
+                             base::TimeDelta::FromMinutes(1), 50);
+}
+
+void SQLitePersistentCookieStore::Backend::EnableWriteCoalescing() {
+  DCHECK(!background_task_runner_->RunsTasksOnCurrentThread());
+  coalesce_writes_ = true;
+}
+
 void SQLitePersistentCookieStore::Backend::Flush(
     const base::Closure& callback) {
   DCHECK(!background_task_runner_->RunsTasksOnCurrentThread());
@@ -1337,6 +1648,11 @@ void SQLitePersistentCookieStore::DeleteAllInList(
     backend_->DeleteAllInList(cookies);
 }
 
+void SQLitePersistentCookieStore::EnableWriteCoalescing() {
+  if (backend_)
+    backend_->EnableWriteCoalescing();
+}
+
 void SQLitePersistentCookieStore::Close(const base::Closure& callback) {
   if (backend_) {
     backend_->Close(callback);
@@ -48,6 +48,12 @@ class SQLitePersistentCookieStore
   // Deletes the cookies whose origins match those given in |cookies|.
   void DeleteAllInList(const std::list<CookieOrigin>& cookies);
 
+  // Opts the store into write coalescing. Operations queued on the same
+  // cookie within one commit window are folded together before being written
+  // with multi-row statements, and the database is kept in WAL mode with
+  // checkpoints run on the background runner. Must be called before Load().
+  void EnableWriteCoalescing();
+
   // Closes the database backend and fires |callback| on the worker
   // thread. After Close() is called, further calls to the
   // PersistentCookieStore methods will do nothing, with Load() and
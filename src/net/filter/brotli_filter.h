@@ -0,0 +1,22 @@
+// Copyright 2015 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_FILTER_BROTLI_FILTER_H_
+#define NET_FILTER_BROTLI_FILTER_H_
+
+#include "net/filter/filter.h"
+
+namespace net {
+
+// Creates an instance of a filter that applies Brotli content decoding to a
+// data stream, or returns NULL if Brotli is not supported in this build.
+// Brotli format specification: http://www.ietf.org/id/draft-alakuijala-brotli
+//
+// The returned filter is a subclass of Filter. See the latter's header file
+// filter.h for sample usage.
+Filter* CreateBrotliFilter(Filter::FilterType type_id);
+
+}  // namespace net
+
+#endif  // NET_FILTER_BROTLI_FILTER_H_
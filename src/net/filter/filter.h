@@ -151,6 +151,7 @@ class NET_EXPORT_PRIVATE Filter {
 
   // Specifies type of filters that can be created.
   enum FilterType {
+    FILTER_TYPE_BROTLI,
     FILTER_TYPE_DEFLATE,
     FILTER_TYPE_GZIP,
     FILTER_TYPE_GZIP_HELPING_SDCH,  // Gzip possible, but pass through allowed.
@@ -283,6 +284,7 @@ class NET_EXPORT_PRIVATE Filter {
 
   // Helper methods for PrependNewFilter. If initialization is successful,
   // they return a fully initialized Filter. Otherwise, return NULL.
+  static Filter* InitBrotliFilter(FilterType type_id, int buffer_size);
   static Filter* InitGZipFilter(FilterType type_id, int buffer_size);
   static Filter* InitSdchFilter(FilterType type_id,
                                 const FilterContext& filter_context,
@@ -100,6 +100,59 @@ scoped_ptr<base::Value> NetLogSdchResponseCorruptionDetectionCallback(
   return dict.Pass();
 }
 
+// Decoder output that is written straight into the filter's destination
+// buffer. Whatever does not fit is appended to |overflow|, to be returned by
+// the next call to ReadFilteredData().
+class FilterOutputString : public open_vcdiff::OutputStringInterface {
+ public:
+  FilterOutputString(char* dest_buffer,
+                     size_t available_space,
+                     std::string* overflow)
+      : dest_buffer_(dest_buffer),
+        available_space_(available_space),
+        bytes_written_(0),
+        overflow_(overflow) {
+    DCHECK(overflow_->empty());
+  }
+  ~FilterOutputString() override {}
+
+  // open_vcdiff::OutputStringInterface implementation:
+  FilterOutputString& append(const char* s, size_t n) override {
+    size_t amount = std::min(n, available_space_ - bytes_written_);
+    memcpy(dest_buffer_ + bytes_written_, s, amount);
+    bytes_written_ += amount;
+    if (amount < n)
+      overflow_->append(s + amount, n - amount);
+    return *this;
+  }
+
+  void clear() override {
+    bytes_written_ = 0;
+    overflow_->clear();
+  }
+
+  void push_back(char c) override { append(&c, 1); }
+
+  void ReserveAdditionalBytes(size_t res_arg) override {
+    size_t room = available_space_ - bytes_written_;
+    if (res_arg > room)
+      overflow_->reserve(overflow_->size() + res_arg - room);
+  }
+
+  size_t size() const override { return bytes_written_ + overflow_->size(); }
+
+  // Number of bytes that went to the destination buffer.
+  size_t bytes_written() const { return bytes_written_; }
+
+ private:
+  char* const dest_buffer_;
+  const size_t available_space_;
+  size_t bytes_written_;
+  std::string* const overflow_;
+
+  DISALLOW_COPY_AND_ASSIGN(FilterOutputString);
+};
+
 }  // namespace
 
 SdchFilter::SdchFilter(FilterType type, const FilterContext& filter_context)
@@ -413,21 +466,22 @@ Filter::FilterStatus SdchFilter::ReadFilteredData(char* dest_buffer,
   if (!next_stream_data_ || stream_data_len_ <= 0)
     return FILTER_NEED_MORE_DATA;
 
-  // A note on accounting: DecodeChunk() appends to its output buffer, so any
-  // preexisting data in |dest_buffer_excess_| could skew the value of
-  // |output_bytes_|. However, OutputBufferExcess guarantees that it will
-  // consume all of |dest_buffer_excess_| when called above unless the
-  // destination buffer runs out of space, and if the destination buffer runs
-  // out of space, this code returns FILTER_OK early above. Therefore, if
-  // execution reaches this point, |dest_buffer_excess_| is empty, which is
-  // DCHECKed above.
-  bool ret = vcdiff_streaming_decoder_->DecodeChunk(
-    next_stream_data_, stream_data_len_, &dest_buffer_excess_);
+  // The decoder writes directly into |dest_buffer|, and only the output that
+  // does not fit is kept in |dest_buffer_excess_|. OutputBufferExcess
+  // guarantees that it will consume all of |dest_buffer_excess_| when called
+  // above unless the destination buffer runs out of space, and if the
+  // destination buffer runs out of space, this code returns FILTER_OK early
+  // above. Therefore, if execution reaches this point, |dest_buffer_excess_|
+  // is empty, which is DCHECKed above.
+  FilterOutputString output(dest_buffer, static_cast<size_t>(available_space),
+                            &dest_buffer_excess_);
+  bool ret = vcdiff_streaming_decoder_->DecodeChunkToInterface(
+      next_stream_data_, stream_data_len_, &output);
   // Assume all data was used in decoding.
   next_stream_data_ = NULL;
   source_bytes_ += stream_data_len_;
   stream_data_len_ = 0;
-  output_bytes_ += dest_buffer_excess_.size();
+  output_bytes_ += output.size();
   if (!ret) {
     vcdiff_streaming_decoder_.reset(NULL);  // Don't call it again.
     decoding_status_ = DECODING_ERROR;
@@ -435,12 +489,9 @@ Filter::FilterStatus SdchFilter::ReadFilteredData(char* dest_buffer,
     return FILTER_ERROR;
   }
 
-  amount = OutputBufferExcess(dest_buffer, available_space);
-  *dest_len += amount;
-  dest_buffer += amount;
-  available_space -= amount;
-  if (0 == available_space && !dest_buffer_excess_.empty())
-      return FILTER_OK;
+  *dest_len += output.bytes_written();
+  if (!dest_buffer_excess_.empty())
+    return FILTER_OK;
   return FILTER_NEED_MORE_DATA;
 }
 
@@ -100,7 +100,7 @@ class NET_EXPORT_PRIVATE SdchFilter : public Filter {
   // deleted before the URLRequestContext is destroyed.
   const URLRequestContext* const url_request_context_;
 
-  // The decoder may demand a larger output buffer than the target of
+  // The decoder may produce more output than fits in the target of
   // ReadFilteredData so we buffer the excess output between calls.
   std::string dest_buffer_excess_;
   // To avoid moving strings around too much, we save the index into
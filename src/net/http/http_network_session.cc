@@ -86,6 +86,7 @@ HttpNetworkSession::Params::Params()
       enable_tcp_fast_open_for_ssl(false),
       enable_spdy_compression(true),
       enable_spdy_ping_based_connection_checking(true),
+      enable_spdy_write_coalescing(false),
       spdy_default_protocol(kProtoUnknown),
       spdy_session_max_recv_window_size(kSpdySessionMaxRecvWindowSize),
       spdy_stream_max_recv_window_size(kSpdyStreamMaxRecvWindowSize),
@@ -178,6 +179,7 @@ HttpNetworkSession::HttpNetworkSession(const Params& params)
                          params.transport_security_state,
                          params.enable_spdy_compression,
                          params.enable_spdy_ping_based_connection_checking,
+                         params.enable_spdy_write_coalescing,
                          params.spdy_default_protocol,
                          params.spdy_session_max_recv_window_size,
                          params.spdy_stream_max_recv_window_size,
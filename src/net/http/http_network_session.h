@@ -89,6 +89,8 @@ class NET_EXPORT HttpNetworkSession
     bool enable_spdy_compression;
     // Use SPDY ping frames to test for connection health after idle.
     bool enable_spdy_ping_based_connection_checking;
+    // Copy frames queued on a SPDY session into shared socket writes.
+    bool enable_spdy_write_coalescing;
     NextProto spdy_default_protocol;
     // The protocols supported by NPN (next protocol negotiation) during the
     // SSL handshake as well as by HTTP Alternate-Protocol.
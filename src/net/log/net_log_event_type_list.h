@@ -1287,6 +1287,13 @@ EVENT_TYPE(HTTP2_SESSION_UPDATE_RECV_WINDOW)
 //   }
 EVENT_TYPE(HTTP2_SESSION_SEND_DATA)
 
+// Several queued frames were coalesced into a single socket write.
+//   {
+//     "frames": <The number of frames in the write>,
+//     "size"  : <The total size of the write>,
+//   }
+EVENT_TYPE(HTTP2_SESSION_COALESCED_WRITE)
+
 // Receiving a data frame
 //   {
 //     "stream_id": <The stream ID for the window update>,
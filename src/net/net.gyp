@@ -6,6 +6,9 @@
   'variables': {
     'chromium_code': 1,
     'linux_link_kerberos%': 0,
+    # Brotli content decoding is backed by third_party/brotli; set this to 1
+    # to build without it (the "br" encoding is then never advertised).
+    'disable_brotli_filter%': 0,
     'conditions': [
       ['chromeos==1 or embedded==1 or OS=="ios"', {
         # Disable Kerberos on ChromeOS and iOS, at least for now.
@@ -24,6 +24,10 @@ const uint8 kDecodeTableRootBits = 9;
 // Maximum number of bits to index in successive decode tables.
 const uint8 kDecodeTableBranchBits = 6;
 
+// Number of input bits consumed by each NibbleTransition.
+const uint8 kNibbleBits = 4;
+const size_t kTransitionsPerState = 1 << kNibbleBits;
+
 bool SymbolLengthAndIdCompare(const HpackHuffmanSymbol& a,
                               const HpackHuffmanSymbol& b) {
   if (a.length == b.length) {
@@ -48,6 +52,8 @@ HpackHuffmanTable::DecodeEntry::DecodeEntry(uint8 next_table_index,
 size_t HpackHuffmanTable::DecodeTable::size() const {
   return size_t(1) << indexed_length;
 }
+HpackHuffmanTable::NibbleTransition::NibbleTransition()
+    : next_state(0), symbol_id(0), flags(0) {}
 
 HpackHuffmanTable::HpackHuffmanTable() {}
 
@@ -100,6 +106,7 @@ bool HpackHuffmanTable::Initialize(const HpackHuffmanSymbol* input_symbols,
   // Order on symbol ID ascending.
   std::sort(symbols.begin(), symbols.end(), SymbolIdCompare);
   BuildEncodeTable(symbols);
+  BuildNibbleTransitions();
   return true;
 }
 
@@ -183,6 +190,77 @@ void HpackHuffmanTable::BuildDecodeTables(const std::vector<Symbol>& symbols) {
   }
 }
 
+void HpackHuffmanTable::BuildNibbleTransitions() {
+  // Build the code tree. Leaves hold a symbol ID; internal nodes are numbered
+  // in creation order, which makes the root state 0.
+  struct Node {
+    Node() : symbol_id(-1), depth(0), state(0) {
+      children[0] = children[1] = -1;
+    }
+    int children[2];
+    int symbol_id;
+    uint8 depth;
+    uint16 state;
+  };
+  std::vector<Node> nodes(1);
+  std::vector<size_t> states(1, 0);
+  for (size_t id = 0; id != code_by_id_.size(); id++) {
+    size_t node = 0;
+    for (uint8 bit = 0; bit != length_by_id_[id]; bit++) {
+      int branch = (code_by_id_[id] >> (31 - bit)) & 1;
+      if (nodes[node].children[branch] == -1) {
+        nodes[node].children[branch] = static_cast<int>(nodes.size());
+        Node child;
+        child.depth = bit + 1;
+        if (bit + 1 == length_by_id_[id]) {
+          child.symbol_id = static_cast<int>(id);
+        } else {
+          if (!base::IsValueInRangeForNumericType<uint16>(states.size()))
+            return;
+          child.state = static_cast<uint16>(states.size());
+          states.push_back(nodes.size());
+        }
+        nodes.push_back(child);
+      }
+      node = nodes[node].children[branch];
+    }
+  }
+
+  std::vector<NibbleTransition> transitions(states.size() *
+                                            kTransitionsPerState);
+  for (size_t state = 0; state != states.size(); state++) {
+    for (size_t nibble = 0; nibble != kTransitionsPerState; nibble++) {
+      NibbleTransition& transition =
+          transitions[state * kTransitionsPerState + nibble];
+      size_t node = states[state];
+      for (int bit = kNibbleBits - 1; bit >= 0; bit--) {
+        int child = nodes[node].children[(nibble >> bit) & 1];
+        if (child == -1) {
+          transition.flags = NibbleTransition::FAIL;
+          break;
+        }
+        node = child;
+        if (nodes[node].symbol_id != -1) {
+          if (transition.flags & NibbleTransition::EMIT_SYMBOL) {
+            // A second symbol within one nibble; DecodeBuffer() falls back
+            // to DecodeString() for this code.
+            return;
+          }
+          transition.flags |= NibbleTransition::EMIT_SYMBOL;
+          transition.symbol_id = static_cast<uint16>(nodes[node].symbol_id);
+          node = 0;
+        }
+      }
+      if (transition.flags & NibbleTransition::FAIL)
+        continue;
+      transition.next_state = nodes[node].state;
+      if (nodes[node].depth < 8)
+        transition.flags |= NibbleTransition::ACCEPTING;
+    }
+  }
+  nibble_transitions_.swap(transitions);
+}
+
 uint8 HpackHuffmanTable::AddDecodeTable(uint8 prefix, uint8 indexed) {
   CHECK_LT(decode_tables_.size(), 255u);
   {
@@ -321,4 +399,45 @@ bool HpackHuffmanTable::DecodeString(HpackInputStream* in,
   return false;
 }
 
+bool HpackHuffmanTable::DecodeBuffer(StringPiece in,
+                                     size_t out_capacity,
+                                     string* out) const {
+  if (nibble_transitions_.empty()) {
+    HpackInputStream input_stream(base::checked_cast<uint32>(out_capacity),
+                                  in);
+    return DecodeString(&input_stream, out_capacity, out);
+  }
+
+  out->clear();
+
+  uint16 state = 0;
+  bool accepting = true;
+  for (size_t i = 0; i != in.size(); i++) {
+    const uint8 octet = static_cast<uint8>(in[i]);
+    const uint8 nibbles[] = {static_cast<uint8>(octet >> kNibbleBits),
+                             static_cast<uint8>(octet & 0xf)};
+    for (uint8 nibble : nibbles) {
+      const NibbleTransition& transition =
+          nibble_transitions_[state * kTransitionsPerState + nibble];
+      if (transition.flags & NibbleTransition::FAIL)
+        return false;
+      if (transition.flags & NibbleTransition::EMIT_SYMBOL) {
+        if (out->size() == out_capacity) {
+          // This code would cause us to overflow |out_capacity|.
+          return false;
+        }
+        if (transition.symbol_id < 256) {
+          // Assume symbols >= 256 are used for padding.
+          out->push_back(static_cast<char>(transition.symbol_id));
+        }
+      }
+      state = transition.next_state;
+      accepting = (transition.flags & NibbleTransition::ACCEPTING) != 0;
+    }
+  }
+  // As with DecodeString(), a trailing partial code is only allowed as
+  // padding within the last byte.
+  return accepting;
+}
+
 }  // namespace net
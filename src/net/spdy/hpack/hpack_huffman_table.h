@@ -60,6 +60,26 @@ class NET_EXPORT_PRIVATE HpackHuffmanTable {
     // Returns |1 << indexed_length|.
     size_t size() const;
   };
+  // NibbleTransitions drive a state machine which decodes four input bits per
+  // step. States are the internal nodes of the code tree, with state 0 at the
+  // root; a state is entered after consuming the bits which lead to its node.
+  struct NET_EXPORT_PRIVATE NibbleTransition {
+    enum Flags {
+      // A symbol was completed by this nibble, and is held in |symbol_id|.
+      EMIT_SYMBOL = 1 << 0,
+      // The nibble does not extend any code; the input is invalid.
+      FAIL = 1 << 1,
+      // Fewer than 8 bits have been consumed since the last completed symbol,
+      // so the input may end here.
+      ACCEPTING = 1 << 2,
+    };
+
+    NibbleTransition();
+
+    uint16 next_state;
+    uint16 symbol_id;
+    uint8 flags;
+  };
 
   HpackHuffmanTable();
   ~HpackHuffmanTable();
@@ -90,6 +110,14 @@ class NET_EXPORT_PRIVATE HpackHuffmanTable {
                     size_t out_capacity,
                     std::string* out) const;
 
+  // Decodes all of |in| into |out|, a nibble at a time, with the same result
+  // as DecodeString() run over a stream holding exactly |in|. Falls back to
+  // DecodeString() if the code has a symbol shorter than four bits, for which
+  // the nibble state machine is not built.
+  bool DecodeBuffer(base::StringPiece in,
+                    size_t out_capacity,
+                    std::string* out) const;
+
  private:
   // Expects symbols ordered on length & ID ascending.
   void BuildDecodeTables(const std::vector<Symbol>& symbols);
@@ -97,6 +125,10 @@ class NET_EXPORT_PRIVATE HpackHuffmanTable {
   // Expects symbols ordered on ID ascending.
   void BuildEncodeTable(const std::vector<Symbol>& symbols);
 
+  // Builds |nibble_transitions_| from |code_by_id_| and |length_by_id_|.
+  // Leaves it empty if some nibble would complete more than one symbol.
+  void BuildNibbleTransitions();
+
   // Adds a new DecodeTable with the argument prefix & indexed length.
   // Returns the new table index.
   uint8 AddDecodeTable(uint8 prefix, uint8 indexed);
@@ -110,6 +142,9 @@ class NET_EXPORT_PRIVATE HpackHuffmanTable {
   std::vector<DecodeTable> decode_tables_;
   std::vector<DecodeEntry> decode_entries_;
 
+  // Sixteen transitions per decoder state, indexed by |state * 16 + nibble|.
+  std::vector<NibbleTransition> nibble_transitions_;
+
   // Symbol code and code length, in ascending symbol ID order.
   // Codes are stored in the most-significant bits of the word.
   std::vector<uint32> code_by_id_;
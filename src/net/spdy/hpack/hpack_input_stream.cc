@@ -129,12 +129,22 @@ bool HpackInputStream::DecodeNextHuffmanString(const HpackHuffmanTable& table,
     return false;
   }
 
-  HpackInputStream bounded_reader(max_string_literal_size_,
-                                  StringPiece(buffer_.data(), encoded_size));
+  StringPiece encoded(buffer_.data(), encoded_size);
   buffer_.remove_prefix(encoded_size);
 
   // HpackHuffmanTable will not decode beyond |max_string_literal_size_|.
-  return table.DecodeString(&bounded_reader, max_string_literal_size_, str);
+  bool result = table.DecodeBuffer(encoded, max_string_literal_size_, str);
+#if DCHECK_IS_ON()
+  // Validate the nibble-at-a-time decoder against the bit-at-a-time one.
+  HpackInputStream bounded_reader(max_string_literal_size_, encoded);
+  string expected;
+  bool expected_result =
+      table.DecodeString(&bounded_reader, max_string_literal_size_, &expected);
+  DCHECK_EQ(expected_result, result);
+  if (result)
+    DCHECK_EQ(expected, *str);
+#endif
+  return result;
 }
 
 bool HpackInputStream::PeekBits(size_t* peeked_count, uint32* out) {
@@ -33,6 +33,13 @@ scoped_ptr<SpdyFrame> MakeSpdyFrame(const char* data, size_t size) {
 
 }  // namespace
 
+SpdyBuffer::SharedFrame::SharedFrame() {}
+
+SpdyBuffer::SharedFrame::~SharedFrame() {
+  // |data| may point into |pinned_buffer|, so release it first.
+  data.reset();
+}
+
 // This class is an IOBuffer implementation that simply holds a
 // reference to a SharedFrame object and a fixed offset. Used by
 // SpdyBuffer::GetIOBufferForRemainingData().
@@ -70,6 +77,19 @@ SpdyBuffer::SpdyBuffer(const char* data, size_t size) :
   shared_frame_->data = MakeSpdyFrame(data, size);
 }
 
+SpdyBuffer::SpdyBuffer(const scoped_refptr<IOBuffer>& buffer,
+                       size_t offset,
+                       size_t size)
+    : shared_frame_(new SharedFrame()),
+      offset_(0) {
+  DCHECK(buffer.get());
+  CHECK_GT(size, 0u);
+  CHECK_LE(size, kMaxSpdyFrameSize);
+  shared_frame_->pinned_buffer = buffer;
+  shared_frame_->data.reset(new SpdyFrame(buffer->data() + offset, size,
+                                          false /* owns_buffer */));
+}
+
 SpdyBuffer::~SpdyBuffer() {
   if (GetRemainingSize() > 0)
     ConsumeHelper(GetRemainingSize(), DISCARD);
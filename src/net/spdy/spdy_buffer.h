@@ -53,6 +53,15 @@ class NET_EXPORT_PRIVATE SpdyBuffer {
   // non-NULL and |size| must be non-zero.
   SpdyBuffer(const char* data, size_t size);
 
+  // Construct over the |size| bytes of |buffer| starting at |offset|
+  // without copying them. The SpdyBuffer, and any IOBuffer returned by
+  // GetIOBufferForRemainingData(), hold a reference to |buffer|, so its
+  // owner must not write to it again unless it holds the only reference.
+  // |size| must be non-zero.
+  SpdyBuffer(const scoped_refptr<IOBuffer>& buffer,
+             size_t offset,
+             size_t size);
+
   // If there are bytes remaining in the buffer, triggers a call to
   // any consume callbacks with a DISCARD source.
   ~SpdyBuffer();
@@ -87,8 +96,18 @@ class NET_EXPORT_PRIVATE SpdyBuffer {
   void ConsumeHelper(size_t consume_size, ConsumeSource consume_source);
 
   // Ref-count the passed-in SpdyFrame to support the semantics of
-  // |GetIOBufferForRemainingData()|.
-  typedef base::RefCountedData<scoped_ptr<SpdyFrame> > SharedFrame;
+  // |GetIOBufferForRemainingData()|. If the frame does not own its data,
+  // |pinned_buffer| is the IOBuffer holding it.
+  struct SharedFrame : public base::RefCounted<SharedFrame> {
+    SharedFrame();
+
+    scoped_ptr<SpdyFrame> data;
+    scoped_refptr<IOBuffer> pinned_buffer;
+
+   private:
+    friend class base::RefCounted<SharedFrame>;
+    ~SharedFrame();
+  };
 
   class SharedFrameIOBuffer;
 
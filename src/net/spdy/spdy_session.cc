@@ -5,6 +5,7 @@
 #include "net/spdy/spdy_session.h"
 
 #include <algorithm>
+#include <cstring>
 #include <map>
 
 #include "base/basictypes.h"
@@ -53,6 +54,13 @@ namespace net {
 namespace {
 
 const int kReadBufferSize = 8 * 1024;
+// DATA payloads at least this large are handed to streams as slices of
+// |read_buffer_| rather than copied. Smaller ones are copied so that a few
+// bytes of unread data do not keep a whole read buffer alive.
+const size_t kMinPinnedDataSize = 2 * 1024;
+// When write coalescing is enabled, queued frames are added to a write until
+// it reaches this many bytes, which is the largest TLS record payload.
+const size_t kMaxCoalescedWriteSize = 16 * 1024;
 const int kDefaultConnectionAtRiskOfLossSeconds = 10;
 const int kHungIntervalSeconds = 10;
 
@@ -236,6 +244,16 @@ scoped_ptr<base::Value> NetLogSpdyDataCallback(
   return dict.Pass();
 }
 
+scoped_ptr<base::Value> NetLogSpdyCoalescedWriteCallback(
+    size_t frame_count,
+    size_t size,
+    NetLogCaptureMode /* capture_mode */) {
+  scoped_ptr<base::DictionaryValue> dict(new base::DictionaryValue());
+  dict->SetInteger("frames", static_cast<int>(frame_count));
+  dict->SetInteger("size", static_cast<int>(size));
+  return dict.Pass();
+}
+
 scoped_ptr<base::Value> NetLogSpdyRstCallback(
     SpdyStreamId stream_id,
     int status,
@@ -585,6 +603,10 @@ SpdySession::PushedStreamInfo::PushedStreamInfo(
 
 SpdySession::PushedStreamInfo::~PushedStreamInfo() {}
 
+SpdySession::InFlightFrame::InFlightFrame() : frame_type(DATA), frame_size(0) {}
+
+SpdySession::InFlightFrame::~InFlightFrame() {}
+
 // static
 bool SpdySession::CanPool(TransportSecurityState* transport_security_state,
                           const SSLInfo& ssl_info,
@@ -653,8 +675,6 @@ SpdySession::SpdySession(
       last_accepted_push_stream_id_(0),
       num_pushed_streams_(0u),
       num_active_pushed_streams_(0u),
-      in_flight_write_frame_type_(DATA),
-      in_flight_write_frame_size_(0),
       is_secure_(false),
       certificate_error_code_(OK),
       availability_state_(STATE_AVAILABLE),
@@ -669,6 +689,8 @@ SpdySession::SpdySession(
       streams_pushed_count_(0),
       streams_pushed_and_claimed_count_(0),
       streams_abandoned_count_(0),
+      frames_sent_count_(0),
+      socket_writes_count_(0),
       total_bytes_received_(0),
       sent_settings_(false),
       received_settings_(false),
@@ -693,6 +715,7 @@ SpdySession::SpdySession(
       enable_compression_(enable_compression),
       enable_ping_based_connection_checking_(
           enable_ping_based_connection_checking),
+      enable_write_coalescing_(false),
       protocol_(default_protocol),
       connection_at_risk_of_loss_time_(
           base::TimeDelta::FromSeconds(kDefaultConnectionAtRiskOfLossSeconds)),
@@ -1481,6 +1504,9 @@ int SpdySession::DoRead() {
   CHECK(connection_);
   CHECK(connection_->socket());
   read_state_ = READ_STATE_DO_READ_COMPLETE;
+  // Streams may still hold slices of the last buffer read; leave it to them.
+  if (!read_buffer_->HasOneRef())
+    read_buffer_ = new IOBuffer(kReadBufferSize);
   return connection_->socket()->Read(
       read_buffer_.get(),
       kReadBufferSize,
@@ -1536,7 +1562,7 @@ void SpdySession::PumpWriteLoop(WriteState expected_write_state, int result) {
 
   DoWriteLoop(expected_write_state, result);
 
-  if (availability_state_ == STATE_DRAINING && !in_flight_write_ &&
+  if (availability_state_ == STATE_DRAINING && in_flight_frames_.empty() &&
       write_queue_.IsEmpty()) {
     pool_->RemoveUnavailableSession(GetWeakPtr());  // Destroys |this|.
     return;
@@ -1585,53 +1611,20 @@ int SpdySession::DoWrite() {
   CHECK(in_io_loop_);
 
   DCHECK(buffered_spdy_framer_);
-  if (in_flight_write_) {
-    DCHECK_GT(in_flight_write_->GetRemainingSize(), 0u);
+  if (!in_flight_frames_.empty()) {
+    DCHECK_GT(in_flight_frames_.front()->buffer->GetRemainingSize(), 0u);
   } else {
     // Grab the next frame to send.
-    SpdyFrameType frame_type = DATA;
-    scoped_ptr<SpdyBufferProducer> producer;
-    base::WeakPtr<SpdyStream> stream;
-    if (!write_queue_.Dequeue(&frame_type, &producer, &stream)) {
+    int rv = DequeueFrameForWrite();
+    if (rv == ERR_IO_PENDING) {
       write_state_ = WRITE_STATE_IDLE;
       return ERR_IO_PENDING;
     }
+    if (rv != OK)
+      return rv;
 
-    if (stream.get())
-      CHECK(!stream->IsClosed());
-
-    // Activate the stream only when sending the SYN_STREAM frame to
-    // guarantee monotonically-increasing stream IDs.
-    if (frame_type == SYN_STREAM) {
-      CHECK(stream.get());
-      CHECK_EQ(stream->stream_id(), 0u);
-      scoped_ptr<SpdyStream> owned_stream =
-          ActivateCreatedStream(stream.get());
-      InsertActivatedStream(owned_stream.Pass());
-
-      if (stream_hi_water_mark_ > kLastStreamId) {
-        CHECK_EQ(stream->stream_id(), kLastStreamId);
-        // We've exhausted the stream ID space, and no new streams may be
-        // created after this one.
-        MakeUnavailable();
-        StartGoingAway(kLastStreamId, ERR_ABORTED);
-      }
-    }
-
-    // TODO(pkasting): Remove ScopedTracker below once crbug.com/457517 is
-    // fixed.
-    tracked_objects::ScopedTracker tracking_profile1(
-        FROM_HERE_WITH_EXPLICIT_FUNCTION("457517 SpdySession::DoWrite1"));
-    in_flight_write_ = producer->ProduceBuffer();
-    if (!in_flight_write_) {
-      NOTREACHED();
-      return ERR_UNEXPECTED;
-    }
-    in_flight_write_frame_type_ = frame_type;
-    in_flight_write_frame_size_ = in_flight_write_->GetRemainingSize();
-    DCHECK_GE(in_flight_write_frame_size_,
-              buffered_spdy_framer_->GetFrameMinimumSize());
-    in_flight_write_stream_ = stream;
+    if (enable_write_coalescing_)
+      CoalesceQueuedFrames();
   }
 
   write_state_ = WRITE_STATE_DO_WRITE_COMPLETE;
@@ -1642,11 +1635,21 @@ int SpdySession::DoWrite() {
   // TODO(pkasting): Remove ScopedTracker below once crbug.com/457517 is fixed.
   tracked_objects::ScopedTracker tracking_profile2(
       FROM_HERE_WITH_EXPLICIT_FUNCTION("457517 SpdySession::DoWrite2"));
-  scoped_refptr<IOBuffer> write_io_buffer =
-      in_flight_write_->GetIOBufferForRemainingData();
+  scoped_refptr<IOBuffer> write_io_buffer;
+  size_t write_size = 0;
+  if (in_flight_write_buffer_.get()) {
+    write_io_buffer = in_flight_write_buffer_;
+    write_size = in_flight_write_buffer_->BytesRemaining();
+  } else {
+    DCHECK_EQ(in_flight_frames_.size(), 1u);
+    SpdyBuffer* buffer = in_flight_frames_.front()->buffer.get();
+    write_io_buffer = buffer->GetIOBufferForRemainingData();
+    write_size = buffer->GetRemainingSize();
+  }
+  ++socket_writes_count_;
   return connection_->socket()->Write(
       write_io_buffer.get(),
-      in_flight_write_->GetRemainingSize(),
+      write_size,
       base::Bind(&SpdySession::PumpWriteLoop,
                  weak_factory_.GetWeakPtr(), WRITE_STATE_DO_WRITE_COMPLETE));
 }
@@ -1654,54 +1657,149 @@ int SpdySession::DoWrite() {
 int SpdySession::DoWriteComplete(int result) {
   CHECK(in_io_loop_);
   DCHECK_NE(result, ERR_IO_PENDING);
-  DCHECK_GT(in_flight_write_->GetRemainingSize(), 0u);
+  DCHECK(!in_flight_frames_.empty());
+  DCHECK_GT(in_flight_frames_.front()->buffer->GetRemainingSize(), 0u);
 
   last_activity_time_ = time_func_();
 
   if (result < 0) {
     DCHECK_NE(result, ERR_IO_PENDING);
-    in_flight_write_.reset();
-    in_flight_write_frame_type_ = DATA;
-    in_flight_write_frame_size_ = 0;
-    in_flight_write_stream_.reset();
+    in_flight_frames_.clear();
+    in_flight_write_buffer_ = NULL;
     write_state_ = WRITE_STATE_DO_WRITE;
     DoDrainSession(static_cast<Error>(result), "Write error");
     return OK;
   }
 
-  // It should not be possible to have written more bytes than our
-  // in_flight_write_.
-  DCHECK_LE(static_cast<size_t>(result),
-            in_flight_write_->GetRemainingSize());
-
-  if (result > 0) {
-    in_flight_write_->Consume(static_cast<size_t>(result));
-    if (in_flight_write_stream_.get())
-      in_flight_write_stream_->AddRawSentBytes(static_cast<size_t>(result));
-
-    // We only notify the stream when we've fully written the pending frame.
-    if (in_flight_write_->GetRemainingSize() == 0) {
-      // It is possible that the stream was cancelled while we were
-      // writing to the socket.
-      if (in_flight_write_stream_.get()) {
-        DCHECK_GT(in_flight_write_frame_size_, 0u);
-        in_flight_write_stream_->OnFrameWriteComplete(
-            in_flight_write_frame_type_,
-            in_flight_write_frame_size_);
-      }
+  // It should not be possible to have written more bytes than the
+  // frames in flight hold.
+  if (in_flight_write_buffer_.get()) {
+    DCHECK_LE(result, in_flight_write_buffer_->BytesRemaining());
+    in_flight_write_buffer_->DidConsume(result);
+  } else {
+    DCHECK_LE(static_cast<size_t>(result),
+              in_flight_frames_.front()->buffer->GetRemainingSize());
+  }
+
+  // Spread the written bytes over the frames in the order in which they
+  // were laid out.
+  size_t bytes_left = static_cast<size_t>(result);
+  while (bytes_left > 0) {
+    DCHECK(!in_flight_frames_.empty());
+    InFlightFrame* frame = in_flight_frames_.front();
+    size_t consumed =
+        std::min(bytes_left, frame->buffer->GetRemainingSize());
+    frame->buffer->Consume(consumed);
+    bytes_left -= consumed;
+    if (frame->stream.get())
+      frame->stream->AddRawSentBytes(consumed);
+
+    if (frame->buffer->GetRemainingSize() > 0) {
+      DCHECK_EQ(bytes_left, 0u);
+      break;
+    }
 
-      // Cleanup the write which just completed.
-      in_flight_write_.reset();
-      in_flight_write_frame_type_ = DATA;
-      in_flight_write_frame_size_ = 0;
-      in_flight_write_stream_.reset();
+    // We only notify the stream when we've fully written the pending
+    // frame. Take the frame out of |in_flight_frames_| first, since the
+    // stream may close and call back into DeleteStream().
+    scoped_ptr<InFlightFrame> written_frame(frame);
+    in_flight_frames_.weak_erase(in_flight_frames_.begin());
+    ++frames_sent_count_;
+
+    // It is possible that the stream was cancelled while we were
+    // writing to the socket.
+    if (written_frame->stream.get()) {
+      DCHECK_GT(written_frame->frame_size, 0u);
+      written_frame->stream->OnFrameWriteComplete(written_frame->frame_type,
+                                                  written_frame->frame_size);
     }
   }
 
+  // Cleanup the write if it just completed.
+  if (in_flight_frames_.empty())
+    in_flight_write_buffer_ = NULL;
+
   write_state_ = WRITE_STATE_DO_WRITE;
   return OK;
 }
 
+int SpdySession::DequeueFrameForWrite() {
+  SpdyFrameType frame_type = DATA;
+  scoped_ptr<SpdyBufferProducer> producer;
+  base::WeakPtr<SpdyStream> stream;
+  if (!write_queue_.Dequeue(&frame_type, &producer, &stream))
+    return ERR_IO_PENDING;
+
+  if (stream.get())
+    CHECK(!stream->IsClosed());
+
+  // Activate the stream only when sending the SYN_STREAM frame to
+  // guarantee monotonically-increasing stream IDs.
+  if (frame_type == SYN_STREAM) {
+    CHECK(stream.get());
+    CHECK_EQ(stream->stream_id(), 0u);
+    scoped_ptr<SpdyStream> owned_stream =
+        ActivateCreatedStream(stream.get());
+    InsertActivatedStream(owned_stream.Pass());
+
+    if (stream_hi_water_mark_ > kLastStreamId) {
+      CHECK_EQ(stream->stream_id(), kLastStreamId);
+      // We've exhausted the stream ID space, and no new streams may be
+      // created after this one.
+      MakeUnavailable();
+      StartGoingAway(kLastStreamId, ERR_ABORTED);
+    }
+  }
+
+  // TODO(pkasting): Remove ScopedTracker below once crbug.com/457517 is
+  // fixed.
+  tracked_objects::ScopedTracker tracking_profile1(
+      FROM_HERE_WITH_EXPLICIT_FUNCTION("457517 SpdySession::DoWrite1"));
+  scoped_ptr<InFlightFrame> frame(new InFlightFrame());
+  frame->buffer = producer->ProduceBuffer();
+  if (!frame->buffer) {
+    NOTREACHED();
+    return ERR_UNEXPECTED;
+  }
+  frame->frame_type = frame_type;
+  frame->frame_size = frame->buffer->GetRemainingSize();
+  DCHECK_GE(frame->frame_size, buffered_spdy_framer_->GetFrameMinimumSize());
+  frame->stream = stream;
+  in_flight_frames_.push_back(frame.Pass());
+  return OK;
+}
+
+void SpdySession::CoalesceQueuedFrames() {
+  DCHECK_EQ(in_flight_frames_.size(), 1u);
+  DCHECK(!in_flight_write_buffer_.get());
+
+  size_t write_size = in_flight_frames_.front()->frame_size;
+  // Going away (see DequeueFrameForWrite()) may drain the session, after
+  // which nothing more should be sent.
+  while (write_size < kMaxCoalescedWriteSize &&
+         availability_state_ != STATE_DRAINING &&
+         DequeueFrameForWrite() == OK) {
+    write_size += in_flight_frames_.back()->frame_size;
+  }
+
+  UMA_HISTOGRAM_COUNTS_100("Net.SpdySession.FramesPerWrite",
+                           in_flight_frames_.size());
+  if (in_flight_frames_.size() == 1)
+    return;
+
+  scoped_refptr<IOBuffer> buffer(new IOBuffer(write_size));
+  char* data = buffer->data();
+  for (const InFlightFrame* frame : in_flight_frames_) {
+    memcpy(data, frame->buffer->GetRemainingData(), frame->frame_size);
+    data += frame->frame_size;
+  }
+  in_flight_write_buffer_ = new DrainableIOBuffer(buffer.get(), write_size);
+
+  net_log_.AddEvent(NetLog::TYPE_HTTP2_SESSION_COALESCED_WRITE,
+                    base::Bind(&NetLogSpdyCoalescedWriteCallback,
+                               in_flight_frames_.size(), write_size));
+}
+
 void SpdySession::DcheckGoingAway() const {
 #if DCHECK_IS_ON()
   DCHECK_GE(availability_state_, STATE_GOING_AWAY);
@@ -1904,6 +2002,8 @@ scoped_ptr<base::Value> SpdySession::GetInfoAsValue() const {
   dict->SetInteger("streams_abandoned_count", streams_abandoned_count_);
   DCHECK(buffered_spdy_framer_.get());
   dict->SetInteger("frames_received", buffered_spdy_framer_->frames_received());
+  dict->SetInteger("frames_sent", frames_sent_count_);
+  dict->SetInteger("socket_writes", socket_writes_count_);
 
   dict->SetBoolean("sent_settings", sent_settings_);
   dict->SetBoolean("received_settings", received_settings_);
@@ -1977,7 +2077,7 @@ void SpdySession::EnqueueWrite(RequestPriority priority,
 
 void SpdySession::MaybePostWriteLoop() {
   if (write_state_ == WRITE_STATE_IDLE) {
-    CHECK(!in_flight_write_);
+    CHECK(in_flight_frames_.empty());
     write_state_ = WRITE_STATE_DO_WRITE;
     base::ThreadTaskRunnerHandle::Get()->PostTask(
         FROM_HERE,
@@ -2014,12 +2114,14 @@ void SpdySession::InsertActivatedStream(scoped_ptr<SpdyStream> stream) {
 }
 
 void SpdySession::DeleteStream(scoped_ptr<SpdyStream> stream, int status) {
-  if (in_flight_write_stream_.get() == stream.get()) {
-    // If we're deleting the stream for the in-flight write, we still
-    // need to let the write complete, so we clear
-    // |in_flight_write_stream_| and let the write finish on its own
-    // without notifying |in_flight_write_stream_|.
-    in_flight_write_stream_.reset();
+  for (InFlightFrame* frame : in_flight_frames_) {
+    if (frame->stream.get() == stream.get()) {
+      // If we're deleting the stream for a frame of the in-flight
+      // write, we still need to let the write complete, so we clear
+      // the frame's stream and let the write finish on its own without
+      // notifying the stream.
+      frame->stream.reset();
+    }
   }
 
   write_queue_.RemovePendingWritesForStream(stream->GetWeakPtr());
@@ -2125,7 +2227,16 @@ void SpdySession::OnStreamFrameData(SpdyStreamId stream_id,
   if (data) {
     DCHECK_GT(len, 0u);
     CHECK_LE(len, static_cast<size_t>(kReadBufferSize));
-    buffer.reset(new SpdyBuffer(data, len));
+    // The framer hands out DATA payloads in place, so |data| normally lies
+    // within |read_buffer_| and can be pinned there instead of copied.
+    const char* read_buffer_start = read_buffer_->data();
+    if (len >= kMinPinnedDataSize && data >= read_buffer_start &&
+        data + len <= read_buffer_start + kReadBufferSize) {
+      buffer.reset(
+          new SpdyBuffer(read_buffer_, data - read_buffer_start, len));
+    } else {
+      buffer.reset(new SpdyBuffer(data, len));
+    }
 
     if (flow_control_state_ == FLOW_CONTROL_STREAM_AND_SESSION) {
       DecreaseRecvWindowSize(static_cast<int32>(len));
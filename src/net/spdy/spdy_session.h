@@ -14,6 +14,7 @@
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/memory/weak_ptr.h"
 #include "base/time/time.h"
 #include "net/base/io_buffer.h"
@@ -297,6 +298,11 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
                             bool is_secure,
                             int certificate_error_code);
 
+  // Allows the frames queued behind the next one to be sent to be copied
+  // into the same socket write, up to roughly one TLS record's worth of
+  // bytes, instead of issuing one write per frame.
+  void EnableWriteCoalescing() { enable_write_coalescing_ = true; }
+
   // Returns the protocol used by this session. Always between
   // kProtoSPDYMinimumVersion and kProtoSPDYMaximumVersion.
   NextProto protocol() const { return protocol_; }
@@ -707,6 +713,19 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   int DoWrite();
   int DoWriteComplete(int result);
 
+  // Dequeues the next frame from |write_queue_| and appends it to
+  // |in_flight_frames_|, activating its stream first if the frame is a
+  // SYN_STREAM. Returns OK if a frame was appended, ERR_IO_PENDING if
+  // |write_queue_| is empty, or another error if no buffer could be
+  // produced for the frame.
+  int DequeueFrameForWrite();
+
+  // Called with the first frame of a new write in |in_flight_frames_|.
+  // Dequeues further frames while the write is below
+  // kMaxCoalescedWriteSize, and if any were dequeued, copies all of them
+  // into |in_flight_write_buffer_|.
+  void CoalesceQueuedFrames();
+
   // TODO(akalin): Rename the Send* and Write* functions below to
   // Enqueue*.
 
@@ -994,7 +1013,9 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   // The socket handle for this session.
   scoped_ptr<ClientSocketHandle> connection_;
 
-  // The read buffer used to read data from the socket.
+  // The read buffer used to read data from the socket. SpdyBuffers handed to
+  // streams may hold references to it, in which case a new one is allocated
+  // for the next read.
   scoped_refptr<IOBuffer> read_buffer_;
 
   SpdyStreamId stream_hi_water_mark_;  // The next stream id to use.
@@ -1050,17 +1071,30 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   // The write queue.
   SpdyWriteQueue write_queue_;
 
-  // Data for the frame we are currently sending.
+  // A frame that is part of the write currently in flight.
+  struct InFlightFrame {
+    InFlightFrame();
+    ~InFlightFrame();
+
+    // The buffer holding the frame. It is consumed as the frame is written.
+    scoped_ptr<SpdyBuffer> buffer;
+    // The type of the frame in |buffer|.
+    SpdyFrameType frame_type;
+    // The size of the frame in |buffer|.
+    size_t frame_size;
+    // The stream to notify when |buffer| has been written to the socket
+    // completely.
+    base::WeakPtr<SpdyStream> stream;
+  };
+
+  // The frames making up the write currently in flight, in the order in
+  // which they are laid out on the wire. Empty iff no write is in flight.
+  ScopedVector<InFlightFrame> in_flight_frames_;
 
-  // The buffer we're currently writing.
-  scoped_ptr<SpdyBuffer> in_flight_write_;
-  // The type of the frame in |in_flight_write_|.
-  SpdyFrameType in_flight_write_frame_type_;
-  // The size of the frame in |in_flight_write_|.
-  size_t in_flight_write_frame_size_;
-  // The stream to notify when |in_flight_write_| has been written to
-  // the socket completely.
-  base::WeakPtr<SpdyStream> in_flight_write_stream_;
+  // If more than one frame was coalesced into the write in flight, a copy of
+  // all of them that is written instead of the individual buffers. NULL
+  // otherwise, in which case the only frame's buffer is written directly.
+  scoped_refptr<DrainableIOBuffer> in_flight_write_buffer_;
 
   // Flag if we're using an SSL connection for this SpdySession.
   bool is_secure_;
@@ -1091,6 +1125,8 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   int streams_pushed_count_;
   int streams_pushed_and_claimed_count_;
   int streams_abandoned_count_;
+  int frames_sent_count_;
+  int socket_writes_count_;
 
   // |total_bytes_received_| keeps track of all the bytes read by the
   // SpdySession. It is used by the |Net.SpdySettingsCwnd...| histograms.
@@ -1172,6 +1208,7 @@ class NET_EXPORT SpdySession : public BufferedSpdyFramerVisitorInterface,
   bool enable_sending_initial_data_;
   bool enable_compression_;
   bool enable_ping_based_connection_checking_;
+  bool enable_write_coalescing_;
 
   // The SPDY protocol used. Always between kProtoSPDYMinimumVersion and
   // kProtoSPDYMaximumVersion.
@@ -35,6 +35,7 @@ SpdySessionPool::SpdySessionPool(
     TransportSecurityState* transport_security_state,
     bool enable_compression,
     bool enable_ping_based_connection_checking,
+    bool enable_write_coalescing,
     NextProto default_protocol,
     size_t session_max_recv_window_size,
     size_t stream_max_recv_window_size,
@@ -50,6 +51,7 @@ SpdySessionPool::SpdySessionPool(
       enable_compression_(enable_compression),
       enable_ping_based_connection_checking_(
           enable_ping_based_connection_checking),
+      enable_write_coalescing_(enable_write_coalescing),
       // TODO(akalin): Force callers to have a valid value of
       // |default_protocol_|.
       default_protocol_((default_protocol == kProtoUnknown) ? kProtoSPDY31
@@ -101,6 +103,8 @@ base::WeakPtr<SpdySession> SpdySessionPool::CreateAvailableSessionFromSocket(
       default_protocol_, session_max_recv_window_size_,
       stream_max_recv_window_size_, initial_max_concurrent_streams_, time_func_,
       trusted_spdy_proxy_, net_log.net_log()));
+  if (enable_write_coalescing_)
+    new_session->EnableWriteCoalescing();
 
   new_session->InitializeWithSocket(
       connection.Pass(), this, is_secure, certificate_error_code);
@@ -53,6 +53,7 @@ class NET_EXPORT SpdySessionPool
       TransportSecurityState* transport_security_state,
       bool enable_compression,
       bool enable_ping_based_connection_checking,
+      bool enable_write_coalescing,
       NextProto default_protocol,
       size_t session_max_recv_window_size,
       size_t stream_max_recv_window_size,
@@ -209,6 +210,7 @@ class NET_EXPORT SpdySessionPool
   bool enable_sending_initial_data_;
   bool enable_compression_;
   bool enable_ping_based_connection_checking_;
+  bool enable_write_coalescing_;
   const NextProto default_protocol_;
   size_t session_max_recv_window_size_;
   size_t stream_max_recv_window_size_;
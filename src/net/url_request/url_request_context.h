@@ -187,6 +187,12 @@ class NET_EXPORT URLRequestContext
     sdch_manager_ = sdch_manager;
   }
 
+  // Whether "br" (Brotli) should be advertised in Accept-Encoding for requests
+  // made through this context. Brotli is only advertised over cryptographic
+  // schemes, since intermediaries are known to mangle unknown encodings.
+  bool enable_brotli() const { return enable_brotli_; }
+  void set_enable_brotli(bool enable_brotli) { enable_brotli_ = enable_brotli; }
+
   // Gets the URLRequest objects that hold a reference to this
   // URLRequestContext.
   std::set<const URLRequest*>* url_requests() const {
@@ -246,6 +252,8 @@ class NET_EXPORT URLRequestContext
   SdchManager* sdch_manager_;
   NetworkQualityEstimator* network_quality_estimator_;
 
+  bool enable_brotli_;
+
   // ---------------------------------------------------------------------------
   // Important: When adding any new members below, consider whether they need to
   // be added to CopyFrom.
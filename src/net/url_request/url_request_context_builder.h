@@ -255,6 +255,10 @@ class NET_EXPORT URLRequestContextBuilder {
   // SdchOwner in net/sdch/sdch_owner.h is a simple policy object.
   void set_sdch_enabled(bool enable) { sdch_enabled_ = enable; }
 
+  // Advertises the "br" content encoding on secure requests. Must not be
+  // enabled in builds with disable_brotli_filter=1, which cannot decode it.
+  void set_brotli_enabled(bool enable) { brotli_enabled_ = enable; }
+
   // Sets a specific HttpServerProperties for use in the
   // URLRequestContext rather than creating a default HttpServerPropertiesImpl.
   void SetHttpServerProperties(
@@ -287,6 +291,7 @@ class NET_EXPORT URLRequestContextBuilder {
   bool throttling_enabled_;
   bool backoff_enabled_;
   bool sdch_enabled_;
+  bool brotli_enabled_;
 
   scoped_refptr<base::SingleThreadTaskRunner> file_task_runner_;
   HttpCacheParams http_cache_params_;
@@ -601,14 +601,21 @@ void URLRequestHttpJob::AddExtraHeaders() {
     // easier to filter and analyze the streams to assure that a proxy has not
     // damaged these headers. Some proxies deliberately corrupt Accept-Encoding
     // headers.
+    std::string advertised_encodings = "gzip, deflate";
+    // Only advertise Brotli over cryptographic schemes, where intermediaries
+    // cannot strip or mangle an encoding they do not understand.
+    if (request()->context()->enable_brotli() &&
+        request()->url().SchemeIsCryptographic()) {
+      advertised_encodings += ", br";
+    }
     if (!advertise_sdch) {
       // Tell the server what compression formats we support (other than SDCH).
       request_info_.extra_headers.SetHeader(
-          HttpRequestHeaders::kAcceptEncoding, "gzip, deflate");
+          HttpRequestHeaders::kAcceptEncoding, advertised_encodings);
     } else {
       // Include SDCH in acceptable list.
       request_info_.extra_headers.SetHeader(
-          HttpRequestHeaders::kAcceptEncoding, "gzip, deflate, sdch");
+          HttpRequestHeaders::kAcceptEncoding, advertised_encodings + ", sdch");
       if (dictionaries_advertised_) {
         request_info_.extra_headers.SetHeader(
             kAvailDictionaryHeader,
@@ -1218,12 +1218,17 @@ VCDiffResult VCDiffDeltaFileWindow::DecodeCopy(size_t size,
   // address is now based at start of target window
   const char* const target_segment_ptr = parent_->decoded_target()->data() +
                                          target_window_start_pos_;
+  // Recursive copy that extends into the yet-to-be-copied target data.
+  // The bytes from address onward repeat with a period equal to the
+  // original distance, so each pass may copy everything decoded since
+  // address, doubling the copy size instead of repeating one period at a
+  // time (a distance of 1 would otherwise copy a single byte per pass).
+  // decoded_target has been reserved for the whole window, so
+  // target_segment_ptr stays valid while appending.
   while (size > (target_bytes_decoded - address)) {
-    // Recursive copy that extends into the yet-to-be-copied target data
     const size_t partial_copy_size = target_bytes_decoded - address;
     CopyBytes(&target_segment_ptr[address], partial_copy_size);
     target_bytes_decoded += partial_copy_size;
-    address += partial_copy_size;
     size -= partial_copy_size;
   }
   CopyBytes(&target_segment_ptr[address], size);
@@ -11,6 +11,7 @@
 #include "base/command_line.h"
 #include "base/message_loop/message_loop.h"
 #include "base/metrics/histogram.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/sys_info.h"
 #include "base/trace_event/trace_event.h"
@@ -110,6 +111,14 @@ Compositor::Compositor(ui::ContextFactory* context_factory,
   }
   settings.renderer_settings.partial_swap_enabled =
       !command_line->HasSwitch(switches::kUIDisablePartialSwap);
+  if (command_line->HasSwitch(switches::kUISoftwareRendererBandCount)) {
+    int band_count;
+    if (base::StringToInt(command_line->GetSwitchValueASCII(
+                              switches::kUISoftwareRendererBandCount),
+                          &band_count) &&
+        band_count > 0)
+      settings.renderer_settings.software_renderer_band_count = band_count;
+  }
 #if defined(OS_WIN)
   settings.renderer_settings.finish_rendering_on_resize = true;
 #endif
@@ -27,6 +27,10 @@ const char kUIEnableZeroCopy[] = "ui-enable-zero-copy";
 
 const char kUIShowPaintRects[] = "ui-show-paint-rects";
 
+// Draws software composited frames in this many horizontal bands in parallel,
+// such as --ui-software-renderer-band-count=4.
+const char kUISoftwareRendererBandCount[] = "ui-software-renderer-band-count";
+
 }  // namespace switches
 
 namespace ui {
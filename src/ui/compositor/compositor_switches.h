@@ -16,6 +16,7 @@ COMPOSITOR_EXPORT extern const char kUIEnableCompositorAnimationTimelines[];
 COMPOSITOR_EXPORT extern const char kUIEnableRGBA4444Textures[];
 COMPOSITOR_EXPORT extern const char kUIEnableZeroCopy[];
 COMPOSITOR_EXPORT extern const char kUIShowPaintRects[];
+COMPOSITOR_EXPORT extern const char kUISoftwareRendererBandCount[];
 
 }  // namespace switches
 